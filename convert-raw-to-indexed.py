@@ -0,0 +1,78 @@
+#!/usr/bin/env python3
+
+# Convert the raw.bin input of the standalone programs into the indexed
+# format that the serial program can memory-map (--sourceMode mmap).
+# See src/serial/bin/IndexedRawFile.h for the description of the format.
+
+import struct
+import argparse
+
+MAGIC = b"PXRAWIDX"
+VERSION = 1
+
+def align8(size):
+    return (size + 7) & ~7
+
+def readRaw(f):
+    # raw.bin: for each event
+    #   uint32 nfeds
+    #   nfeds times: uint32 fedId, uint32 fedSize, fedSize bytes of data
+    events = []
+    while True:
+        buf = f.read(4)
+        if len(buf) == 0:
+            break
+        if len(buf) != 4:
+            raise Exception("Truncated input after {} events".format(len(events)))
+        (nfeds,) = struct.unpack("<I", buf)
+        feds = {}
+        for i in range(nfeds):
+            (fedId, fedSize) = struct.unpack("<II", f.read(8))
+            data = f.read(fedSize)
+            if len(data) != fedSize:
+                raise Exception("Truncated input in event {}, FED {}".format(len(events), fedId))
+            feds[fedId] = data
+        events.append(feds)
+    return events
+
+def encodeEvent(feds):
+    # empty FEDs carry no information, and are not stored
+    ids = sorted(fedId for fedId, data in feds.items() if len(data) > 0)
+    chunks = [struct.pack("<II", len(ids), 0)]
+    for fedId in ids:
+        data = feds[fedId]
+        chunks.append(struct.pack("<II", fedId, len(data)))
+        chunks.append(data)
+        chunks.append(b"\0" * (align8(len(data)) - len(data)))
+    return b"".join(chunks)
+
+def main(opts):
+    with open(opts.input, "rb") as f:
+        events = readRaw(f)
+    blocks = [encodeEvent(feds) for feds in events]
+
+    offsets = []
+    offset = align8(len(MAGIC) + 8 + 8 * (len(blocks) + 1))
+    for b in blocks:
+        offsets.append(offset)
+        offset += align8(len(b))
+    offsets.append(offset)
+
+    with open(opts.output, "wb") as f:
+        f.write(MAGIC)
+        f.write(struct.pack("<II", VERSION, len(blocks)))
+        f.write(struct.pack("<{}Q".format(len(offsets)), *offsets))
+        for b in blocks:
+            f.write(b)
+            f.write(b"\0" * (align8(len(b)) - len(b)))
+    print("Converted {} events from {} to {}".format(len(blocks), opts.input, opts.output))
+
+if __name__ == "__main__":
+    parser = argparse.ArgumentParser(description="Convert raw.bin into the memory-mappable indexed raw data format (raw_indexed.bin)")
+    parser.add_argument("input", type=str, nargs="?", default="data/raw.bin",
+                        help="Input raw data file (default: data/raw.bin)")
+    parser.add_argument("output", type=str, nargs="?", default="data/raw_indexed.bin",
+                        help="Output indexed raw data file (default: data/raw_indexed.bin)")
+
+    opts = parser.parse_args()
+    main(opts)
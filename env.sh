@@ -0,0 +1,11 @@
+#! /bin/bash
+if [ -f .original_env ]; then
+  source .original_env
+else
+  echo "#! /bin/bash"                       >  .original_env
+  echo "PATH=$PATH"                         >> .original_env
+  echo "LD_LIBRARY_PATH=$LD_LIBRARY_PATH"   >> .original_env
+fi
+
+export LD_LIBRARY_PATH=/root/repo/external/tbb/lib:/root/repo/external/libbacktrace/lib:/root/repo/external/hwloc/lib:/root/repo/external/kokkos/install/lib:$LD_LIBRARY_PATH
+export PATH=$PATH
@@ -9,6 +9,12 @@ namespace pixelgpudetails {
   constexpr unsigned int MAX_ROC = 8;
   constexpr unsigned int MAX_SIZE = MAX_FED * MAX_LINK * MAX_ROC;
   constexpr unsigned int MAX_SIZE_BYTE_BOOL = MAX_SIZE * sizeof(unsigned char);
+
+  // flags of SiPixelROCFrameGPU
+  constexpr unsigned int ROC_LAYER1 = 1 << 0;        // BPix layer 1, the data words hold the row and column of the pixel
+  constexpr unsigned int ROC_FLIPPED = 1 << 1;       // the rows of the ROC run opposite to those of the module
+  constexpr unsigned int ROC_BAD = 1 << 2;           // bad ROC, skipped when using the quality information
+  constexpr unsigned int ROC_NOT_UNPACKED = 1 << 3;  // module not to be unpacked
 }  // namespace pixelgpudetails
 
 // TODO: since this has more information than just cabling map, maybe we should invent a better name?
@@ -23,4 +29,18 @@ struct SiPixelFedCablingMapGPU {
   alignas(128) unsigned int size = 0;
 };
 
+// What the raw data decoding needs for a ROC, with the same index as in SiPixelFedCablingMapGPU:
+// the local pixel (row, col) of the ROC is the pixel (row, colOffset - col) of the module, or
+// (159 - row, colOffset + col) if the ROC is flipped (modulo 2^32, as in the frame conversion)
+struct alignas(16) SiPixelROCFrameGPU {
+  unsigned int rawId;
+  unsigned int moduleId;
+  unsigned int colOffset;
+  unsigned int flags;
+};
+
+struct SiPixelROCFramesGPU {
+  alignas(128) SiPixelROCFrameGPU roc[pixelgpudetails::MAX_SIZE];
+};
+
 #endif  // CondFormats_SiPixelFedCablingMapGPU_h
@@ -14,13 +14,18 @@ namespace ALPAKA_ACCELERATOR_NAMESPACE {
   public:
     using CablingMapDeviceBuf = cms::alpakatools::device_buffer<Device, SiPixelFedCablingMapGPU>;
     using CablingMapHostBuf = cms::alpakatools::host_buffer<SiPixelFedCablingMapGPU>;
+    using ROCFramesHostBuf = cms::alpakatools::host_buffer<SiPixelROCFramesGPU>;
 
     explicit SiPixelFedCablingMapGPUWrapper(SiPixelFedCablingMapGPU cablingMap, std::vector<unsigned char> modToUnp)
         : modToUnpDefault_(modToUnp.size()),
           cablingMapHost_{cms::alpakatools::make_host_buffer<SiPixelFedCablingMapGPU, Platform>()},
+          rocFramesHost_{cms::alpakatools::make_host_buffer<SiPixelROCFramesGPU, Platform>()},
           hasQuality_{true} {
       std::memcpy(cablingMapHost_.data(), &cablingMap, sizeof(SiPixelFedCablingMapGPU));
       std::copy(modToUnp.begin(), modToUnp.end(), modToUnpDefault_.begin());
+      for (unsigned int i = 0; i < pixelgpudetails::MAX_SIZE; ++i) {
+        rocFramesHost_->roc[i] = makeROCFrame(cablingMap, modToUnpDefault_, i);
+      }
     }
     ~SiPixelFedCablingMapGPUWrapper() = default;
 
@@ -49,9 +54,59 @@ namespace ALPAKA_ACCELERATOR_NAMESPACE {
       return data.modToUnpDefault.data();
     }
 
+    // the cabling map and the modules to unpack, combined per ROC for the raw data decoding
+    const SiPixelROCFramesGPU* getROCFramesAsync(Queue& queue) const {
+      const auto& data = rocFrames_.dataForDeviceAsync(queue, [this](Queue& queue) {
+        ROCFrames rocFrames(queue);
+        alpaka::memcpy(queue, rocFrames.rocFramesDevice, rocFramesHost_);
+        return rocFrames;
+      });
+      return data.rocFramesDevice.data();
+    }
+
   private:
+    static SiPixelROCFrameGPU makeROCFrame(SiPixelFedCablingMapGPU const& cablingMap,
+                                           std::vector<unsigned char> const& modToUnp,
+                                           unsigned int index) {
+      // Phase 1 geometry constants, as in SiPixelRawToClusterGPUKernel.h
+      constexpr unsigned int layerStartBit = 20;
+      constexpr unsigned int moduleStartBit = 2;
+      constexpr unsigned int layerMask = 0xF;
+      constexpr unsigned int moduleMask = 0x3FF;
+      constexpr unsigned int numColsInRoc = 52;
+
+      unsigned int rawId = cablingMap.RawId[index];
+      unsigned int rocIdInDetUnit = cablingMap.rocInDet[index];
+      bool barrel = (1 == ((rawId >> 25) & 0x7));
+      unsigned int layer = barrel ? (rawId >> layerStartBit) & layerMask : 0;
+      unsigned int module = (rawId >> moduleStartBit) & moduleMask;
+
+      // as in frameConversion(): the BPix modules on the -Z side except those of layer 1 are oriented like 'dddd',
+      // the other BPix modules like 'pppp', and the FPix modules like 'dddd'
+      bool pppp = barrel and (layer == 1 or module >= 5);
+      bool first = rocIdInDetUnit < 8;
+      unsigned int colOffset;
+      if (pppp) {
+        colOffset = first ? rocIdInDetUnit * numColsInRoc : (16 - rocIdInDetUnit) * numColsInRoc - 1;
+      } else {
+        colOffset = first ? (8 - rocIdInDetUnit) * numColsInRoc - 1 : (rocIdInDetUnit - 8) * numColsInRoc;
+      }
+
+      unsigned int flags = 0;
+      if (layer == 1)
+        flags |= pixelgpudetails::ROC_LAYER1;
+      if (pppp == first)
+        flags |= pixelgpudetails::ROC_FLIPPED;
+      if (cablingMap.badRocs[index])
+        flags |= pixelgpudetails::ROC_BAD;
+      if (index < modToUnp.size() and modToUnp[index])
+        flags |= pixelgpudetails::ROC_NOT_UNPACKED;
+      return SiPixelROCFrameGPU{rawId, cablingMap.moduleId[index], colOffset, flags};
+    }
+
     std::vector<unsigned char> modToUnpDefault_;
     CablingMapHostBuf cablingMapHost_;
+    ROCFramesHostBuf rocFramesHost_;
     bool hasQuality_;
 
     struct GPUData {
@@ -76,6 +131,18 @@ namespace ALPAKA_ACCELERATOR_NAMESPACE {
     };
 
     cms::alpakatools::ESProduct<Queue, ModulesToUnpack> modToUnp_;
+
+    struct ROCFrames {
+    public:
+      ROCFrames() = delete;
+      ROCFrames(Queue const& queue)
+          : rocFramesDevice{cms::alpakatools::make_device_buffer<SiPixelROCFramesGPU>(queue)} {};
+      ~ROCFrames() = default;
+
+      cms::alpakatools::device_buffer<Device, SiPixelROCFramesGPU> rocFramesDevice;  // pointer to struct in GPU
+    };
+
+    cms::alpakatools::ESProduct<Queue, ROCFrames> rocFrames_;
   };
 
 }  // namespace ALPAKA_ACCELERATOR_NAMESPACE
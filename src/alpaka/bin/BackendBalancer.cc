@@ -0,0 +1,123 @@
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <stdexcept>
+#include <utility>
+
+#include "BackendBalancer.h"
+
+namespace edm {
+  BackendBalancer::BackendBalancer(std::vector<int> initialStreams)
+      : total_(std::accumulate(initialStreams.begin(), initialStreams.end(), 0)),
+        timePerEvent_(std::make_unique<RunningAverage[]>(initialStreams.size())),
+        quota_(std::move(initialStreams)),
+        active_(quota_.size(), 0),
+        measured_(quota_.size(), 0),
+        parked_(quota_.size()) {
+    if (quota_.empty() or total_ <= 0) {
+      throw std::runtime_error("The dynamic load balancing needs at least one backend and one concurrent event");
+    }
+    // every backend needs some events to be measured, take them from the backends with most streams
+    if (total_ >= static_cast<int>(quota_.size())) {
+      for (auto& quota : quota_) {
+        if (quota == 0) {
+          ++quota;
+          --*std::max_element(quota_.begin(), quota_.end());
+        }
+      }
+    }
+  }
+
+  bool BackendBalancer::admit(int backend, std::function<void()> resume) {
+    std::lock_guard<std::mutex> guard(mutex_);
+    if (draining_ or active_[backend] < quota_[backend]) {
+      ++active_[backend];
+      return true;
+    }
+    parked_[backend].push_back(std::move(resume));
+    return false;
+  }
+
+  void BackendBalancer::eventDone(int backend, Clock::duration time) {
+    timePerEvent_[backend].update(std::chrono::duration_cast<std::chrono::microseconds>(time).count());
+    std::vector<std::function<void()>> resume;
+    {
+      std::lock_guard<std::mutex> guard(mutex_);
+      --active_[backend];
+      ++measured_[backend];
+      if (++eventsSinceRebalance_ >= RunningAverage::N) {
+        rebalance();
+        eventsSinceRebalance_ = 0;
+      }
+      resume = resumable();
+    }
+    for (auto& f : resume) {
+      f();
+    }
+  }
+
+  void BackendBalancer::drain() {
+    std::vector<std::function<void()>> resume;
+    {
+      std::lock_guard<std::mutex> guard(mutex_);
+      draining_ = true;
+      resume = resumable();
+    }
+    for (auto& f : resume) {
+      f();
+    }
+  }
+
+  void BackendBalancer::rebalance() {
+    int const size = quota_.size();
+    // the running averages are meaningful only after a full window of events
+    for (int b = 0; b < size; ++b) {
+      if (measured_[b] < RunningAverage::N) {
+        return;
+      }
+    }
+
+    // events per us per stream
+    std::vector<double> rate(size);
+    for (int b = 0; b < size; ++b) {
+      rate[b] = 1. / std::max(timePerEvent_[b].mean(), 1);
+    }
+    double sum = std::accumulate(rate.begin(), rate.end(), 0.);
+
+    // share the streams left after the minimum with the largest remainder method
+    int minimum = total_ >= size ? 1 : 0;
+    int left = total_ - minimum * size;
+    std::vector<int> quota(size, minimum);
+    std::vector<std::pair<double, int>> remainders(size);
+    int assigned = 0;
+    for (int b = 0; b < size; ++b) {
+      double share = left * rate[b] / sum;
+      int whole = static_cast<int>(std::floor(share));
+      quota[b] += whole;
+      assigned += whole;
+      remainders[b] = {share - whole, b};
+    }
+    std::sort(remainders.begin(), remainders.end(), std::greater<>());
+    for (int i = 0; assigned < left; ++i, ++assigned) {
+      ++quota[remainders[i].second];
+    }
+
+    if (quota != quota_) {
+      quota_ = std::move(quota);
+      ++rebalances_;
+    }
+  }
+
+  std::vector<std::function<void()>> BackendBalancer::resumable() {
+    std::vector<std::function<void()>> resume;
+    for (size_t b = 0; b < parked_.size(); ++b) {
+      auto& parked = parked_[b];
+      while (not parked.empty() and (draining_ or active_[b] < quota_[b])) {
+        ++active_[b];
+        resume.push_back(std::move(parked.back()));
+        parked.pop_back();
+      }
+    }
+    return resume;
+  }
+}  // namespace edm
@@ -0,0 +1,71 @@
+#ifndef bin_BackendBalancer_h
+#define bin_BackendBalancer_h
+
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "Framework/RunningAverage.h"
+
+namespace edm {
+  // Distributes the concurrent events among the backends according to
+  // their measured speed
+  //
+  // Each backend has as many StreamSchedules as the total number of
+  // concurrent events, but only its share of them is active at any
+  // time: a stream asks for a slot before reading an event, and gives
+  // it back at the end of the event. A stream that does not get a slot
+  // is parked, and resumed when the share of its backend grows or when
+  // the processing ends. After every RunningAverage::N events the shares
+  // are recomputed proportionally to the rate of events per stream of
+  // each backend, i.e. the inverse of its running average time per
+  // event, keeping at least one stream per backend to keep measuring it.
+  class BackendBalancer {
+  public:
+    using Clock = std::chrono::steady_clock;
+
+    // initial number of concurrent events of each backend, their sum is the total number of concurrent events
+    explicit BackendBalancer(std::vector<int> initialStreams);
+
+    BackendBalancer(BackendBalancer const&) = delete;
+    BackendBalancer& operator=(BackendBalancer const&) = delete;
+
+    // thread safe
+    // returns true if the stream can process one more event, otherwise
+    // keeps resume, that will be called once a slot is available
+    bool admit(int backend, std::function<void()> resume);
+
+    // thread safe
+    // gives back the slot of an event that has been processed in the given time
+    void eventDone(int backend, Clock::duration time);
+
+    // thread safe
+    // no more events will be processed, admits all parked and future streams
+    void drain();
+
+    // not thread safe
+    // current number of concurrent events of each backend
+    std::vector<int> const& streams() const { return quota_; }
+    int rebalances() const { return rebalances_; }
+
+  private:
+    void rebalance();
+    std::vector<std::function<void()>> resumable();
+
+    int const total_;
+    std::unique_ptr<RunningAverage[]> timePerEvent_;  // in us
+
+    std::mutex mutex_;
+    std::vector<int> quota_;
+    std::vector<int> active_;
+    std::vector<int> measured_;
+    std::vector<std::vector<std::function<void()>>> parked_;
+    int eventsSinceRebalance_ = 0;
+    int rebalances_ = 0;
+    bool draining_ = false;
+  };
+}  // namespace edm
+
+#endif  // bin_BackendBalancer_h
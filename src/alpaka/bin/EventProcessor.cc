@@ -17,7 +17,8 @@ namespace edm {
                                  Alternatives alternatives,
                                  std::vector<std::string> const& esproducers,
                                  std::filesystem::path const& datadir,
-                                 bool validation)
+                                 bool validation,
+                                 bool balance)
       : source_(maxEvents, runForMinutes, registry_, datadir, validation) {
     for (auto const& name : esproducers) {
       pluginManager_.load(name);
@@ -38,11 +39,34 @@ namespace edm {
       cumulative += alternative.weight;
       lower_range = upper_range;
       upper_range = static_cast<int>(std::round(cumulative * numberOfStreams / total));
-      for (int i = lower_range; i < upper_range; ++i) {
-        schedules_.emplace_back(registry_, pluginManager_, &source_, &eventSetup_, i, alternative.path);
-      }
       streamsPerBackend_.emplace_back(alternative.backend, upper_range - lower_range);
     }
+
+    if (balance and not alternatives.empty()) {
+      // the weights give only the initial share of the concurrent events,
+      // each backend can take up to all of them
+      std::vector<int> initialStreams;
+      for (auto& [backend, streams] : streamsPerBackend_) {
+        initialStreams.push_back(streams);
+      }
+      balancer_ = std::make_unique<BackendBalancer>(std::move(initialStreams));
+      int streamId = 0;
+      for (int b = 0; b < static_cast<int>(alternatives.size()); ++b) {
+        streamsPerBackend_[b].second = balancer_->streams()[b];
+        for (int i = 0; i < numberOfStreams; ++i) {
+          schedules_.emplace_back(
+              registry_, pluginManager_, &source_, &eventSetup_, streamId++, alternatives[b].path, b, balancer_.get());
+        }
+      }
+    } else {
+      int streamId = 0;
+      for (int b = 0; b < static_cast<int>(alternatives.size()); ++b) {
+        for (int i = 0; i < streamsPerBackend_[b].second; ++i) {
+          schedules_.emplace_back(
+              registry_, pluginManager_, &source_, &eventSetup_, streamId++, alternatives[b].path, b);
+        }
+      }
+    }
   }
 
   void EventProcessor::runToCompletion() {
@@ -60,6 +84,17 @@ namespace edm {
     }
   }
 
+  std::vector<std::pair<Backend, int>> EventProcessor::processedEventsPerBackend() const {
+    std::vector<std::pair<Backend, int>> events;
+    for (auto const& [backend, streams] : streamsPerBackend_) {
+      events.emplace_back(backend, 0);
+    }
+    for (auto const& s : schedules_) {
+      events[s.backend()].second += s.processedEvents();
+    }
+    return events;
+  }
+
   void EventProcessor::endJob() {
     // Only on the first stream...
     schedules_[0].endJob();
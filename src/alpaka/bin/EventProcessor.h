@@ -2,12 +2,14 @@
 #define bin_EventProcessor_h
 
 #include <filesystem>
+#include <memory>
 #include <string>
 #include <vector>
 
 #include "AlpakaCore/backend.h"
 #include "Framework/EventSetup.h"
 
+#include "BackendBalancer.h"
 #include "PluginManager.h"
 #include "StreamSchedule.h"
 #include "Source.h"
@@ -33,11 +35,16 @@ namespace edm {
                             Alternatives alternatives,
                             std::vector<std::string> const& esproducers,
                             std::filesystem::path const& datadir,
-                            bool validation);
+                            bool validation,
+                            bool balance = false);
 
     int maxEvents() const { return source_.maxEvents(); }
     int processedEvents() const { return source_.processedEvents(); }
+    // initial number of concurrent events per backend
     std::vector<std::pair<Backend, int>> const& backends() const { return streamsPerBackend_; }
+    std::vector<std::pair<Backend, int>> processedEventsPerBackend() const;
+    // nullptr unless the dynamic load balancing is enabled
+    BackendBalancer const* balancer() const { return balancer_.get(); }
 
     void runToCompletion();
 
@@ -48,6 +55,7 @@ namespace edm {
     ProductRegistry registry_;
     Source source_;
     EventSetup eventSetup_;
+    std::unique_ptr<BackendBalancer> balancer_;
     std::vector<StreamSchedule> schedules_;
     std::vector<std::pair<Backend, int>> streamsPerBackend_;
   };
@@ -1,3 +1,4 @@
+#include <chrono>
 #include <exception>
 //#include <iostream>
 #include <string>
@@ -11,6 +12,7 @@
 #include "Framework/WaitingTask.h"
 #include "Framework/Worker.h"
 
+#include "BackendBalancer.h"
 #include "PluginManager.h"
 #include "Source.h"
 #include "StreamSchedule.h"
@@ -21,8 +23,15 @@ namespace edm {
                                  Source* source,
                                  EventSetup const* eventSetup,
                                  int streamId,
-                                 std::vector<std::string> const& path)
-      : registry_(std::move(reg)), source_(source), eventSetup_(eventSetup), streamId_(streamId) {
+                                 std::vector<std::string> const& path,
+                                 int backend,
+                                 BackendBalancer* balancer)
+      : registry_(std::move(reg)),
+        source_(source),
+        eventSetup_(eventSetup),
+        balancer_(balancer),
+        streamId_(streamId),
+        backend_(backend) {
     path_.reserve(path.size());
     int modInd = 1;
     for (auto const& name : path) {
@@ -47,6 +56,9 @@ namespace edm {
   StreamSchedule& StreamSchedule::operator=(StreamSchedule&&) = default;
 
   void StreamSchedule::runToCompletionAsync(WaitingTaskHolder h) {
+    if (balancer_ and not balancer_->admit(backend_, [this, h]() { resumeAsync(h); })) {
+      return;
+    }
     auto task = make_functor_task([this, h]() mutable { processOneEventAsync(std::move(h)); });
     if (streamId_ == 0) {
       h.group()->run([task]() {
@@ -62,24 +74,50 @@ namespace edm {
     }
   }
 
+  void StreamSchedule::resumeAsync(WaitingTaskHolder h) {
+    // called from a task of another stream, spawn in the task group so
+    // that the waiting for the group does not end in the meantime
+    auto task = make_functor_task([this, h]() mutable { processOneEventAsync(std::move(h)); });
+    h.group()->run([task]() {
+      TaskSentry s{task};
+      task->execute();
+    });
+  }
+
+  void StreamSchedule::processNextEventAsync(WaitingTaskHolder h) {
+    if (balancer_ and not balancer_->admit(backend_, [this, h]() { resumeAsync(h); })) {
+      return;
+    }
+    processOneEventAsync(std::move(h));
+  }
+
   void StreamSchedule::processOneEventAsync(WaitingTaskHolder h) {
     auto event = source_->produce(streamId_, registry_);
     if (event) {
+      auto start = std::chrono::steady_clock::now();
       // Pass the event object ownership to the "end-of-event" task
       // Pass a non-owning pointer to the event to preceding tasks
       //std::cout << "Begin processing event " << event->eventID() << std::endl;
       auto eventPtr = event.get();
       auto* group = h.group();
-      auto nextEventTask =
-          make_waiting_task([this, h = std::move(h), ev = std::move(event)](std::exception_ptr const* iPtr) mutable {
+      auto nextEventTask = make_waiting_task(
+          [this, h = std::move(h), ev = std::move(event), start](std::exception_ptr const* iPtr) mutable {
             ev.reset();
+            ++nEvents_;
+            if (balancer_) {
+              balancer_->eventDone(backend_, std::chrono::steady_clock::now() - start);
+            }
             if (iPtr) {
+              // do not leave the parked streams waiting for this one
+              if (balancer_) {
+                balancer_->drain();
+              }
               h.doneWaiting(*iPtr);
             } else {
               for (auto const& worker : path_) {
                 worker->reset();
               }
-              processOneEventAsync(std::move(h));
+              processNextEventAsync(std::move(h));
             }
           });
       // To guarantee that the nextEventTask is spawned also in
@@ -92,6 +130,9 @@ namespace edm {
         (*iWorker)->doWorkAsync(*eventPtr, *eventSetup_, nextEventTaskHolder);
       }
     } else {
+      if (balancer_) {
+        balancer_->drain();
+      }
       h.doneWaiting(std::exception_ptr{});
     }
   }
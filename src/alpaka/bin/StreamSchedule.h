@@ -13,6 +13,7 @@ namespace edmplugin {
 }
 
 namespace edm {
+  class BackendBalancer;
   class EventSetup;
   class Source;
   class Worker;
@@ -26,7 +27,9 @@ namespace edm {
                             Source* source,
                             EventSetup const* eventSetup,
                             int streamId,
-                            std::vector<std::string> const& path);
+                            std::vector<std::string> const& path,
+                            int backend = 0,
+                            BackendBalancer* balancer = nullptr);
     ~StreamSchedule();
     StreamSchedule(StreamSchedule const&) = delete;
     StreamSchedule& operator=(StreamSchedule const&) = delete;
@@ -37,14 +40,23 @@ namespace edm {
 
     void endJob();
 
+    // index of the backend among the alternatives of the EventProcessor
+    int backend() const { return backend_; }
+    int processedEvents() const { return nEvents_; }
+
   private:
+    void resumeAsync(WaitingTaskHolder h);
+    void processNextEventAsync(WaitingTaskHolder h);
     void processOneEventAsync(WaitingTaskHolder h);
 
     ProductRegistry registry_;
     Source* source_;
     EventSetup const* eventSetup_;
+    BackendBalancer* balancer_;
     std::vector<std::unique_ptr<Worker>> path_;
     int streamId_;
+    int backend_;
+    int nEvents_ = 0;
   };
 }  // namespace edm
 
@@ -39,7 +39,7 @@ namespace {
         << "[--hip] "
 #endif
         << "[--numberOfThreads NT] [--numberOfStreams NS] [--maxEvents ME] [--data PATH] "
-           "[--transfer] [--validation] [--histogram]\n\n"
+           "[--transfer] [--validation] [--histogram] [--balance]\n\n"
         << "Options\n"
 #ifdef ALPAKA_ACC_CPU_B_SEQ_T_SEQ_PRESENT
         << " --serial            Use CPU Serial backend\n"
@@ -63,6 +63,9 @@ namespace {
         << " --validation        Run (rudimentary) validation at the end (implies --transfer)\n"
         << " --histogram         Produce histograms at the end (implies --transfer)\n"
         << " --empty             Ignore all producers (for testing only)\n"
+        << " --balance           Use the backend weights only for the initial share of the concurrent events, and "
+           "rebalance them\n"
+        << "                     during the job according to the average time per event measured on each backend\n"
         << std::endl;
   }
 }  // namespace
@@ -130,6 +133,7 @@ int main(int argc, char** argv) {
   bool validation = false;
   bool histogram = false;
   bool empty = false;
+  bool balance = false;
   for (auto i = args.begin() + 1, e = args.end(); i != e; ++i) {
     if (*i == "-h" or *i == "--help") {
       print_help(args.front());
@@ -178,6 +182,8 @@ int main(int argc, char** argv) {
       histogram = true;
     } else if (*i == "--empty") {
       empty = true;
+    } else if (*i == "--balance") {
+      balance = true;
     } else {
       std::cout << "Invalid parameter " << *i << std::endl << std::endl;
       print_help(args.front());
@@ -256,8 +262,14 @@ int main(int argc, char** argv) {
       alternatives.emplace_back(backend, weight, std::move(edmodules));
     }
   }
-  edm::EventProcessor processor(
-      maxEvents, runForMinutes, numberOfStreams, std::move(alternatives), std::move(esmodules), datadir, validation);
+  edm::EventProcessor processor(maxEvents,
+                                runForMinutes,
+                                numberOfStreams,
+                                std::move(alternatives),
+                                std::move(esmodules),
+                                datadir,
+                                validation,
+                                balance);
 
   if (runForMinutes < 0) {
     std::cout << "Processing " << processor.maxEvents() << " events,";
@@ -274,7 +286,8 @@ int main(int argc, char** argv) {
       std::cout << streams << " on " << backend;
       need_comma = true;
     }
-    std::cout << ") and " << numberOfThreads << " threads." << std::endl;
+    std::cout << ")" << (processor.balancer() ? ", dynamically rebalanced," : "") << " and " << numberOfThreads
+              << " threads." << std::endl;
   }
 
   // Initialize the TBB thread pool
@@ -327,5 +340,21 @@ int main(int argc, char** argv) {
   std::cout << "Processed " << maxEvents << " events in " << std::scientific << time << " seconds, throughput "
             << std::defaultfloat << (maxEvents / time) << " events/s, CPU usage per thread: " << std::fixed
             << std::setprecision(1) << (cpu / time / numberOfThreads * 100) << "%" << std::endl;
+  {
+    auto const* balancer = processor.balancer();
+    auto const events = processor.processedEventsPerBackend();
+    for (size_t b = 0; b < events.size(); ++b) {
+      auto const& [backend, count] = events[b];
+      std::cout << "Backend " << backend << ": " << count << " events, throughput " << std::defaultfloat
+                << (count / time) << " events/s";
+      if (balancer) {
+        std::cout << ", " << balancer->streams()[b] << " concurrent events at the end of the job";
+      }
+      std::cout << std::endl;
+    }
+    if (balancer) {
+      std::cout << "The concurrent events have been rebalanced " << balancer->rebalances() << " times" << std::endl;
+    }
+  }
   return EXIT_SUCCESS;
 }
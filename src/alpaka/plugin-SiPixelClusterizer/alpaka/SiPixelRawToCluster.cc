@@ -81,7 +81,7 @@ namespace ALPAKA_ACCELERATOR_NAMESPACE {
     }
     // get the GPU product already here so that the async transfer can begin
     const auto* gpuMap = hgpuMap.getGPUProductAsync(ctx.stream());
-    const unsigned char* gpuModulesToUnpack = hgpuMap.getModToUnpAllAsync(ctx.stream());
+    const auto* rocFrames = hgpuMap.getROCFramesAsync(ctx.stream());
     auto const& hgains = iSetup.get<SiPixelGainCalibrationForHLTGPU>();
     const auto* gpuGains = hgains.getGPUProductAsync(ctx.stream());
     auto const& fedIds_ = iSetup.get<SiPixelFedIds>().fedIds();
@@ -151,7 +151,7 @@ namespace ALPAKA_ACCELERATOR_NAMESPACE {
 
     gpuAlgo_.makeClustersAsync(isRun2_,
                                gpuMap,
-                               gpuModulesToUnpack,
+                               rocFrames,
                                gpuGains,
                                *wordFedAppender_,
                                std::move(errors_),
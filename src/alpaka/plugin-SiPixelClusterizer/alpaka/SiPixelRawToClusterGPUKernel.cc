@@ -60,8 +60,6 @@ namespace ALPAKA_ACCELERATOR_NAMESPACE {
       return ((ww >> ::pixelgpudetails::ADC_shift) & ::pixelgpudetails::ADC_mask);
     }
 
-    ALPAKA_FN_ACC bool isBarrel(uint32_t rawId) { return (1 == ((rawId >> 25) & 0x7)); }
-
     ALPAKA_FN_ACC ::pixelgpudetails::DetIdGPU getRawId(const SiPixelFedCablingMapGPU *cablingMap,
                                                        uint8_t fed,
                                                        uint32_t link,
@@ -75,71 +73,13 @@ namespace ALPAKA_ACCELERATOR_NAMESPACE {
 
     //reference http://cmsdoxygen.web.cern.ch/cmsdoxygen/CMSSW_9_2_0/doc/html/dd/d31/FrameConversion_8cc_source.html
     //http://cmslxr.fnal.gov/source/CondFormats/SiPixelObjects/src/PixelROC.cc?v=CMSSW_9_2_0#0071
-    // Convert local pixel to ::pixelgpudetails::global pixel
-    ALPAKA_FN_ACC ::pixelgpudetails::Pixel frameConversion(
-        bool bpix, int side, uint32_t layer, uint32_t rocIdInDetUnit, ::pixelgpudetails::Pixel local) {
-      int slopeRow = 0, slopeCol = 0;
-      int rowOffset = 0, colOffset = 0;
-
-      if (bpix) {
-        if (side == -1 && layer != 1) {  // -Z side: 4 non-flipped modules oriented like 'dddd', except Layer 1
-          if (rocIdInDetUnit < 8) {
-            slopeRow = 1;
-            slopeCol = -1;
-            rowOffset = 0;
-            colOffset = (8 - rocIdInDetUnit) * ::pixelgpudetails::numColsInRoc - 1;
-          } else {
-            slopeRow = -1;
-            slopeCol = 1;
-            rowOffset = 2 * ::pixelgpudetails::numRowsInRoc - 1;
-            colOffset = (rocIdInDetUnit - 8) * ::pixelgpudetails::numColsInRoc;
-          }       // if roc
-        } else {  // +Z side: 4 non-flipped modules oriented like 'pppp', but all 8 in layer1
-          if (rocIdInDetUnit < 8) {
-            slopeRow = -1;
-            slopeCol = 1;
-            rowOffset = 2 * ::pixelgpudetails::numRowsInRoc - 1;
-            colOffset = rocIdInDetUnit * ::pixelgpudetails::numColsInRoc;
-          } else {
-            slopeRow = 1;
-            slopeCol = -1;
-            rowOffset = 0;
-            colOffset = (16 - rocIdInDetUnit) * ::pixelgpudetails::numColsInRoc - 1;
-          }
-        }
-
-      } else {             // fpix
-        if (side == -1) {  // pannel 1
-          if (rocIdInDetUnit < 8) {
-            slopeRow = 1;
-            slopeCol = -1;
-            rowOffset = 0;
-            colOffset = (8 - rocIdInDetUnit) * ::pixelgpudetails::numColsInRoc - 1;
-          } else {
-            slopeRow = -1;
-            slopeCol = 1;
-            rowOffset = 2 * ::pixelgpudetails::numRowsInRoc - 1;
-            colOffset = (rocIdInDetUnit - 8) * ::pixelgpudetails::numColsInRoc;
-          }
-        } else {  // pannel 2
-          if (rocIdInDetUnit < 8) {
-            slopeRow = 1;
-            slopeCol = -1;
-            rowOffset = 0;
-            colOffset = (8 - rocIdInDetUnit) * ::pixelgpudetails::numColsInRoc - 1;
-          } else {
-            slopeRow = -1;
-            slopeCol = 1;
-            rowOffset = 2 * ::pixelgpudetails::numRowsInRoc - 1;
-            colOffset = (rocIdInDetUnit - 8) * ::pixelgpudetails::numColsInRoc;
-          }
-
-        }  // side
-      }
-
-      uint32_t gRow = rowOffset + slopeRow * local.row;
-      uint32_t gCol = colOffset + slopeCol * local.col;
-      //printf("Inside frameConversion row: %u, column: %u\n", gRow, gCol);
+    // Convert local pixel to ::pixelgpudetails::global pixel, with the orientation and offset of the ROC precomputed
+    // in SiPixelFedCablingMapGPUWrapper
+    ALPAKA_FN_ACC ::pixelgpudetails::Pixel frameConversion(SiPixelROCFrameGPU const &frame,
+                                                           ::pixelgpudetails::Pixel local) {
+      bool flipped = frame.flags & ::pixelgpudetails::ROC_FLIPPED;
+      uint32_t gRow = flipped ? 2 * ::pixelgpudetails::numRowsInRoc - 1 - local.row : local.row;
+      uint32_t gCol = flipped ? frame.colOffset + local.col : frame.colOffset - local.col;
       ::pixelgpudetails::Pixel global = {gRow, gCol};
       return global;
     }
@@ -354,7 +294,7 @@ namespace ALPAKA_ACCELERATOR_NAMESPACE {
       template <typename TAcc>
       ALPAKA_FN_ACC void operator()(const TAcc &acc,
                                     const SiPixelFedCablingMapGPU *cablingMap,
-                                    const unsigned char *modToUnp,
+                                    const SiPixelROCFramesGPU *rocFrames,
                                     const uint32_t wordCounter,
                                     const uint32_t *word,
                                     const uint8_t *fedIds,
@@ -390,7 +330,6 @@ namespace ALPAKA_ACCELERATOR_NAMESPACE {
 
           uint32_t link = getLink(ww);  // Extract link
           uint32_t roc = getRoc(ww);    // Extract Roc in link
-          ::pixelgpudetails::DetIdGPU detId = getRawId(cablingMap, fedId, link, roc);
 
           uint8_t errorType = checkROC(ww, fedId, link, cablingMap, debug);
           skipROC = (roc < ::pixelgpudetails::maxROCIndex) ? false : (errorType != 0);
@@ -400,40 +339,19 @@ namespace ALPAKA_ACCELERATOR_NAMESPACE {
             return;
           }
 
-          uint32_t rawId = detId.RawId;
-          uint32_t rocIdInDetUnit = detId.rocInDet;
-          bool barrel = isBarrel(rawId);
-
+          // everything else about the ROC comes from a single record
           uint32_t index = fedId * ::pixelgpudetails::MAX_LINK * ::pixelgpudetails::MAX_ROC +
                            (link - 1) * ::pixelgpudetails::MAX_ROC + roc;
-          if (useQualityInfo) {
-            skipROC = cablingMap->badRocs[index];
-            if (skipROC)
-              return;
-          }
-          skipROC = modToUnp[index];
-          if (skipROC)
+          SiPixelROCFrameGPU const frame = rocFrames->roc[index];
+          uint32_t rawId = frame.rawId;
+          if (useQualityInfo and (frame.flags & ::pixelgpudetails::ROC_BAD))
+            return;
+          if (frame.flags & ::pixelgpudetails::ROC_NOT_UNPACKED)
             return;
-
-          uint32_t layer = 0;                   //, ladder =0;
-          int side = 0, panel = 0, module = 0;  //disk = 0, blade = 0
-
-          if (barrel) {
-            layer = (rawId >> ::pixelgpudetails::layerStartBit) & ::pixelgpudetails::layerMask;
-            module = (rawId >> ::pixelgpudetails::moduleStartBit) & ::pixelgpudetails::moduleMask;
-            side = (module < 5) ? -1 : 1;
-          } else {
-            // endcap ids
-            layer = 0;
-            panel = (rawId >> ::pixelgpudetails::panelStartBit) & ::pixelgpudetails::panelMask;
-            //disk  = (rawId >> diskStartBit_) & diskMask_;
-            side = (panel == 1) ? -1 : 1;
-            //blade = (rawId >> bladeStartBit_) & bladeMask_;
-          }
 
           // ***special case of layer to 1 be handled here
           ::pixelgpudetails::Pixel localPix;
-          if (layer == 1) {
+          if (frame.flags & ::pixelgpudetails::ROC_LAYER1) {
             uint32_t col = (ww >> ::pixelgpudetails::COL_shift) & ::pixelgpudetails::COL_mask;
             uint32_t row = (ww >> ::pixelgpudetails::ROW_shift) & ::pixelgpudetails::ROW_mask;
             localPix.row = row;
@@ -464,12 +382,12 @@ namespace ALPAKA_ACCELERATOR_NAMESPACE {
             }
           }
 
-          ::pixelgpudetails::Pixel globalPix = frameConversion(barrel, side, layer, rocIdInDetUnit, localPix);
+          ::pixelgpudetails::Pixel globalPix = frameConversion(frame, localPix);
           xx[gIndex] = globalPix.row;  // origin shifting by 1 0-159
           yy[gIndex] = globalPix.col;  // origin shifting by 1 0-415
           adc[gIndex] = getADC(ww);
           pdigi[gIndex] = ::pixelgpudetails::pack(globalPix.row, globalPix.col, adc[gIndex]);
-          moduleId[gIndex] = detId.moduleId;
+          moduleId[gIndex] = frame.moduleId;
           rawIdArr[gIndex] = rawId;
         });  // end of stride on grid
 
@@ -546,7 +464,7 @@ namespace ALPAKA_ACCELERATOR_NAMESPACE {
     // Interface to outside
     void SiPixelRawToClusterGPUKernel::makeClustersAsync(bool isRun2,
                                                          const SiPixelFedCablingMapGPU *cablingMap,
-                                                         const unsigned char *modToUnp,
+                                                         const SiPixelROCFramesGPU *rocFrames,
                                                          const SiPixelGainForHLTonGPU *gains,
                                                          const WordFedAppender &wordFed,
                                                          PixelFormatterErrors &&errors,
@@ -596,7 +514,7 @@ namespace ALPAKA_ACCELERATOR_NAMESPACE {
                         alpaka::createTaskKernel<Acc1D>(workDiv,
                                                         RawToDigi_kernel(),
                                                         cablingMap,
-                                                        modToUnp,
+                                                        rocFrames,
                                                         wordCounter,
                                                         word_d.data(),
                                                         fedId_d.data(),
@@ -180,7 +180,7 @@ namespace ALPAKA_ACCELERATOR_NAMESPACE {
 
       void makeClustersAsync(bool isRun2,
                              const SiPixelFedCablingMapGPU* cablingMap,
-                             const unsigned char* modToUnp,
+                             const SiPixelROCFramesGPU* rocFrames,
                              const SiPixelGainForHLTonGPU* gains,
                              const WordFedAppender& wordFed,
                              PixelFormatterErrors&& errors,
@@ -26,11 +26,15 @@ public:
   const unsigned char *getModToUnpAllAsync(cudaStream_t cudaStream) const;
   const unsigned char *getModToUnpAll() const { return modToUnpDefault.data(); }
 
+  // the cabling map and the modules to unpack, combined per ROC for the raw data decoding
+  const SiPixelROCFramesGPU *getROCFrames() const { return rocFramesHost; }
+
 private:
   std::vector<unsigned char, cms::cuda::HostAllocator<unsigned char>> modToUnpDefault;
   bool hasQuality_;
 
   SiPixelFedCablingMapGPU *cablingMapHost = nullptr;  // pointer to struct in CPU
+  SiPixelROCFramesGPU *rocFramesHost = nullptr;       // pointer to struct in CPU
 
   struct GPUData {
     ~GPUData();
@@ -67,7 +67,7 @@ void SiPixelRawToClusterCUDA::produce(edm::Event& iEvent, const edm::EventSetup&
   }
   // get the GPU product already here so that the async transfer can begin
   const auto* gpuMap = hgpuMap.getCPUProduct();
-  const unsigned char* gpuModulesToUnpack = hgpuMap.getModToUnpAll();
+  const auto* rocFrames = hgpuMap.getROCFrames();
 
   auto const& hgains = iSetup.get<SiPixelGainCalibrationForHLTGPU>();
   // get the GPU product already here so that the async transfer can begin
@@ -141,7 +141,7 @@ void SiPixelRawToClusterCUDA::produce(edm::Event& iEvent, const edm::EventSetup&
 
   gpuAlgo_.makeClusters(isRun2_,
                         gpuMap,
-                        gpuModulesToUnpack,
+                        rocFrames,
                         gpuGains,
                         *wordFedAppender_,
                         std::move(errors_),
@@ -12,6 +12,7 @@
 #include "DataFormats/PixelErrors.h"
 
 struct SiPixelFedCablingMapGPU;
+struct SiPixelROCFramesGPU;
 class SiPixelGainForHLTonGPU;
 
 namespace pixelgpudetails {
@@ -168,7 +169,7 @@ namespace pixelgpudetails {
 
     void makeClusters(bool isRun2,
                       const SiPixelFedCablingMapGPU* cablingMap,
-                      const unsigned char* modToUnp,
+                      const SiPixelROCFramesGPU* rocFrames,
                       const SiPixelGainForHLTonGPU* gains,
                       const WordFedAppender& wordFed,
                       PixelFormatterErrors&& errors,
@@ -0,0 +1,71 @@
+#include "CUDACore/HostBufferPool.h"
+
+#include <cassert>
+#include <cstdlib>
+#include <new>
+
+namespace cms {
+  namespace cuda {
+
+    HostBufferPool::~HostBufferPool() {
+      assert(0 == outstandingBlocks_);
+      for (auto& blocks : cached_) {
+        for (auto* ptr : blocks) {
+          std::free(ptr);
+        }
+      }
+    }
+
+    unsigned int HostBufferPool::bin(size_t bytes) {
+      if (bytes > binSize(maxBin)) {
+        throw std::bad_alloc();
+      }
+      unsigned int bin = minBin;
+      while (binSize(bin) < bytes) {
+        ++bin;
+      }
+      return bin;
+    }
+
+    void* HostBufferPool::allocate(unsigned int bin) {
+      assert(bin >= minBin and bin <= maxBin);
+      {
+        std::lock_guard<std::mutex> guard(mutex_);
+        bytesRequested_ += binSize(bin);
+        ++outstandingBlocks_;
+        if (not cached_[bin].empty()) {
+          void* ptr = cached_[bin].back();
+          cached_[bin].pop_back();
+          return ptr;
+        }
+        bytesAllocated_ += binSize(bin);
+      }
+      void* ptr = std::aligned_alloc(alignment, binSize(bin));
+      if (ptr == nullptr) {
+        std::lock_guard<std::mutex> guard(mutex_);
+        bytesAllocated_ -= binSize(bin);
+        --outstandingBlocks_;
+        throw std::bad_alloc();
+      }
+      return ptr;
+    }
+
+    void HostBufferPool::free(void* ptr, unsigned int bin) {
+      std::lock_guard<std::mutex> guard(mutex_);
+      assert(outstandingBlocks_ > 0);
+      --outstandingBlocks_;
+      cached_[bin].push_back(ptr);
+    }
+
+    uint64_t HostBufferPool::bytesRequested() const {
+      std::lock_guard<std::mutex> guard(mutex_);
+      return bytesRequested_;
+    }
+
+    uint64_t HostBufferPool::bytesAllocated() const {
+      std::lock_guard<std::mutex> guard(mutex_);
+      return bytesAllocated_;
+    }
+
+  }  // namespace cuda
+}  // namespace cms
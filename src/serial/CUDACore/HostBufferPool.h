@@ -0,0 +1,67 @@
+#ifndef HeterogeneousCore_CUDAUtilities_interface_HostBufferPool_h
+#define HeterogeneousCore_CUDAUtilities_interface_HostBufferPool_h
+
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+
+namespace cms {
+  namespace cuda {
+
+    // Cache of host memory blocks, that are given back to the pool instead of being freed, and are reused by the
+    // following allocations. It plays on the CPU the role of the caching allocators of the GPU: one pool per stream
+    // recycles the buffers of the event products from one event to the next, so that their memory is neither
+    // obtained from the system nor zero-filled in each event.
+    //
+    // The requested sizes are rounded up to the bins of the pool, so that a block can be reused for all the requests
+    // of the same bin: each power of 2 from 4 kB is divided in 4 bins, of 1, 1.25, 1.5 and 1.75 times its size, so
+    // that at most 25% of a block is not used. The blocks are aligned to 64 bytes. The cached blocks are freed only
+    // when the pool is destroyed, and the pool must outlive all the blocks it has handed out.
+    class HostBufferPool {
+    public:
+      static constexpr unsigned int binsPerPowerOf2 = 4;
+      static constexpr unsigned int minBin = 12 * binsPerPowerOf2;  // 4 kB
+      static constexpr unsigned int maxBin = 40 * binsPerPowerOf2;  // 1 TB
+      static constexpr size_t alignment = 64;
+
+      HostBufferPool() = default;
+      ~HostBufferPool();
+
+      HostBufferPool(const HostBufferPool&) = delete;
+      HostBufferPool& operator=(const HostBufferPool&) = delete;
+      HostBufferPool(HostBufferPool&&) = delete;
+      HostBufferPool& operator=(HostBufferPool&&) = delete;
+
+      // bin of the blocks used for a request of the given size
+      static unsigned int bin(size_t bytes);
+
+      // size of the blocks of the given bin
+      static constexpr size_t binSize(unsigned int bin) {
+        return size_t(binsPerPowerOf2 + bin % binsPerPowerOf2) << (bin / binsPerPowerOf2 - 2);
+      }
+
+      // returns an uninitialised block of binSize(bin) bytes
+      void* allocate(unsigned int bin);
+
+      // gives the block back to the pool
+      void free(void* ptr, unsigned int bin);
+
+      // total number of bytes handed out by allocate() since the construction of the pool
+      uint64_t bytesRequested() const;
+
+      // total number of bytes obtained from the system since the construction of the pool
+      uint64_t bytesAllocated() const;
+
+    private:
+      mutable std::mutex mutex_;
+      std::vector<void*> cached_[maxBin + 1];
+      uint64_t bytesRequested_ = 0;
+      uint64_t bytesAllocated_ = 0;
+      uint64_t outstandingBlocks_ = 0;
+    };
+
+  }  // namespace cuda
+}  // namespace cms
+
+#endif
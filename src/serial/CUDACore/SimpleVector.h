@@ -91,6 +91,17 @@ namespace cms {
         }
       }
 
+      // thread-safe version of extend also on the CPU, when filled by several threads
+      int extend_concurrent(int size = 1) {
+        auto previousSize = cms::cudacompat::concurrent::atomicAdd(&m_size, size);
+        if (previousSize < m_capacity) {
+          return previousSize;
+        } else {
+          cms::cudacompat::concurrent::atomicSub(&m_size, size);
+          return -1;
+        }
+      }
+
       int shrink(int size = 1) {
         auto previousSize = atomicSub(&m_size, size);
         if (previousSize >= size) {
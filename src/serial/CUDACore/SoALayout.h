@@ -0,0 +1,164 @@
+#ifndef HeterogeneousCore_CUDAUtilities_interface_SoALayout_h
+#define HeterogeneousCore_CUDAUtilities_interface_SoALayout_h
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace cms {
+  namespace soa {
+
+    constexpr size_t defaultAlignment = 64;
+
+    constexpr bool isPowerOf2(size_t v) { return v && !(v & (v - 1)); }
+
+    constexpr size_t alignUp(size_t size, size_t alignment) { return (size + alignment - 1) / alignment * alignment; }
+
+    // a column with one element for each entry of the layout
+    template <typename T, size_t Alignment = defaultAlignment>
+    struct Column {
+      using type = T;
+      static constexpr size_t alignment = Alignment;
+      static constexpr size_t bytes(size_t nElements) { return nElements * sizeof(T); }
+    };
+
+    // a column with a fixed number of elements, whatever the number of entries of the layout
+    template <typename T, size_t N = 1, size_t Alignment = defaultAlignment>
+    struct Array {
+      using type = T;
+      static constexpr size_t alignment = Alignment;
+      static constexpr size_t bytes(size_t) { return N * sizeof(T); }
+    };
+
+    namespace impl {
+      // pointers to the columns of a layout, with element access
+      template <bool IsConst, typename... Columns>
+      class View {
+      public:
+        template <typename T>
+        using pointer = std::conditional_t<IsConst, T const*, T*>;
+        using Pointers = std::tuple<pointer<typename Columns::type>...>;
+
+        View() = default;
+        View(Pointers columns, uint32_t size) : columns_(columns), size_(size) {}
+
+        // a const view can be made from a mutable one
+        template <bool C = IsConst, typename = std::enable_if_t<C>>
+        View(View<false, Columns...> const& other) : columns_(other.columns()), size_(other.size()) {}
+
+        uint32_t size() const { return size_; }
+
+        Pointers const& columns() const { return columns_; }
+
+        template <size_t I>
+        auto get() const {
+          return std::get<I>(columns_);
+        }
+
+        template <size_t I>
+        auto& get(int i) const {
+          return std::get<I>(columns_)[i];
+        }
+
+      private:
+        Pointers columns_;
+        uint32_t size_ = 0;
+      };
+    }  // namespace impl
+
+    // Layout of a structure of arrays, whose columns are given as a list of Column and Array types, in a single
+    // contiguous buffer: each column starts at a multiple of its alignment (64 bytes by default) from the start of the
+    // data, that is itself aligned to the largest alignment of the columns. The offsets depend only on the column types
+    // and the number of entries, so that the data can be copied as a whole to another buffer, or to a file, and used
+    // from there through a new Layout with the same number of entries.
+    //
+    // The columns are accessed by index, e.g. layout.get<1>() for the pointer to the second column, or through a View
+    // or a ConstView, that can be passed by value to the kernels. The elements are not initialised.
+    template <typename... Columns>
+    class Layout {
+    public:
+      static constexpr size_t nColumns = sizeof...(Columns);
+      static constexpr size_t alignment = std::max({Columns::alignment...});
+
+      template <size_t I>
+      using column = std::tuple_element_t<I, std::tuple<Columns...>>;
+      template <size_t I>
+      using value_type = typename column<I>::type;
+
+      using View = impl::View<false, Columns...>;
+      using ConstView = impl::View<true, Columns...>;
+
+      static_assert(nColumns > 0, "A layout needs at least one column");
+      static_assert((isPowerOf2(Columns::alignment) && ...), "The column alignments must be powers of 2");
+      static_assert(((Columns::alignment >= alignof(typename Columns::type)) && ...),
+                    "The column alignments must be at least the alignment of their types");
+      static_assert((std::is_trivially_copyable<typename Columns::type>::value && ...) and
+                        (std::is_trivially_destructible<typename Columns::type>::value && ...),
+                    "The column types must be trivially copyable and destructible, to be relocated as bytes");
+
+      // size of the data of the columns, for nElements entries
+      static constexpr size_t dataSize(size_t nElements) {
+        size_t size = 0;
+        ((size = alignUp(size, Columns::alignment) + Columns::bytes(nElements)), ...);
+        return alignUp(size, alignment);
+      }
+
+      // size of a buffer that can hold the data for nElements entries, whatever the alignment of the buffer
+      static constexpr size_t bufferSize(size_t nElements) { return dataSize(nElements) + alignment - 1; }
+
+      Layout() = default;
+
+      // lays out the columns for nElements entries in the buffer, starting from its first aligned address
+      Layout(void* buffer, size_t bufferSize, size_t nElements) : nElements_(nElements) {
+        void* data = buffer;
+        size_t space = bufferSize;
+        data_ = static_cast<std::byte*>(std::align(alignment, dataSize(nElements), data, space));
+        assert(data_);
+        setColumns(std::index_sequence_for<Columns...>{});
+      }
+
+      uint32_t size() const { return nElements_; }
+
+      // the data of the columns, dataSize() contiguous bytes
+      std::byte* data() { return data_; }
+      std::byte const* data() const { return data_; }
+      size_t dataSize() const { return dataSize(nElements_); }
+
+      template <size_t I>
+      value_type<I>* get() {
+        return std::get<I>(columns_);
+      }
+
+      template <size_t I>
+      value_type<I> const* get() const {
+        return std::get<I>(columns_);
+      }
+
+      View view() { return View(columns_, nElements_); }
+      ConstView view() const { return ConstView(columns_, nElements_); }
+      ConstView constView() const { return ConstView(columns_, nElements_); }
+
+    private:
+      template <size_t... Is>
+      void setColumns(std::index_sequence<Is...>) {
+        size_t offset = 0;
+        ((offset = alignUp(offset, Columns::alignment),
+          std::get<Is>(columns_) = reinterpret_cast<typename Columns::type*>(data_ + offset),
+          offset += Columns::bytes(nElements_)),
+         ...);
+      }
+
+      std::byte* data_ = nullptr;
+      uint32_t nElements_ = 0;
+      typename View::Pointers columns_;
+    };
+
+  }  // namespace soa
+}  // namespace cms
+
+#endif  // HeterogeneousCore_CUDAUtilities_interface_SoALayout_h
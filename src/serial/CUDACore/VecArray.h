@@ -72,6 +72,18 @@ namespace cms {
         }
       }
 
+      // thread-safe version of the vector also on the CPU, when filled by several threads
+      int push_back_concurrent(const T &element) {
+        auto previousSize = cms::cudacompat::concurrent::atomicAdd(&m_size, 1);
+        if (previousSize < maxSize) {
+          m_data[previousSize] = element;
+          return previousSize;
+        } else {
+          cms::cudacompat::concurrent::atomicSub(&m_size, 1);
+          return -1;
+        }
+      }
+
       inline constexpr T pop_back() {
         if (m_size > 0) {
           auto previousSize = m_size--;
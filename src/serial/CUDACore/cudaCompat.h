@@ -61,6 +61,38 @@ namespace cms {
       return ret;
     }
 
+    // really atomic versions of the operations above, for the data structures that are filled by several threads
+    // within an event (e.g. with SERIAL_ENABLE_INTRA_EVENT_PARALLELISM)
+    namespace concurrent {
+
+      template <typename T1, typename T2>
+      T1 atomicCAS(T1* address, T1 compare, T2 val) {
+        __atomic_compare_exchange_n(address, &compare, T1(val), false, __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE);
+        return compare;
+      }
+
+      template <typename T1, typename T2>
+      T1 atomicAdd(T1* a, T2 b) {
+        return __atomic_fetch_add(a, T1(b), __ATOMIC_RELAXED);
+      }
+
+      template <typename T1, typename T2>
+      T1 atomicSub(T1* a, T2 b) {
+        return __atomic_fetch_sub(a, T1(b), __ATOMIC_RELAXED);
+      }
+
+      template <typename T1, typename T2>
+      T1 atomicOr(T1* a, T2 b) {
+        return __atomic_fetch_or(a, T1(b), __ATOMIC_RELAXED);
+      }
+
+      template <typename T>
+      T atomicLoad(T const* a) {
+        return __atomic_load_n(a, __ATOMIC_ACQUIRE);
+      }
+
+    }  // namespace concurrent
+
   }  // namespace cudacompat
 }  // namespace cms
 
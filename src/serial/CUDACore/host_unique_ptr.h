@@ -0,0 +1,68 @@
+#ifndef HeterogeneousCore_CUDAUtilities_interface_host_unique_ptr_h
+#define HeterogeneousCore_CUDAUtilities_interface_host_unique_ptr_h
+
+#include <memory>
+#include <type_traits>
+
+#include "CUDACore/HostBufferPool.h"
+
+namespace cms {
+  namespace cuda {
+    namespace host {
+      namespace impl {
+        // Additional layer of types to distinguish from std::unique_ptr
+        class HostDeleter {
+        public:
+          HostDeleter() = default;  // for edge cases where we need to initialize an empty unique_ptr
+          HostDeleter(HostBufferPool *pool, unsigned int bin) : pool_{pool}, bin_{bin} {}
+
+          void operator()(void *ptr) {
+            if (pool_) {
+              pool_->free(ptr, bin_);
+            }
+          }
+
+        private:
+          HostBufferPool *pool_ = nullptr;
+          unsigned int bin_ = 0;
+        };
+      }  // namespace impl
+
+      template <typename T>
+      using unique_ptr = std::unique_ptr<T, impl::HostDeleter>;
+
+      namespace impl {
+        template <typename T>
+        struct make_host_unique_selector {
+          using non_array = cms::cuda::host::unique_ptr<T>;
+        };
+        template <typename T>
+        struct make_host_unique_selector<T[]> {
+          using unbounded_array = cms::cuda::host::unique_ptr<T[]>;
+        };
+        template <typename T, size_t N>
+        struct make_host_unique_selector<T[N]> {
+          struct bounded_array {};
+        };
+      }  // namespace impl
+    }    // namespace host
+
+    // Allocate uninitialised memory for n elements from the pool, that takes it back when the unique_ptr is destroyed
+    template <typename T>
+    typename host::impl::make_host_unique_selector<T>::unbounded_array make_host_unique(size_t n, HostBufferPool &pool) {
+      using element_type = typename std::remove_extent<T>::type;
+      static_assert(std::is_trivially_constructible<element_type>::value and
+                        std::is_trivially_destructible<element_type>::value,
+                    "Allocating from the HostBufferPool is supported only for trivial types");
+      auto bin = HostBufferPool::bin(n * sizeof(element_type));
+      void *mem = pool.allocate(bin);
+      return typename host::impl::make_host_unique_selector<T>::unbounded_array{
+          reinterpret_cast<element_type *>(mem), host::impl::HostDeleter{&pool, bin}};
+    }
+
+    template <typename T, typename... Args>
+    typename host::impl::make_host_unique_selector<T>::bounded_array make_host_unique(Args &&...) = delete;
+  }  // namespace cuda
+}  // namespace cms
+
+#endif
@@ -2,13 +2,28 @@
 #define CUDADataFormats_SiPixelCluster_interface_SiPixelClustersSoA_h
 
 #include "CUDACore/cudaCompat.h"
+#include "CUDACore/host_unique_ptr.h"
+#include "CUDACore/SoALayout.h"
 
-#include <memory>
+#include <cstddef>
 
 class SiPixelClustersSoA {
 public:
+  // indices of the columns in the layout
+  struct Columns {
+    enum { moduleStart, clusInModule, moduleId, clusModuleStart };
+  };
+
+  // all the columns have maxClusters + 1 entries, as moduleStart and clusModuleStart need
+  using Layout = cms::soa::Layout<cms::soa::Column<uint32_t>,  // moduleStart: index of the first pixel of each module
+                                  cms::soa::Column<uint32_t>,  // clusInModule: number of clusters found in each module
+                                  cms::soa::Column<uint32_t>,  // moduleId: module id of each module
+                                  // originally from rechits
+                                  cms::soa::Column<uint32_t>>;  // clusModuleStart: index of the first cluster of each module
+
   SiPixelClustersSoA() = default;
-  explicit SiPixelClustersSoA(size_t maxClusters);
+  // the columns are left uninitialised
+  explicit SiPixelClustersSoA(size_t maxClusters, cms::cuda::HostBufferPool &pool);
   ~SiPixelClustersSoA() = default;
 
   SiPixelClustersSoA(const SiPixelClustersSoA &) = delete;
@@ -20,50 +35,42 @@ public:
 
   uint32_t nClusters() const { return nClusters_h; }
 
-  uint32_t *moduleStart() { return moduleStart_d.get(); }
-  uint32_t *clusInModule() { return clusInModule_d.get(); }
-  uint32_t *moduleId() { return moduleId_d.get(); }
-  uint32_t *clusModuleStart() { return clusModuleStart_d.get(); }
+  uint32_t *moduleStart() { return layout_.get<Columns::moduleStart>(); }
+  uint32_t *clusInModule() { return layout_.get<Columns::clusInModule>(); }
+  uint32_t *moduleId() { return layout_.get<Columns::moduleId>(); }
+  uint32_t *clusModuleStart() { return layout_.get<Columns::clusModuleStart>(); }
 
-  uint32_t const *moduleStart() const { return moduleStart_d.get(); }
-  uint32_t const *clusInModule() const { return clusInModule_d.get(); }
-  uint32_t const *moduleId() const { return moduleId_d.get(); }
-  uint32_t const *clusModuleStart() const { return clusModuleStart_d.get(); }
+  uint32_t const *moduleStart() const { return layout_.get<Columns::moduleStart>(); }
+  uint32_t const *clusInModule() const { return layout_.get<Columns::clusInModule>(); }
+  uint32_t const *moduleId() const { return layout_.get<Columns::moduleId>(); }
+  uint32_t const *clusModuleStart() const { return layout_.get<Columns::clusModuleStart>(); }
 
-  uint32_t const *c_moduleStart() const { return moduleStart_d.get(); }
-  uint32_t const *c_clusInModule() const { return clusInModule_d.get(); }
-  uint32_t const *c_moduleId() const { return moduleId_d.get(); }
-  uint32_t const *c_clusModuleStart() const { return clusModuleStart_d.get(); }
+  uint32_t const *c_moduleStart() const { return layout_.get<Columns::moduleStart>(); }
+  uint32_t const *c_clusInModule() const { return layout_.get<Columns::clusInModule>(); }
+  uint32_t const *c_moduleId() const { return layout_.get<Columns::moduleId>(); }
+  uint32_t const *c_clusModuleStart() const { return layout_.get<Columns::clusModuleStart>(); }
 
-  class DeviceConstView {
+  class DeviceConstView : public Layout::ConstView {
   public:
-    // DeviceConstView() = default;
-
-     inline  uint32_t moduleStart(int i) const { return moduleStart_[i]; }
-     inline  uint32_t clusInModule(int i) const { return clusInModule_[i]; }
-     inline  uint32_t moduleId(int i) const { return moduleId_[i]; }
-     inline  uint32_t clusModuleStart(int i) const { return clusModuleStart_[i]; }
+    DeviceConstView() = default;
+    explicit DeviceConstView(Layout::ConstView const &view) : Layout::ConstView(view) {}
 
-    friend SiPixelClustersSoA;
-
-    //   private:
-    uint32_t const *moduleStart_;
-    uint32_t const *clusInModule_;
-    uint32_t const *moduleId_;
-    uint32_t const *clusModuleStart_;
+    inline uint32_t moduleStart(int i) const { return get<Columns::moduleStart>(i); }
+    inline uint32_t clusInModule(int i) const { return get<Columns::clusInModule>(i); }
+    inline uint32_t moduleId(int i) const { return get<Columns::moduleId>(i); }
+    inline uint32_t clusModuleStart(int i) const { return get<Columns::clusModuleStart>(i); }
   };
 
-  DeviceConstView *view() const { return view_d.get(); }
-
-private:
-  std::unique_ptr<uint32_t[]> moduleStart_d;   // index of the first pixel of each module
-  std::unique_ptr<uint32_t[]> clusInModule_d;  // number of clusters found in each module
-  std::unique_ptr<uint32_t[]> moduleId_d;      // module id of each module
+  DeviceConstView const *view() const { return &view_; }
 
-  // originally from rechits
-  std::unique_ptr<uint32_t[]> clusModuleStart_d;  // index of the first cluster of each module
+  // all the columns, in a single contiguous buffer
+  Layout const &layout() const { return layout_; }
+  Layout &layout() { return layout_; }
 
-  std::unique_ptr<DeviceConstView> view_d;  // "me" pointer
+private:
+  cms::cuda::host::unique_ptr<std::byte[]> buffer_;
+  Layout layout_;
+  DeviceConstView view_;
 
   uint32_t nClusters_h;
 };
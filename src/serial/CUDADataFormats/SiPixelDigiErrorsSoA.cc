@@ -1,14 +1,12 @@
 #include "CUDADataFormats/SiPixelDigiErrorsSoA.h"
 
 #include <cassert>
-#include <cstring>
 
-SiPixelDigiErrorsSoA::SiPixelDigiErrorsSoA(size_t maxFedWords, PixelFormatterErrors errors)
+SiPixelDigiErrorsSoA::SiPixelDigiErrorsSoA(size_t maxFedWords,
+                                           PixelFormatterErrors errors,
+                                           cms::cuda::HostBufferPool& pool)
     : formatterErrors_h(std::move(errors)) {
-  error_d = std::make_unique<cms::cuda::SimpleVector<PixelErrorCompact>>();
-  data_d = std::make_unique<PixelErrorCompact[]>(maxFedWords);
-
-  std::memset(data_d.get(), 0x00, maxFedWords);
+  data_d = cms::cuda::make_host_unique<PixelErrorCompact[]>(maxFedWords, pool);
 
   error_d = std::make_unique<cms::cuda::SimpleVector<PixelErrorCompact>>();
   cms::cuda::make_SimpleVector(error_d.get(), maxFedWords, data_d.get());
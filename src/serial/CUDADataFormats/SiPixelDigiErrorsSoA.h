@@ -4,12 +4,14 @@
 #include <memory>
 
 #include "CUDACore/SimpleVector.h"
+#include "CUDACore/host_unique_ptr.h"
 #include "DataFormats/PixelErrors.h"
 
 class SiPixelDigiErrorsSoA {
 public:
   SiPixelDigiErrorsSoA() = default;
-  explicit SiPixelDigiErrorsSoA(size_t maxFedWords, PixelFormatterErrors errors);
+  // the error buffer is left uninitialised
+  explicit SiPixelDigiErrorsSoA(size_t maxFedWords, PixelFormatterErrors errors, cms::cuda::HostBufferPool& pool);
   ~SiPixelDigiErrorsSoA() = default;
 
   SiPixelDigiErrorsSoA(const SiPixelDigiErrorsSoA&) = delete;
@@ -24,7 +26,7 @@ public:
   cms::cuda::SimpleVector<PixelErrorCompact> const* c_error() const { return error_d.get(); }
 
 private:
-  std::unique_ptr<PixelErrorCompact[]> data_d;
+  cms::cuda::host::unique_ptr<PixelErrorCompact[]> data_d;
   std::unique_ptr<cms::cuda::SimpleVector<PixelErrorCompact>> error_d;
   PixelFormatterErrors formatterErrors_h;
 };
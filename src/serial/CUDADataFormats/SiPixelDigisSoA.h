@@ -2,13 +2,33 @@
 #define CUDADataFormats_SiPixelDigi_interface_SiPixelDigisSoA_h
 
 #include "CUDACore/cudaCompat.h"
+#include "CUDACore/host_unique_ptr.h"
+#include "CUDACore/SoALayout.h"
 
-#include <memory>
+#include <cstddef>
 
 class SiPixelDigisSoA {
 public:
+  // indices of the columns in the layout
+  struct Columns {
+    enum { xx, yy, adc, moduleInd, clus, pdigi, rawIdArr };
+  };
+
+  using Layout = cms::soa::Layout<
+      // These are consumed by downstream device code
+      cms::soa::Column<uint16_t>,  // xx: local coordinates of each pixel
+      cms::soa::Column<uint16_t>,  // yy
+      cms::soa::Column<uint16_t>,  // adc: ADC of each pixel
+      cms::soa::Column<uint16_t>,  // moduleInd: module id of each pixel
+      cms::soa::Column<int32_t>,   // clus: cluster id of each pixel
+      // These are for CPU output; should we (eventually) place them to a
+      // separate product?
+      cms::soa::Column<uint32_t>,   // pdigi
+      cms::soa::Column<uint32_t>>;  // rawIdArr
+
   SiPixelDigisSoA() = default;
-  explicit SiPixelDigisSoA(size_t maxFedWords);
+  // the columns are left uninitialised
+  explicit SiPixelDigisSoA(size_t maxFedWords, cms::cuda::HostBufferPool &pool);
   ~SiPixelDigisSoA() = default;
 
   SiPixelDigisSoA(const SiPixelDigisSoA &) = delete;
@@ -24,65 +44,52 @@ public:
   uint32_t nModules() const { return nModules_h; }
   uint32_t nDigis() const { return nDigis_h; }
 
-  uint16_t *xx() { return xx_d.get(); }
-  uint16_t *yy() { return yy_d.get(); }
-  uint16_t *adc() { return adc_d.get(); }
-  uint16_t *moduleInd() { return moduleInd_d.get(); }
-  int32_t *clus() { return clus_d.get(); }
-  uint32_t *pdigi() { return pdigi_d.get(); }
-  uint32_t *rawIdArr() { return rawIdArr_d.get(); }
-
-  uint16_t const *xx() const { return xx_d.get(); }
-  uint16_t const *yy() const { return yy_d.get(); }
-  uint16_t const *adc() const { return adc_d.get(); }
-  uint16_t const *moduleInd() const { return moduleInd_d.get(); }
-  int32_t const *clus() const { return clus_d.get(); }
-  uint32_t const *pdigi() const { return pdigi_d.get(); }
-  uint32_t const *rawIdArr() const { return rawIdArr_d.get(); }
-
-  uint16_t const *c_xx() const { return xx_d.get(); }
-  uint16_t const *c_yy() const { return yy_d.get(); }
-  uint16_t const *c_adc() const { return adc_d.get(); }
-  uint16_t const *c_moduleInd() const { return moduleInd_d.get(); }
-  int32_t const *c_clus() const { return clus_d.get(); }
-  uint32_t const *c_pdigi() const { return pdigi_d.get(); }
-  uint32_t const *c_rawIdArr() const { return rawIdArr_d.get(); }
-
-  class DeviceConstView {
+  uint16_t *xx() { return layout_.get<Columns::xx>(); }
+  uint16_t *yy() { return layout_.get<Columns::yy>(); }
+  uint16_t *adc() { return layout_.get<Columns::adc>(); }
+  uint16_t *moduleInd() { return layout_.get<Columns::moduleInd>(); }
+  int32_t *clus() { return layout_.get<Columns::clus>(); }
+  uint32_t *pdigi() { return layout_.get<Columns::pdigi>(); }
+  uint32_t *rawIdArr() { return layout_.get<Columns::rawIdArr>(); }
+
+  uint16_t const *xx() const { return layout_.get<Columns::xx>(); }
+  uint16_t const *yy() const { return layout_.get<Columns::yy>(); }
+  uint16_t const *adc() const { return layout_.get<Columns::adc>(); }
+  uint16_t const *moduleInd() const { return layout_.get<Columns::moduleInd>(); }
+  int32_t const *clus() const { return layout_.get<Columns::clus>(); }
+  uint32_t const *pdigi() const { return layout_.get<Columns::pdigi>(); }
+  uint32_t const *rawIdArr() const { return layout_.get<Columns::rawIdArr>(); }
+
+  uint16_t const *c_xx() const { return layout_.get<Columns::xx>(); }
+  uint16_t const *c_yy() const { return layout_.get<Columns::yy>(); }
+  uint16_t const *c_adc() const { return layout_.get<Columns::adc>(); }
+  uint16_t const *c_moduleInd() const { return layout_.get<Columns::moduleInd>(); }
+  int32_t const *c_clus() const { return layout_.get<Columns::clus>(); }
+  uint32_t const *c_pdigi() const { return layout_.get<Columns::pdigi>(); }
+  uint32_t const *c_rawIdArr() const { return layout_.get<Columns::rawIdArr>(); }
+
+  class DeviceConstView : public Layout::ConstView {
   public:
-    // DeviceConstView() = default;
-
-     inline  uint16_t xx(int i) const { return xx_[i]; }
-     inline  uint16_t yy(int i) const { return yy_[i]; }
-     inline  uint16_t adc(int i) const { return adc_[i]; }
-     inline  uint16_t moduleInd(int i) const { return moduleInd_[i]; }
-     inline  int32_t clus(int i) const { return clus_[i]; }
-
-    friend class SiPixelDigisSoA;
-
-    // private:
-    uint16_t const *xx_;
-    uint16_t const *yy_;
-    uint16_t const *adc_;
-    uint16_t const *moduleInd_;
-    int32_t const *clus_;
+    DeviceConstView() = default;
+    explicit DeviceConstView(Layout::ConstView const &view) : Layout::ConstView(view) {}
+
+    inline uint16_t xx(int i) const { return get<Columns::xx>(i); }
+    inline uint16_t yy(int i) const { return get<Columns::yy>(i); }
+    inline uint16_t adc(int i) const { return get<Columns::adc>(i); }
+    inline uint16_t moduleInd(int i) const { return get<Columns::moduleInd>(i); }
+    inline int32_t clus(int i) const { return get<Columns::clus>(i); }
   };
 
-  const DeviceConstView *view() const { return view_d.get(); }
+  const DeviceConstView *view() const { return &view_; }
+
+  // all the columns, in a single contiguous buffer
+  Layout const &layout() const { return layout_; }
+  Layout &layout() { return layout_; }
 
 private:
-  // These are consumed by downstream device code
-  std::unique_ptr<uint16_t[]> xx_d;         // local coordinates of each pixel
-  std::unique_ptr<uint16_t[]> yy_d;         //
-  std::unique_ptr<uint16_t[]> adc_d;        // ADC of each pixel
-  std::unique_ptr<uint16_t[]> moduleInd_d;  // module id of each pixel
-  std::unique_ptr<int32_t[]> clus_d;        // cluster id of each pixel
-  std::unique_ptr<DeviceConstView> view_d;  // "me" pointer
-
-  // These are for CPU output; should we (eventually) place them to a
-  // separate product?
-  std::unique_ptr<uint32_t[]> pdigi_d;
-  std::unique_ptr<uint32_t[]> rawIdArr_d;
+  cms::cuda::host::unique_ptr<std::byte[]> buffer_;
+  Layout layout_;
+  DeviceConstView view_;
 
   uint32_t nModules_h = 0;
   uint32_t nDigis_h = 0;
@@ -1,8 +1,11 @@
 #ifndef CUDADataFormats_TrackingRecHit_interface_TrackingRecHit2DHeterogeneous_h
 #define CUDADataFormats_TrackingRecHit_interface_TrackingRecHit2DHeterogeneous_h
 
+#include <cstddef>
+
 #include "CUDADataFormats/TrackingRecHit2DSOAView.h"
 #include "CUDADataFormats/HeterogeneousSoA.h"
+#include "CUDACore/SoALayout.h"
 
 template <typename Traits>
 class TrackingRecHit2DHeterogeneous {
@@ -11,6 +14,38 @@ public:
   using unique_ptr = typename Traits::template unique_ptr<T>;
 
   using Hist = TrackingRecHit2DSOAView::Hist;
+  using AverageGeometry = TrackingRecHit2DSOAView::AverageGeometry;
+
+  // indices of the columns in the layout
+  struct Columns {
+    enum { xl, yl, xerr, yerr, xg, yg, zg, rg, charge, iphi, xsize, ysize, detInd, hitsLayerStart, hist, averageGeometry };
+  };
+
+  // the hits are actually accessed in order only in building
+  // if ordering is relevant they may have to be stored phi-ordered by layer or so
+  // this will break 1to1 correspondence with cluster and module locality
+  // so unless proven VERY inefficient we keep it ordered as generated
+  using Layout = cms::soa::Layout<
+      // local coord
+      cms::soa::Column<float>,  // xl
+      cms::soa::Column<float>,  // yl
+      cms::soa::Column<float>,  // xerr
+      cms::soa::Column<float>,  // yerr
+      // global coord
+      cms::soa::Column<float>,  // xg
+      cms::soa::Column<float>,  // yg
+      cms::soa::Column<float>,  // zg
+      cms::soa::Column<float>,  // rg
+      // cluster properties
+      cms::soa::Column<int32_t>,   // charge
+      cms::soa::Column<int16_t>,   // iphi
+      cms::soa::Column<int16_t>,   // xsize
+      cms::soa::Column<int16_t>,   // ysize
+      cms::soa::Column<uint16_t>,  // detInd
+      // per layer and per event
+      cms::soa::Array<uint32_t, 11>,     // hitsLayerStart
+      cms::soa::Array<Hist>,             // hist
+      cms::soa::Array<AverageGeometry>>;  // averageGeometry
 
   TrackingRecHit2DHeterogeneous() = default;
 
@@ -36,16 +71,13 @@ public:
   auto phiBinner() { return m_hist; }
   auto iphi() { return m_iphi; }
 
-private:
-  static constexpr uint32_t n16 = 4;
-  static constexpr uint32_t n32 = 9;
-  static_assert(sizeof(uint32_t) == sizeof(float));  // just stating the obvious
-
-  unique_ptr<uint16_t[]> m_store16;  //!
-  unique_ptr<float[]> m_store32;     //!
+  // all the columns, in a single contiguous buffer
+  Layout const& layout() const { return m_layout; }
+  Layout& layout() { return m_layout; }
 
-  unique_ptr<TrackingRecHit2DSOAView::Hist> m_HistStore;                        //!
-  unique_ptr<TrackingRecHit2DSOAView::AverageGeometry> m_AverageGeometryStore;  //!
+private:
+  unique_ptr<std::byte[]> m_store;  //!
+  Layout m_layout;
 
   unique_ptr<TrackingRecHit2DSOAView> m_view;  //!
 
@@ -68,51 +100,35 @@ TrackingRecHit2DHeterogeneous<Traits>::TrackingRecHit2DHeterogeneous(uint32_t nH
   auto view = Traits::template make_host_unique<TrackingRecHit2DSOAView>(stream);
 
   view->m_nHits = nHits;
-  m_view = Traits::template make_device_unique<TrackingRecHit2DSOAView>(stream);
-  m_AverageGeometryStore = Traits::template make_device_unique<TrackingRecHit2DSOAView::AverageGeometry>(stream);
-  view->m_averageGeometry = m_AverageGeometryStore.get();
   view->m_cpeParams = cpeParams;
   view->m_hitsModuleStart = hitsModuleStart;
 
-  // if empy do not bother
-  if (0 == nHits) {
-    m_view.reset(view.release());  // NOLINT: std::move() breaks CUDA version
-    return;
-  }
-
-  // the single arrays are not 128 bit alligned...
-  // the hits are actually accessed in order only in building
-  // if ordering is relevant they may have to be stored phi-ordered by layer or so
-  // this will break 1to1 correspondence with cluster and module locality
-  // so unless proven VERY inefficient we keep it ordered as generated
-  m_store16 = Traits::template make_device_unique<uint16_t[]>(nHits * n16, stream);
-  m_store32 = Traits::template make_device_unique<float[]>(nHits * n32 + 11, stream);
-  m_HistStore = Traits::template make_device_unique<TrackingRecHit2DSOAView::Hist>(stream);
-
-  auto get16 = [&](int i) { return m_store16.get() + i * nHits; };
-  auto get32 = [&](int i) { return m_store32.get() + i * nHits; };
+  // a single allocation for all the columns, the per layer and the per event data
+  auto storeSize = Layout::bufferSize(nHits);
+  m_store = Traits::template make_device_unique<std::byte[]>(storeSize, stream);
+  m_layout = Layout(m_store.get(), storeSize, nHits);
 
   // copy all the pointers
-  m_hist = view->m_hist = m_HistStore.get();
-
-  view->m_xl = get32(0);
-  view->m_yl = get32(1);
-  view->m_xerr = get32(2);
-  view->m_yerr = get32(3);
-
-  view->m_xg = get32(4);
-  view->m_yg = get32(5);
-  view->m_zg = get32(6);
-  view->m_rg = get32(7);
-
-  m_iphi = view->m_iphi = reinterpret_cast<int16_t*>(get16(0));
-
-  view->m_charge = reinterpret_cast<int32_t*>(get32(8));
-  view->m_xsize = reinterpret_cast<int16_t*>(get16(2));
-  view->m_ysize = reinterpret_cast<int16_t*>(get16(3));
-  view->m_detInd = get16(1);
-
-  m_hitsLayerStart = view->m_hitsLayerStart = reinterpret_cast<uint32_t*>(get32(n32));
+  view->m_xl = m_layout.template get<Columns::xl>();
+  view->m_yl = m_layout.template get<Columns::yl>();
+  view->m_xerr = m_layout.template get<Columns::xerr>();
+  view->m_yerr = m_layout.template get<Columns::yerr>();
+
+  view->m_xg = m_layout.template get<Columns::xg>();
+  view->m_yg = m_layout.template get<Columns::yg>();
+  view->m_zg = m_layout.template get<Columns::zg>();
+  view->m_rg = m_layout.template get<Columns::rg>();
+
+  m_iphi = view->m_iphi = m_layout.template get<Columns::iphi>();
+
+  view->m_charge = m_layout.template get<Columns::charge>();
+  view->m_xsize = m_layout.template get<Columns::xsize>();
+  view->m_ysize = m_layout.template get<Columns::ysize>();
+  view->m_detInd = m_layout.template get<Columns::detInd>();
+
+  m_hitsLayerStart = view->m_hitsLayerStart = m_layout.template get<Columns::hitsLayerStart>();
+  m_hist = view->m_hist = m_layout.template get<Columns::hist>();
+  view->m_averageGeometry = m_layout.template get<Columns::averageGeometry>();
 
   // transfer view
   m_view.reset(view.release());  // NOLINT: std::move() breaks CUDA version
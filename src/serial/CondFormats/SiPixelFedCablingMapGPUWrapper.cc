@@ -7,9 +7,53 @@
 // CMSSW includes
 #include "CondFormats/SiPixelFedCablingMapGPUWrapper.h"
 
+namespace {
+  // Phase 1 geometry constants, as in SiPixelRawToClusterGPUKernel.h
+  constexpr unsigned int layerStartBit = 20;
+  constexpr unsigned int moduleStartBit = 2;
+  constexpr unsigned int layerMask = 0xF;
+  constexpr unsigned int moduleMask = 0x3FF;
+  constexpr unsigned int numColsInRoc = 52;
+
+  SiPixelROCFrameGPU makeROCFrame(SiPixelFedCablingMapGPU const& cablingMap,
+                                  std::vector<unsigned char> const& modToUnp,
+                                  unsigned int index) {
+    unsigned int rawId = cablingMap.RawId[index];
+    unsigned int rocIdInDetUnit = cablingMap.rocInDet[index];
+    bool barrel = (1 == ((rawId >> 25) & 0x7));
+    unsigned int layer = barrel ? (rawId >> layerStartBit) & layerMask : 0;
+    unsigned int module = (rawId >> moduleStartBit) & moduleMask;
+
+    // as in frameConversion(): the BPix modules on the -Z side except those of layer 1 are oriented like 'dddd',
+    // the other BPix modules like 'pppp', and the FPix modules like 'dddd'
+    bool pppp = barrel and (layer == 1 or module >= 5);
+    bool first = rocIdInDetUnit < 8;
+    unsigned int colOffset;
+    if (pppp) {
+      colOffset = first ? rocIdInDetUnit * numColsInRoc : (16 - rocIdInDetUnit) * numColsInRoc - 1;
+    } else {
+      colOffset = first ? (8 - rocIdInDetUnit) * numColsInRoc - 1 : (rocIdInDetUnit - 8) * numColsInRoc;
+    }
+
+    unsigned int flags = 0;
+    if (layer == 1)
+      flags |= pixelgpudetails::ROC_LAYER1;
+    if (pppp == first)
+      flags |= pixelgpudetails::ROC_FLIPPED;
+    if (cablingMap.badRocs[index])
+      flags |= pixelgpudetails::ROC_BAD;
+    if (index < modToUnp.size() and modToUnp[index])
+      flags |= pixelgpudetails::ROC_NOT_UNPACKED;
+    return SiPixelROCFrameGPU{rawId, cablingMap.moduleId[index], colOffset, flags};
+  }
+}  // namespace
+
 SiPixelFedCablingMapGPUWrapper::SiPixelFedCablingMapGPUWrapper(SiPixelFedCablingMapGPU const& cablingMap,
                                                                std::vector<unsigned char> modToUnp)
   : modToUnpDefault(modToUnp.size()), hasQuality_(true), cablingMapHost(cablingMap) {
   std::copy(modToUnp.begin(), modToUnp.end(), modToUnpDefault.begin());
+  for (unsigned int i = 0; i < pixelgpudetails::MAX_SIZE; ++i) {
+    rocFramesHost.roc[i] = makeROCFrame(cablingMap, modToUnpDefault, i);
+  }
 }
 
@@ -17,11 +17,15 @@ public:
 
   const unsigned char *getModToUnpAll() const { return modToUnpDefault.data(); }
 
+  // the cabling map and the modules to unpack, combined per ROC for the raw data decoding
+  const SiPixelROCFramesGPU *getROCFrames() const { return &rocFramesHost; }
+
 private:
   std::vector<unsigned char> modToUnpDefault;
   bool hasQuality_;
 
   SiPixelFedCablingMapGPU cablingMapHost;
+  SiPixelROCFramesGPU rocFramesHost;
 };
 
 #endif
@@ -1,11 +1,48 @@
+#include <iterator>
+#include <stdexcept>
+#include <string>
+
 #include "CondFormats/SiPixelGainCalibrationForHLTGPU.h"
 #include "CondFormats/SiPixelGainForHLTonGPU.h"
+#include "Geometry/phase1PixelTopology.h"
 
 SiPixelGainCalibrationForHLTGPU::SiPixelGainCalibrationForHLTGPU(SiPixelGainForHLTonGPU const& gain,
                                                                  std::vector<char> gainData)
-    : gainData_(std::move(gainData)) {
+    : gainData_(std::move(gainData)), tableOnHost_(std::make_unique<SiPixelGainTableForHLT>()) {
+  // replace the division by the number of rows in each block with a multiplication
+  unsigned int rows = gain.numberOfRowsAveragedOver_;
+  tableOnHost_->rowBlockMultiplier = rows > 0 ? ((1u << 16) + rows - 1) / rows : 0;
+  for (unsigned int row = 0; row < phase1PixelTopology::numRowsInModule; ++row) {
+    if (rows == 0 or (row * tableOnHost_->rowBlockMultiplier) >> 16 != row / rows) {
+      throw std::runtime_error("Unsupported number of rows averaged over in the gain calibration: " +
+                               std::to_string(rows));
+    }
+  }
+
   gainForHLTonHost_ = new SiPixelGainForHLTonGPU(gain);
+
+  // the blocks of 2 bytes, read in pairs; pad the data to a whole number of words
+  gainData_.resize((gainData_.size() + 3) / 4 * 4);
   gainForHLTonHost_->v_pedestals = reinterpret_cast<SiPixelGainForHLTonGPU_DecodingStructure*>(gainData_.data());
+  tableOnHost_->blockPairs = reinterpret_cast<uint32_t const*>(gainData_.data());
+
+  // decode all the codes as in SiPixelGainForHLTonGPU::getPedAndGain()
+  auto const& g = *gainForHLTonHost_;
+  for (unsigned int code = 0; code < 256; ++code) {
+    tableOnHost_->pedestal[code] = g.decodePed(code);
+    tableOnHost_->gain[code] = g.decodeGain(code);
+    if (code == g.deadFlag_ or code == g.noisyFlag_) {
+      tableOnHost_->badPedestal[code / 32] |= 1u << (code % 32);
+    }
+  }
+
+  for (unsigned int m = 0; m < std::size(g.rangeAndCols); ++m) {
+    auto range = g.rangeAndCols[m].first;
+    auto nCols = g.rangeAndCols[m].second;
+    // lengthOfColumnData in getPedAndGain(), in blocks of 2 bytes
+    tableOnHost_->firstBlock[m] = range.first / 2;
+    tableOnHost_->blocksPerColumn[m] = nCols > 0 ? (range.second - range.first) / nCols / 2 : 0;
+  }
 }
 
 SiPixelGainCalibrationForHLTGPU::~SiPixelGainCalibrationForHLTGPU() {
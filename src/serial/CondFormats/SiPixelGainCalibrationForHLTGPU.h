@@ -1,10 +1,10 @@
 #ifndef CalibTracker_SiPixelESProducers_interface_SiPixelGainCalibrationForHLTGPU_h
 #define CalibTracker_SiPixelESProducers_interface_SiPixelGainCalibrationForHLTGPU_h
 
+#include <memory>
 #include <vector>
 
-class SiPixelGainForHLTonGPU;
-struct SiPixelGainForHLTonGPU_DecodingStructure;
+#include "CondFormats/SiPixelGainForHLTonGPU.h"
 
 class SiPixelGainCalibrationForHLTGPU {
 public:
@@ -13,9 +13,14 @@ public:
 
   const SiPixelGainForHLTonGPU *getCPUProduct() const { return gainForHLTonHost_; }
 
+  // the same calibration, prepared for the vectorised calibration
+  const SiPixelGainTableForHLT *getCPUTable() const { return tableOnHost_.get(); }
+
 private:
   SiPixelGainForHLTonGPU *gainForHLTonHost_ = nullptr;
   std::vector<char> gainData_;
+
+  std::unique_ptr<SiPixelGainTableForHLT> tableOnHost_;
 };
 
 #endif  // CalibTracker_SiPixelESProducers_interface_SiPixelGainCalibrationForHLTGPU_h
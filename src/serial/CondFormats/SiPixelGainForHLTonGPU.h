@@ -60,4 +60,20 @@ public:
   unsigned int noisyFlag_;
 };
 
+// The calibration of SiPixelGainForHLTonGPU prepared in advance for the vectorised calibration on the CPU:
+// the pixel (row, col) of a module is in the block firstBlock + col * blocksPerColumn + row / numberOfRowsAveragedOver_
+// of the module, and row / numberOfRowsAveragedOver_ == (row * rowBlockMultiplier) >> 16 for all the rows of a module.
+// The blocks keep their 8-bit codes, read in pairs as 32-bit words, that are decoded with the tables of the 256 values
+// of the pedestal and of the gain, and the mask of the pedestal codes that flag dead and noisy columns.
+struct SiPixelGainTableForHLT {
+  uint32_t firstBlock[2000];
+  uint32_t blocksPerColumn[2000];
+  uint32_t rowBlockMultiplier;
+  uint32_t const* blockPairs;
+
+  float pedestal[256];
+  float gain[256];
+  uint32_t badPedestal[256 / 32];
+};
+
 #endif  // CondFormats_SiPixelObjects_SiPixelGainForHLTonGPU_h
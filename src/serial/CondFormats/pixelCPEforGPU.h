@@ -127,48 +127,39 @@ namespace pixelCPEforGPU {
                                     bool first_is_big,              //!< true if the first is big
                                     bool last_is_big)               //!< true if the last is big
   {
-    if (0 == sizeM1)  // size 1
-      return 0;
-
-    float W_eff = 0;
-    bool simple = true;
-    if (1 == sizeM1) {  // size 2
-      //--- Width of the clusters minus the edge (first and last) pixels.
-      //--- In the note, they are denoted x_F and x_L (and y_F and y_L)
-      // assert(lower_edge_last_pix >= upper_edge_first_pix);
-      auto W_inner = pitch * float(lower_edge_last_pix - upper_edge_first_pix);  // in cm
-
-      //--- Predicted charge width from geometry
-      auto W_pred = theThickness * cot_angle  // geometric correction (in cm)
-                    - lorentz_shift;          // (in cm) &&& check fpix!
-
-      W_eff = std::abs(W_pred) - W_inner;
-
-      //--- If the observed charge width is inconsistent with the expectations
-      //--- based on the track, do *not* use W_pred-W_inner.  Instead, replace
-      //--- it with an *average* effective charge width, which is the average
-      //--- length of the edge pixels.
-      simple =
-          (W_eff < 0.0f) | (W_eff > pitch);  // this produces "large" regressions for very small numeric differences...
-    }
+    // all the terms are computed for all the sizes, and the ones that apply are selected, without branches
 
-    if (simple) {
-      //--- Total length of the two edge pixels (first+last)
-      float sum_of_edge = 2.0f;
-      if (first_is_big)
-        sum_of_edge += 1.0f;
-      if (last_is_big)
-        sum_of_edge += 1.0f;
-      W_eff = pitch * 0.5f * sum_of_edge;  // ave. length of edge pixels (first+last) (cm)
-    }
+    //--- Width of the clusters minus the edge (first and last) pixels.
+    //--- In the note, they are denoted x_F and x_L (and y_F and y_L)
+    // assert(lower_edge_last_pix >= upper_edge_first_pix);
+    auto W_inner = pitch * float(lower_edge_last_pix - upper_edge_first_pix);  // in cm
+
+    //--- Predicted charge width from geometry
+    auto W_pred = theThickness * cot_angle  // geometric correction (in cm)
+                  - lorentz_shift;          // (in cm) &&& check fpix!
+
+    float W_eff = std::abs(W_pred) - W_inner;
+
+    //--- If the observed charge width is inconsistent with the expectations
+    //--- based on the track, do *not* use W_pred-W_inner.  Instead, replace
+    //--- it with an *average* effective charge width, which is the average
+    //--- length of the edge pixels.
+    //--- Only the clusters of size 2 can use W_pred-W_inner.
+    bool simple = (1 != sizeM1) | (W_eff < 0.0f) |
+                  (W_eff > pitch);  // this produces "large" regressions for very small numeric differences...
+
+    //--- Total length of the two edge pixels (first+last)
+    float sum_of_edge = 2.0f + (first_is_big ? 1.0f : 0.0f) + (last_is_big ? 1.0f : 0.0f);
+    float W_edge = pitch * 0.5f * sum_of_edge;  // ave. length of edge pixels (first+last) (cm)
+    W_eff = simple ? W_edge : W_eff;
 
     //--- Finally, compute the position in this projection
-    float Qdiff = Q_l - Q_f;
+    //--- No correction for the clusters of size 1
+    float Qdiff = (0 == sizeM1) ? 0 : Q_l - Q_f;
     float Qsum = Q_l + Q_f;
 
     //--- Temporary fix for clusters with both first and last pixel with charge = 0
-    if (Qsum == 0)
-      Qsum = 1.0f;
+    Qsum = (Qsum == 0) ? 1.0f : Qsum;
 
     return 0.5f * (Qdiff / Qsum) * W_eff;
   }
@@ -195,30 +186,28 @@ namespace pixelCPEforGPU {
 
     auto xsize = int(urxl) + 2 - int(llxl);
     auto ysize = int(uryl) + 2 - int(llyl);
+#ifdef GPU_DEBUG
     assert(xsize >= 0);  // 0 if bixpix...
     assert(ysize >= 0);
+#endif
 
-    if (phase1PixelTopology::isBigPixX(cp.minRow[ic]))
-      ++xsize;
-    if (phase1PixelTopology::isBigPixX(cp.maxRow[ic]))
-      ++xsize;
-    if (phase1PixelTopology::isBigPixY(cp.minCol[ic]))
-      ++ysize;
-    if (phase1PixelTopology::isBigPixY(cp.maxCol[ic]))
-      ++ysize;
+    xsize += phase1PixelTopology::isBigPixX(cp.minRow[ic]);
+    xsize += phase1PixelTopology::isBigPixX(cp.maxRow[ic]);
+    ysize += phase1PixelTopology::isBigPixY(cp.minCol[ic]);
+    ysize += phase1PixelTopology::isBigPixY(cp.maxCol[ic]);
 
     int unbalanceX = 8. * std::abs(float(cp.Q_f_X[ic] - cp.Q_l_X[ic])) / float(cp.Q_f_X[ic] + cp.Q_l_X[ic]);
     int unbalanceY = 8. * std::abs(float(cp.Q_f_Y[ic] - cp.Q_l_Y[ic])) / float(cp.Q_f_Y[ic] + cp.Q_l_Y[ic]);
     xsize = 8 * xsize - unbalanceX;
     ysize = 8 * ysize - unbalanceY;
 
-    cp.xsize[ic] = std::min(xsize, 1023);
-    cp.ysize[ic] = std::min(ysize, 1023);
+    xsize = std::min(xsize, 1023);
+    ysize = std::min(ysize, 1023);
 
-    if (cp.minRow[ic] == 0 || cp.maxRow[ic] == phase1PixelTopology::lastRowInModule)
-      cp.xsize[ic] = -cp.xsize[ic];
-    if (cp.minCol[ic] == 0 || cp.maxCol[ic] == phase1PixelTopology::lastColInModule)
-      cp.ysize[ic] = -cp.ysize[ic];
+    bool isEdgeX = (cp.minRow[ic] == 0) | (cp.maxRow[ic] == phase1PixelTopology::lastRowInModule);
+    bool isEdgeY = (cp.minCol[ic] == 0) | (cp.maxCol[ic] == phase1PixelTopology::lastColInModule);
+    cp.xsize[ic] = isEdgeX ? -xsize : xsize;
+    cp.ysize[ic] = isEdgeY ? -ysize : ysize;
 
     // apply the lorentz offset correction
     auto xPos = detParams.shiftX + comParams.thePitchX * (0.5f * float(mx) + float(phase1PixelTopology::xOffset));
@@ -317,26 +306,24 @@ namespace pixelCPEforGPU {
                                     DetParams const& __restrict__ detParams,
                                     ClusParams& cp,
                                     uint32_t ic) {
-    // Edge cluster errors
-    cp.xerr[ic] = 0.0050f;
-    cp.yerr[ic] = 0.0085f;
-
     auto sx = cp.maxRow[ic] - cp.minRow[ic];
     auto sy = cp.maxCol[ic] - cp.minCol[ic];
 
     // is edgy ?
-    bool isEdgeX = cp.minRow[ic] == 0 or cp.maxRow[ic] == phase1PixelTopology::lastRowInModule;
-    bool isEdgeY = cp.minCol[ic] == 0 or cp.maxCol[ic] == phase1PixelTopology::lastColInModule;
+    bool isEdgeX = (cp.minRow[ic] == 0) | (cp.maxRow[ic] == phase1PixelTopology::lastRowInModule);
+    bool isEdgeY = (cp.minCol[ic] == 0) | (cp.maxCol[ic] == phase1PixelTopology::lastColInModule);
     // is one and big?
     uint32_t ix = (0 == sx);
     uint32_t iy = (0 == sy);
     ix += (0 == sx) && phase1PixelTopology::isBigPixX(cp.minRow[ic]);
     iy += (0 == sy) && phase1PixelTopology::isBigPixY(cp.minCol[ic]);
 
-    if (not isEdgeX)
-      cp.xerr[ic] = detParams.sx[ix];
-    if (not isEdgeY)
-      cp.yerr[ic] = detParams.sy[iy];
+    float xerr = detParams.sx[ix];
+    float yerr = detParams.sy[iy];
+
+    // Edge cluster errors
+    cp.xerr[ic] = isEdgeX ? 0.0050f : xerr;
+    cp.yerr[ic] = isEdgeY ? 0.0085f : yerr;
   }
 
 }  // namespace pixelCPEforGPU
@@ -0,0 +1,28 @@
+#include <algorithm>
+
+#include "DataFormats/FEDNumbering.h"
+#include "DataFormats/FEDRawDataCollection.h"
+#include "DataFormats/FEDRawDataCollectionView.h"
+
+FEDRawDataCollectionView::Index FEDRawDataCollectionView::makeIndex(FEDRawDataCollection const &collection) {
+  Index index;
+  int first = FEDNumbering::lastFEDId() + 1;
+  int last = -1;
+  for (int fedId = 0; fedId <= FEDNumbering::lastFEDId(); ++fedId) {
+    if (collection.FEDData(fedId).size() > 0) {
+      first = std::min(first, fedId);
+      last = fedId;
+    }
+  }
+  if (last < first) {
+    return index;
+  }
+
+  index.firstFedId = first;
+  index.feds.reserve(last - first + 1);
+  for (int fedId = first; fedId <= last; ++fedId) {
+    FEDRawData const &rawData = collection.FEDData(fedId);
+    index.feds.emplace_back(rawData.data(), rawData.size());
+  }
+  return index;
+}
@@ -0,0 +1,52 @@
+#ifndef FEDRawData_FEDRawDataCollectionView_h
+#define FEDRawData_FEDRawDataCollectionView_h
+
+/** \class FEDRawDataCollectionView
+ *
+ *  Shared, immutable, read-only view of the raw data of all the FEDs
+ *  in an Event.
+ *
+ *  The FED buffers are not owned by the view: they live in memory
+ *  owned by the producer of the view (e.g. the edm::Source), and the
+ *  view only refers to them. Copying the view copies a shared_ptr to
+ *  the index of the FED buffers, so the same raw data can be put in
+ *  many events without duplicating it. The shared_ptr can also be
+ *  used to keep the underlying storage alive for as long as any view
+ *  refers to it.
+ */
+
+#include <memory>
+#include <vector>
+
+#include "DataFormats/FEDRawDataView.h"
+
+class FEDRawDataCollection;
+
+class FEDRawDataCollectionView {
+public:
+  /// Index of the FED buffers, dense in the FED id range [firstFedId, firstFedId + feds.size())
+  struct Index {
+    int firstFedId = 0;
+    std::vector<FEDRawDataView> feds;
+  };
+
+  FEDRawDataCollectionView() = default;
+  explicit FEDRawDataCollectionView(std::shared_ptr<Index const> index) : index_(std::move(index)) {}
+
+  /// Build the index of the non-empty FEDs in a collection.
+  /// The collection must outlive all the views using the index.
+  static Index makeIndex(FEDRawDataCollection const &collection);
+
+  /// retrieve data for fed @param fedid (empty if the FED is not present)
+  FEDRawDataView FEDData(int fedid) const {
+    if (not index_ or fedid < index_->firstFedId or fedid >= index_->firstFedId + int(index_->feds.size())) {
+      return FEDRawDataView();
+    }
+    return index_->feds[fedid - index_->firstFedId];
+  }
+
+private:
+  std::shared_ptr<Index const> index_;
+};
+
+#endif
@@ -0,0 +1,31 @@
+#ifndef FEDRawData_FEDRawDataView_h
+#define FEDRawData_FEDRawDataView_h
+
+/** \class FEDRawDataView
+ *
+ *  Read-only, non-owning view of the raw data of one FED.
+ *  The buffer is owned elsewhere (see FEDRawDataCollectionView), and
+ *  follows the same conventions as FEDRawData: its length is a
+ *  multiple of the S-Link64 word length (8 bytes), and it includes
+ *  the standard FED header and trailer.
+ */
+
+#include <cstddef>
+
+class FEDRawDataView {
+public:
+  FEDRawDataView() = default;
+  FEDRawDataView(const unsigned char *data, size_t size) : data_(data), size_(size) {}
+
+  /// Return a const pointer to the beginning of the data buffer
+  const unsigned char *data() const { return data_; }
+
+  /// Lenght of the data buffer in bytes
+  size_t size() const { return size_; }
+
+private:
+  const unsigned char *data_ = nullptr;
+  size_t size_ = 0;
+};
+
+#endif
@@ -0,0 +1,181 @@
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <stdexcept>
+#include <tuple>
+#include <utility>
+
+#include <time.h>
+
+#include "Framework/Event.h"
+#include "Framework/TimingService.h"
+
+namespace {
+  std::atomic<unsigned int> nextId = 0;
+
+  constexpr size_t kInitialBufferSize = 4096;
+
+  std::chrono::nanoseconds threadCpuTime() {
+    timespec t;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &t);
+    return std::chrono::seconds(t.tv_sec) + std::chrono::nanoseconds(t.tv_nsec);
+  }
+
+  // nearest rank, on sorted values
+  double percentile(std::vector<int64_t> const& values, double p) {
+    if (values.empty())
+      return 0.;
+    auto rank = static_cast<size_t>(std::ceil(p * values.size()));
+    return values[std::clamp<size_t>(rank, 1, values.size()) - 1];
+  }
+
+  double mean(std::vector<int64_t> const& values) {
+    if (values.empty())
+      return 0.;
+    double sum = 0.;
+    for (auto v : values)
+      sum += v;
+    return sum / values.size();
+  }
+
+  char const* phaseName(edm::TimingService::Phase phase) {
+    return phase == edm::TimingService::Phase::acquire ? "acquire" : "produce";
+  }
+}  // namespace
+
+namespace edm {
+  TimingService::TimingService(std::vector<std::string> moduleNames)
+      : moduleNames_(std::move(moduleNames)), id_(nextId++) {}
+
+  TimingService::~TimingService() = default;
+
+  TimingService::Start TimingService::start() { return Start{std::chrono::steady_clock::now(), threadCpuTime()}; }
+
+  void TimingService::stop(Start const& start, int module, Phase phase, Event const& event) {
+    auto cpu = threadCpuTime() - start.cpu;
+    auto wall = std::chrono::steady_clock::now() - start.wall;
+    threadBuffer().records.push_back(Record{event.eventID(),
+                                            static_cast<int16_t>(event.streamID()),
+                                            static_cast<int16_t>(module),
+                                            phase,
+                                            std::chrono::duration_cast<std::chrono::nanoseconds>(wall).count(),
+                                            cpu.count()});
+  }
+
+  TimingService::ThreadBuffer& TimingService::threadBuffer() {
+    // the buffer of the current thread for the last TimingService that used it
+    thread_local unsigned int owner = ~0u;
+    thread_local ThreadBuffer* buffer = nullptr;
+    if (owner != id_ or buffer == nullptr) {
+      std::lock_guard<std::mutex> guard(mutex_);
+      buffers_.push_back(std::make_unique<ThreadBuffer>());
+      buffer = buffers_.back().get();
+      buffer->records.reserve(kInitialBufferSize);
+      owner = id_;
+    }
+    return *buffer;
+  }
+
+  std::vector<TimingService::Record> TimingService::records() const {
+    std::vector<Record> all;
+    for (auto const& buffer : buffers_) {
+      all.insert(all.end(), buffer->records.begin(), buffer->records.end());
+    }
+    std::sort(all.begin(), all.end(), [](Record const& a, Record const& b) {
+      return std::tie(a.event, a.module, a.phase) < std::tie(b.event, b.module, b.phase);
+    });
+    return all;
+  }
+
+  void TimingService::printSummary(std::ostream& out) const {
+    auto all = records();
+
+    // times per event of each module and phase, and of all the modules together
+    std::map<std::pair<int, Phase>, std::pair<std::vector<int64_t>, std::vector<int64_t>>> modules;
+    std::map<int, std::pair<int64_t, int64_t>> events;
+    for (auto const& r : all) {
+      auto& m = modules[{r.module, r.phase}];
+      m.first.push_back(r.wall);
+      m.second.push_back(r.cpu);
+      auto& e = events[r.event];
+      e.first += r.wall;
+      e.second += r.cpu;
+    }
+    std::pair<std::vector<int64_t>, std::vector<int64_t>> total;
+    for (auto const& e : events) {
+      total.first.push_back(e.second.first);
+      total.second.push_back(e.second.second);
+    }
+
+    size_t nameWidth = 5;
+    for (auto const& name : moduleNames_) {
+      nameWidth = std::max(nameWidth, name.size());
+    }
+    auto printRow = [&](std::string const& name,
+                        char const* phase,
+                        std::pair<std::vector<int64_t>, std::vector<int64_t>>& times) {
+      std::sort(times.first.begin(), times.first.end());
+      std::sort(times.second.begin(), times.second.end());
+      out << std::left << std::setw(nameWidth + 2) << name << std::setw(9) << phase << std::right << std::setw(8)
+          << times.first.size();
+      for (auto const* values : {&times.first, &times.second}) {
+        out << std::fixed << std::setprecision(3) << std::setw(11) << mean(*values) / 1e6 << std::setw(11)
+            << percentile(*values, 0.50) / 1e6 << std::setw(11) << percentile(*values, 0.99) / 1e6;
+      }
+      out << '\n';
+    };
+
+    auto flags = out.flags();
+    auto precision = out.precision();
+    out << "Time per event of each module in ms, over " << events.size() << " events\n";
+    out << std::left << std::setw(nameWidth + 2) << "Module" << std::setw(9) << "Phase" << std::right << std::setw(8)
+        << "Events" << std::setw(11) << "Wall mean" << std::setw(11) << "Wall p50" << std::setw(11) << "Wall p99"
+        << std::setw(11) << "CPU mean" << std::setw(11) << "CPU p50" << std::setw(11) << "CPU p99" << '\n';
+    for (auto& m : modules) {
+      printRow(moduleNames_.at(m.first.first), phaseName(m.first.second), m.second);
+    }
+    printRow("Total", "", total);
+    out.flags(flags);
+    out.precision(precision);
+    out << std::flush;
+  }
+
+  void TimingService::write(std::filesystem::path const& path) const {
+    bool json;
+    if (path.extension() == ".json") {
+      json = true;
+    } else if (path.extension() == ".csv") {
+      json = false;
+    } else {
+      throw std::runtime_error("Unsupported format for the timing output " + path.string() +
+                               ", the extension must be .csv or .json");
+    }
+
+    std::ofstream out(path);
+    if (not out) {
+      throw std::runtime_error("Unable to open " + path.string());
+    }
+    out << std::fixed << std::setprecision(6);
+    auto all = records();
+    if (json) {
+      out << "[\n";
+      for (size_t i = 0; i < all.size(); ++i) {
+        auto const& r = all[i];
+        out << "  {\"event\": " << r.event << ", \"stream\": " << r.stream << ", \"module\": \""
+            << moduleNames_.at(r.module) << "\", \"phase\": \"" << phaseName(r.phase)
+            << "\", \"wall_ms\": " << r.wall / 1e6 << ", \"cpu_ms\": " << r.cpu / 1e6 << "}"
+            << (i + 1 < all.size() ? ",\n" : "\n");
+      }
+      out << "]\n";
+    } else {
+      out << "event,stream,module,phase,wall_ms,cpu_ms\n";
+      for (auto const& r : all) {
+        out << r.event << ',' << r.stream << ',' << moduleNames_.at(r.module) << ',' << phaseName(r.phase) << ','
+            << r.wall / 1e6 << ',' << r.cpu / 1e6 << '\n';
+      }
+    }
+  }
+}  // namespace edm
@@ -0,0 +1,78 @@
+#ifndef TimingService_h
+#define TimingService_h
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+namespace edm {
+  class Event;
+
+  // Measures the wall clock and CPU time spent by each module in each
+  // event, in its acquire() and produce() functions
+  //
+  // The measurements are appended to per-thread buffers, so that the
+  // only synchronization is the registration of the buffer of each
+  // thread the first time it records a measurement. The buffers are
+  // merged only at the end of the job, when no event is being processed.
+  class TimingService {
+  public:
+    enum class Phase : uint8_t { acquire, produce };
+
+    struct Start {
+      std::chrono::steady_clock::time_point wall;
+      std::chrono::nanoseconds cpu;
+    };
+
+    // names of the modules, in the order of their index
+    explicit TimingService(std::vector<std::string> moduleNames);
+    ~TimingService();
+
+    TimingService(TimingService const&) = delete;
+    TimingService& operator=(TimingService const&) = delete;
+
+    static Start start();
+
+    // thread safe
+    void stop(Start const& start, int module, Phase phase, Event const& event);
+
+    // not thread safe
+    // mean, median and 99th percentile of the time per event of each module
+    void printSummary(std::ostream& out) const;
+
+    // not thread safe
+    // all the measurements, in CSV or JSON depending on the extension of the file
+    void write(std::filesystem::path const& path) const;
+
+  private:
+    struct Record {
+      int32_t event;
+      int16_t stream;
+      int16_t module;
+      Phase phase;
+      int64_t wall;  // ns
+      int64_t cpu;   // ns
+    };
+
+    struct ThreadBuffer {
+      std::vector<Record> records;
+    };
+
+    ThreadBuffer& threadBuffer();
+    std::vector<Record> records() const;
+
+    std::vector<std::string> moduleNames_;
+    // identifies the thread-local buffers of this instance
+    unsigned int id_;
+
+    std::mutex mutex_;
+    std::vector<std::unique_ptr<ThreadBuffer>> buffers_;
+  };
+}  // namespace edm
+
+#endif
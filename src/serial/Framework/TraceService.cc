@@ -0,0 +1,118 @@
+#include <algorithm>
+#include <atomic>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <stdexcept>
+#include <utility>
+
+#include "Framework/TraceService.h"
+
+namespace {
+  std::atomic<unsigned int> nextId = 0;
+}  // namespace
+
+namespace edm {
+  TraceService::TraceService(std::vector<std::string> moduleNames, unsigned int bufferSize)
+      : moduleNames_(std::move(moduleNames)), bufferSize_(bufferSize), start_(Clock::now()), id_(nextId++) {
+    if (bufferSize_ == 0) {
+      throw std::runtime_error("The trace buffer size must be positive");
+    }
+  }
+
+  TraceService::~TraceService() = default;
+
+  void TraceService::record(
+      Kind kind, int module, int stream, int event, Clock::time_point begin, Clock::time_point end) {
+    auto& buffer = threadBuffer();
+    buffer.spans[buffer.next % bufferSize_] =
+        Span{std::chrono::duration_cast<std::chrono::nanoseconds>(begin - start_).count(),
+             std::chrono::duration_cast<std::chrono::nanoseconds>(end - start_).count(),
+             event,
+             static_cast<int16_t>(stream),
+             static_cast<int16_t>(module),
+             kind};
+    ++buffer.next;
+  }
+
+  TraceService::ThreadBuffer& TraceService::threadBuffer() {
+    // the buffer of the current thread for the last TraceService that used it
+    thread_local unsigned int owner = ~0u;
+    thread_local ThreadBuffer* buffer = nullptr;
+    if (owner != id_ or buffer == nullptr) {
+      std::lock_guard<std::mutex> guard(mutex_);
+      buffers_.push_back(std::make_unique<ThreadBuffer>(bufferSize_, buffers_.size()));
+      buffer = buffers_.back().get();
+      owner = id_;
+    }
+    return *buffer;
+  }
+
+  void TraceService::write(std::filesystem::path const& path) const {
+    std::ofstream out(path);
+    if (not out) {
+      throw std::runtime_error("Unable to open " + path.string());
+    }
+
+    out << std::fixed << std::setprecision(3);
+    out << "{\"displayTimeUnit\": \"ms\", \"traceEvents\": [\n";
+    out << "  {\"name\": \"process_name\", \"ph\": \"M\", \"pid\": 0, \"args\": {\"name\": \"serial\"}}";
+    uint64_t dropped = 0;
+    uint64_t prefetchId = 0;
+    for (auto const& buffer : buffers_) {
+      out << ",\n  {\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 0, \"tid\": " << buffer->thread
+          << ", \"args\": {\"name\": \"thread " << buffer->thread << "\"}}";
+
+      // oldest span first
+      uint64_t size = std::min<uint64_t>(buffer->next, bufferSize_);
+      dropped += buffer->next - size;
+      for (uint64_t i = buffer->next - size; i < buffer->next; ++i) {
+        auto const& span = buffer->spans[i % bufferSize_];
+        std::string name;
+        char const* category = "";
+        switch (span.kind) {
+          case Kind::source:
+            name = "Source";
+            category = "source";
+            break;
+          case Kind::prefetch:
+            name = moduleNames_.at(span.module);
+            category = "prefetch";
+            break;
+          case Kind::acquire:
+            name = moduleNames_.at(span.module);
+            category = "acquire";
+            break;
+          case Kind::produce:
+            name = moduleNames_.at(span.module);
+            category = "produce";
+            break;
+          case Kind::endEvent:
+            name = "end of event";
+            category = "event";
+            break;
+        }
+        out << ",\n  {\"name\": \"" << name << "\", \"cat\": \"" << category << "\", ";
+        if (span.kind == Kind::prefetch) {
+          // the waiting for the inputs does not run on a thread, and may overlap with other spans
+          out << "\"ph\": \"b\", \"id\": " << prefetchId << ", \"pid\": 0, \"tid\": " << buffer->thread
+              << ", \"ts\": " << span.begin / 1e3 << ", \"args\": {\"stream\": " << span.stream
+              << ", \"event\": " << span.event << "}},\n";
+          out << "  {\"name\": \"" << name << "\", \"cat\": \"" << category << "\", \"ph\": \"e\", \"id\": "
+              << prefetchId << ", \"pid\": 0, \"tid\": " << buffer->thread << ", \"ts\": " << span.end / 1e3 << "}";
+          ++prefetchId;
+        } else {
+          out << "\"ph\": \"X\", \"pid\": 0, \"tid\": " << buffer->thread << ", \"ts\": " << span.begin / 1e3
+              << ", \"dur\": " << (span.end - span.begin) / 1e3 << ", \"args\": {\"stream\": " << span.stream
+              << ", \"event\": " << span.event << "}}";
+        }
+      }
+    }
+    out << "\n]}\n";
+
+    if (dropped > 0) {
+      std::cout << "The trace buffers were full, the oldest " << dropped
+                << " spans are not written to " << path.string() << std::endl;
+    }
+  }
+}  // namespace edm
@@ -0,0 +1,81 @@
+#ifndef TraceService_h
+#define TraceService_h
+
+#include <chrono>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace edm {
+  // Records the timeline of the processing, to be inspected with
+  // chrome://tracing or https://ui.perfetto.dev
+  //
+  // Each thread writes the time spans it executes to its own ring
+  // buffer, allocated the first time the thread records a span. When a
+  // buffer is full the oldest spans are overwritten. The buffers are
+  // read only at the end of the job, when no event is being processed.
+  class TraceService {
+  public:
+    enum class Kind : uint8_t {
+      source,    // Source::produce()
+      prefetch,  // from the request of a module to run until its inputs are available
+      acquire,
+      produce,
+      endEvent  // end-of-event task of a stream
+    };
+
+    using Clock = std::chrono::steady_clock;
+
+    // names of the modules, in the order of their index
+    // bufferSize is the number of spans kept per thread
+    TraceService(std::vector<std::string> moduleNames, unsigned int bufferSize);
+    ~TraceService();
+
+    TraceService(TraceService const&) = delete;
+    TraceService& operator=(TraceService const&) = delete;
+
+    static Clock::time_point now() { return Clock::now(); }
+
+    // thread safe
+    // module is ignored for the source and endEvent kinds
+    void record(Kind kind, int module, int stream, int event, Clock::time_point begin, Clock::time_point end);
+
+    // not thread safe
+    // write the spans in the Chrome trace event format
+    void write(std::filesystem::path const& path) const;
+
+  private:
+    struct Span {
+      int64_t begin;  // ns since the construction of the service
+      int64_t end;
+      int32_t event;
+      int16_t stream;
+      int16_t module;
+      Kind kind;
+    };
+
+    struct ThreadBuffer {
+      explicit ThreadBuffer(unsigned int size, int thread) : spans(size), thread(thread) {}
+
+      std::vector<Span> spans;
+      uint64_t next = 0;  // total number of spans recorded
+      int thread;
+    };
+
+    ThreadBuffer& threadBuffer();
+
+    std::vector<std::string> moduleNames_;
+    unsigned int bufferSize_;
+    Clock::time_point start_;
+    // identifies the thread-local buffers of this instance
+    unsigned int id_;
+
+    std::mutex mutex_;
+    std::vector<std::unique_ptr<ThreadBuffer>> buffers_;
+  };
+}  // namespace edm
+
+#endif
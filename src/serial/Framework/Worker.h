@@ -5,13 +5,15 @@
 #include <vector>
 //#include <iostream>
 
+#include "Framework/Event.h"
+#include "Framework/TimingService.h"
+#include "Framework/TraceService.h"
 #include "Framework/WaitingTask.h"
 #include "Framework/WaitingTaskHolder.h"
 #include "Framework/WaitingTaskList.h"
 #include "Framework/WaitingTaskWithArenaHolder.h"
 
 namespace edm {
-  class Event;
   class EventSetup;
   class ProductRegistry;
 
@@ -22,6 +24,14 @@ namespace edm {
     // not thread safe
     void setItemsToGet(std::vector<Worker*> workers) { itemsToGet_ = std::move(workers); }
 
+    // not thread safe
+    // the services may be nullptr
+    void setServices(TimingService* timing, TraceService* tracer, int moduleIndex) {
+      timing_ = timing;
+      tracer_ = tracer;
+      moduleIndex_ = moduleIndex;
+    }
+
     // thread safe
     void prefetchAsync(Event& event, EventSetup const& eventSetup, WaitingTaskHolder iTask);
 
@@ -40,6 +50,29 @@ namespace edm {
   protected:
     virtual void doReset() = 0;
 
+    // call func(), measured by the enabled services
+    template <typename F>
+    void instrumented(TimingService::Phase phase, TraceService::Kind kind, Event const& event, F&& func) {
+      if (timing_ == nullptr and tracer_ == nullptr) {
+        func();
+        return;
+      }
+      auto timingStart = timing_ ? TimingService::start() : TimingService::Start{};
+      auto traceBegin = TraceService::now();
+      func();
+      if (tracer_) {
+        tracer_->record(kind, moduleIndex_, event.streamID(), event.eventID(), traceBegin, TraceService::now());
+      }
+      if (timing_) {
+        timing_->stop(timingStart, moduleIndex_, phase, event);
+      }
+    }
+
+    // nullptr if disabled
+    TimingService* timing_ = nullptr;
+    TraceService* tracer_ = nullptr;
+    int moduleIndex_ = 0;
+
   private:
     std::vector<Worker*> itemsToGet_;
     std::atomic<bool> prefetchRequested_ = false;
@@ -57,15 +90,26 @@ namespace edm {
       if (workStarted_.compare_exchange_strong(expected, true)) {
         //std::cout << "first doWorkAsync call" << std::endl;
 
+        auto prefetchBegin = tracer_ ? TraceService::now() : TraceService::Clock::time_point{};
         WaitingTask* moduleTask =
-            make_waiting_task([this, &event, &eventSetup](std::exception_ptr const* iPtr) mutable {
+            make_waiting_task([this, &event, &eventSetup, prefetchBegin](std::exception_ptr const* iPtr) mutable {
+              if (tracer_ and not producer_.hasAcquire()) {
+                tracer_->record(TraceService::Kind::prefetch,
+                                moduleIndex_,
+                                event.streamID(),
+                                event.eventID(),
+                                prefetchBegin,
+                                TraceService::now());
+              }
               if (iPtr) {
                 waitingTasksWork_.doneWaiting(*iPtr);
               } else {
                 std::exception_ptr exceptionPtr;
                 try {
                   //std::cout << "calling doProduce " << this << std::endl;
-                  producer_.doProduce(event, eventSetup);
+                  instrumented(TimingService::Phase::produce, TraceService::Kind::produce, event, [&]() {
+                    producer_.doProduce(event, eventSetup);
+                  });
                 } catch (...) {
                   exceptionPtr = std::current_exception();
                 }
@@ -76,20 +120,31 @@ namespace edm {
         auto* group = task.group();
         if (producer_.hasAcquire()) {
           WaitingTaskWithArenaHolder runProduceHolder{*group, moduleTask};
-          moduleTask = make_waiting_task([this, &event, &eventSetup, runProduceHolder = std::move(runProduceHolder)](
-                                             std::exception_ptr const* iPtr) mutable {
-            if (iPtr) {
-              runProduceHolder.doneWaiting(*iPtr);
-            } else {
-              std::exception_ptr exceptionPtr;
-              try {
-                producer_.doAcquire(event, eventSetup, runProduceHolder);
-              } catch (...) {
-                exceptionPtr = std::current_exception();
-              }
-              runProduceHolder.doneWaiting(exceptionPtr);
-            }
-          });
+          moduleTask = make_waiting_task(
+              [this, &event, &eventSetup, prefetchBegin, runProduceHolder = std::move(runProduceHolder)](
+                  std::exception_ptr const* iPtr) mutable {
+                if (tracer_) {
+                  tracer_->record(TraceService::Kind::prefetch,
+                                  moduleIndex_,
+                                  event.streamID(),
+                                  event.eventID(),
+                                  prefetchBegin,
+                                  TraceService::now());
+                }
+                if (iPtr) {
+                  runProduceHolder.doneWaiting(*iPtr);
+                } else {
+                  std::exception_ptr exceptionPtr;
+                  try {
+                    instrumented(TimingService::Phase::acquire, TraceService::Kind::acquire, event, [&]() {
+                      producer_.doAcquire(event, eventSetup, runProduceHolder);
+                    });
+                  } catch (...) {
+                    exceptionPtr = std::current_exception();
+                  }
+                  runProduceHolder.doneWaiting(exceptionPtr);
+                }
+              });
         }
         //std::cout << "calling prefetchAsync " << this << " with moduleTask " << moduleTask << std::endl;
         prefetchAsync(event, eventSetup, WaitingTaskHolder(*group, moduleTask));
@@ -1,3 +1,7 @@
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
 #include "Framework/ESPluginFactory.h"
 #include "Framework/WaitingTask.h"
 #include "Framework/WaitingTaskHolder.h"
@@ -11,17 +15,57 @@ namespace edm {
                                  std::vector<std::string> const& path,
                                  std::vector<std::string> const& esproducers,
                                  std::filesystem::path const& datadir,
-                                 bool validation)
-      : source_(maxEvents, runForMinutes, registry_, datadir, validation) {
+                                 bool validation,
+                                 Source::Mode sourceMode,
+                                 int prefetchEvents,
+                                 bool timing,
+                                 std::filesystem::path timingOutput,
+                                 std::filesystem::path traceOutput,
+                                 unsigned int traceBufferSize,
+                                 std::chrono::steady_clock::duration targetLatency,
+                                 std::filesystem::path output,
+                                 replay::Stage outputStage)
+      // in the streaming mode each concurrent event holds one buffer, on top of the ones being prefetched
+      : source_(maxEvents,
+                runForMinutes,
+                registry_,
+                datadir,
+                validation,
+                sourceMode,
+                numberOfStreams + std::max(prefetchEvents, 1)),
+        timingOutput_(std::move(timingOutput)),
+        traceOutput_(std::move(traceOutput)) {
     for (auto const& name : esproducers) {
       pluginManager_.load(name);
       auto esp = ESPluginFactory::create(name, datadir);
       esp->produce(eventSetup_);
     }
 
+    if (timing or not timingOutput_.empty()) {
+      timing_ = std::make_unique<TimingService>(path);
+    }
+    if (not traceOutput_.empty()) {
+      tracer_ = std::make_unique<TraceService>(path, traceBufferSize);
+    }
+    if (targetLatency > std::chrono::steady_clock::duration::zero()) {
+      controller_ = std::make_unique<LatencyController>(numberOfStreams, targetLatency);
+    }
+    if (not output.empty()) {
+      output_ = std::make_unique<ReplayWriter>(output, outputStage);
+    }
+
     //schedules_.reserve(numberOfStreams);
     for (int i = 0; i < numberOfStreams; ++i) {
-      schedules_.emplace_back(registry_, pluginManager_, &source_, &eventSetup_, i, path);
+      schedules_.emplace_back(registry_,
+                              pluginManager_,
+                              &source_,
+                              &eventSetup_,
+                              i,
+                              path,
+                              timing_.get(),
+                              tracer_.get(),
+                              controller_.get(),
+                              output_.get());
     }
   }
 
@@ -40,8 +84,66 @@ namespace edm {
     }
   }
 
+  std::chrono::steady_clock::duration EventProcessor::averageLatency() const {
+    size_t nEvents = 0;
+    std::chrono::steady_clock::duration total{};
+    for (auto const& s : schedules_) {
+      nEvents += s.latencies().size();
+      for (auto latency : s.latencies()) {
+        total += latency;
+      }
+    }
+    return nEvents > 0 ? total / static_cast<int64_t>(nEvents) : total;
+  }
+
+  std::chrono::steady_clock::duration EventProcessor::maxLatency() const {
+    std::chrono::steady_clock::duration latency{};
+    for (auto const& s : schedules_) {
+      for (auto l : s.latencies()) {
+        latency = std::max(latency, l);
+      }
+    }
+    return latency;
+  }
+
+  std::chrono::steady_clock::duration EventProcessor::latencyPercentile(double p) const {
+    std::vector<std::chrono::steady_clock::duration> all;
+    for (auto const& s : schedules_) {
+      all.insert(all.end(), s.latencies().begin(), s.latencies().end());
+    }
+    if (all.empty()) {
+      return {};
+    }
+    auto rank = std::clamp<size_t>(static_cast<size_t>(std::ceil(p * all.size())), 1, all.size()) - 1;
+    std::nth_element(all.begin(), all.begin() + rank, all.end());
+    return all[rank];
+  }
+
+  int EventProcessor::eventsAboveTargetLatency() const {
+    if (not controller_) {
+      return 0;
+    }
+    int n = 0;
+    for (auto const& s : schedules_) {
+      n += std::count_if(s.latencies().begin(), s.latencies().end(), [this](auto latency) {
+        return latency > controller_->target();
+      });
+    }
+    return n;
+  }
+
   void EventProcessor::endJob() {
     // Only on the first stream...
     schedules_[0].endJob();
+
+    if (timing_) {
+      timing_->printSummary(std::cout);
+      if (not timingOutput_.empty()) {
+        timing_->write(timingOutput_);
+      }
+    }
+    if (tracer_) {
+      tracer_->write(traceOutput_);
+    }
   }
 }  // namespace edm
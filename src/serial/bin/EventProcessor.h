@@ -1,13 +1,19 @@
 #ifndef EventProcessor_h
 #define EventProcessor_h
 
+#include <chrono>
 #include <filesystem>
+#include <memory>
 #include <string>
 #include <vector>
 
 #include "Framework/EventSetup.h"
+#include "Framework/TimingService.h"
+#include "Framework/TraceService.h"
 
+#include "LatencyController.h"
 #include "PluginManager.h"
+#include "ReplayFile.h"
 #include "StreamSchedule.h"
 #include "Source.h"
 
@@ -20,11 +26,33 @@ namespace edm {
                             std::vector<std::string> const& path,
                             std::vector<std::string> const& esproducers,
                             std::filesystem::path const& datadir,
-                            bool validation);
+                            bool validation,
+                            Source::Mode sourceMode = Source::Mode::preload,
+                            int prefetchEvents = 1,
+                            bool timing = false,
+                            std::filesystem::path timingOutput = {},
+                            std::filesystem::path traceOutput = {},
+                            unsigned int traceBufferSize = 0,
+                            std::chrono::steady_clock::duration targetLatency = {},
+                            std::filesystem::path output = {},
+                            replay::Stage outputStage = replay::Stage::tracks);
 
     int maxEvents() const { return source_.maxEvents(); }
     int processedEvents() const { return source_.processedEvents(); }
 
+    // time from the reading of each event to the end of its processing, over all streams
+    std::chrono::steady_clock::duration averageLatency() const;
+    std::chrono::steady_clock::duration maxLatency() const;
+    // p in [0, 1], nearest rank
+    std::chrono::steady_clock::duration latencyPercentile(double p) const;
+    int eventsAboveTargetLatency() const;
+
+    // nullptr unless a target latency is given
+    LatencyController const* latencyController() const { return controller_.get(); }
+
+    // nullptr unless an output file is given
+    ReplayWriter const* output() const { return output_.get(); }
+
     void runToCompletion();
 
     void endJob();
@@ -34,6 +62,12 @@ namespace edm {
     ProductRegistry registry_;
     Source source_;
     EventSetup eventSetup_;
+    std::unique_ptr<TimingService> timing_;
+    std::filesystem::path timingOutput_;
+    std::unique_ptr<TraceService> tracer_;
+    std::filesystem::path traceOutput_;
+    std::unique_ptr<LatencyController> controller_;
+    std::unique_ptr<ReplayWriter> output_;
     std::vector<StreamSchedule> schedules_;
   };
 }  // namespace edm
@@ -0,0 +1,106 @@
+#include <algorithm>
+#include <cassert>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "IndexedRawFile.h"
+
+namespace {
+  template <typename T>
+  T read(unsigned char const* ptr) {
+    T ret;
+    std::memcpy(&ret, ptr, sizeof(T));
+    return ret;
+  }
+
+  constexpr size_t kHeaderSize = 8 + 2 * sizeof(uint32_t);
+  constexpr size_t kBlockHeaderSize = 2 * sizeof(uint32_t);
+  constexpr size_t align8(size_t size) { return (size + 7) & ~size_t(7); }
+}  // namespace
+
+namespace edm {
+  IndexedRawFile::IndexedRawFile(std::filesystem::path const& path) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+      throw std::runtime_error("Unable to open " + path.string() + ": " + std::strerror(errno));
+    }
+    struct stat st;
+    if (::fstat(fd, &st) != 0) {
+      int err = errno;
+      ::close(fd);
+      throw std::runtime_error("Unable to stat " + path.string() + ": " + std::strerror(err));
+    }
+    size_ = st.st_size;
+    if (size_ < kHeaderSize) {
+      ::close(fd);
+      throw std::runtime_error(path.string() + " is too short to be an indexed raw data file");
+    }
+    void* addr = ::mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+    // the mapping stays valid after closing the file descriptor
+    ::close(fd);
+    if (addr == MAP_FAILED) {
+      throw std::runtime_error("Unable to mmap " + path.string() + ": " + std::strerror(errno));
+    }
+    base_ = static_cast<unsigned char const*>(addr);
+
+    try {
+      if (not std::equal(std::begin(kMagic), std::end(kMagic), base_)) {
+        throw std::runtime_error(path.string() + " is not an indexed raw data file");
+      }
+      auto version = read<uint32_t>(base_ + 8);
+      if (version != kVersion) {
+        throw std::runtime_error(path.string() + " has version " + std::to_string(version) + ", expected " +
+                                 std::to_string(kVersion));
+      }
+      nEvents_ = read<uint32_t>(base_ + 12);
+      if (kHeaderSize + (nEvents_ + 1) * sizeof(uint64_t) > size_) {
+        throw std::runtime_error(path.string() + " is truncated");
+      }
+      // the mapping is page aligned, so the offset table is naturally aligned
+      offsets_ = reinterpret_cast<uint64_t const*>(base_ + kHeaderSize);
+      if (offsets_[nEvents_] != size_) {
+        throw std::runtime_error(path.string() + " is truncated");
+      }
+    } catch (...) {
+      ::munmap(addr, size_);
+      throw;
+    }
+  }
+
+  IndexedRawFile::~IndexedRawFile() { ::munmap(const_cast<unsigned char*>(base_), size_); }
+
+  FEDRawDataCollectionView::Index IndexedRawFile::index(int event) const {
+    assert(event >= 0 and event < nEvents_);
+    unsigned char const* ptr = base_ + offsets_[event];
+    unsigned char const* end = base_ + offsets_[event + 1];
+    auto nFeds = read<uint32_t>(ptr);
+    ptr += kBlockHeaderSize;
+
+    FEDRawDataCollectionView::Index index;
+    for (uint32_t i = 0; i < nFeds; ++i) {
+      assert(ptr + kBlockHeaderSize <= end);
+      int fedId = read<uint32_t>(ptr);
+      auto fedSize = read<uint32_t>(ptr + sizeof(uint32_t));
+      ptr += kBlockHeaderSize;
+      assert(ptr + fedSize <= end);
+      if (fedSize > 0) {
+        if (index.feds.empty()) {
+          index.firstFedId = fedId;
+        }
+        // the FEDs are stored in increasing order of fedId
+        assert(fedId >= index.firstFedId + int(index.feds.size()));
+        index.feds.resize(fedId - index.firstFedId);
+        index.feds.emplace_back(ptr, fedSize);
+      }
+      ptr += align8(fedSize);
+    }
+    return index;
+  }
+}  // namespace edm
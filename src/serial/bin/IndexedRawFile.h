@@ -0,0 +1,56 @@
+#ifndef IndexedRawFile_h
+#define IndexedRawFile_h
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+
+#include "DataFormats/FEDRawDataCollectionView.h"
+
+namespace edm {
+  // Read-only, memory-mapped access to the indexed raw data format
+  // (see convert-raw-to-indexed.py at the top level for the converter
+  // from the raw.bin format)
+  //
+  // All integers are little endian, all offsets are in bytes from the
+  // beginning of the file
+  //
+  //   char     magic[8] = "PXRAWIDX"
+  //   uint32_t version  = 1
+  //   uint32_t nEvents
+  //   uint64_t eventOffset[nEvents + 1]   (the last one is the size of the file)
+  //   nEvents event blocks, each aligned to 8 bytes
+  //     uint32_t nFeds
+  //     uint32_t reserved
+  //     nFeds FED blocks, each aligned to 8 bytes
+  //       uint32_t fedId
+  //       uint32_t fedSize
+  //       unsigned char data[fedSize]  (padded to 8 bytes)
+  //
+  // Nothing is read at construction beyond the header: the pages of an
+  // event are touched only when the event is built
+  class IndexedRawFile {
+  public:
+    static constexpr char kMagic[8] = {'P', 'X', 'R', 'A', 'W', 'I', 'D', 'X'};
+    static constexpr uint32_t kVersion = 1;
+
+    explicit IndexedRawFile(std::filesystem::path const& path);
+    ~IndexedRawFile();
+
+    IndexedRawFile(IndexedRawFile const&) = delete;
+    IndexedRawFile& operator=(IndexedRawFile const&) = delete;
+
+    int size() const { return nEvents_; }
+
+    // thread safe
+    FEDRawDataCollectionView::Index index(int event) const;
+
+  private:
+    unsigned char const* base_ = nullptr;
+    size_t size_ = 0;
+    uint64_t const* offsets_ = nullptr;
+    int nEvents_ = 0;
+  };
+}  // namespace edm
+
+#endif
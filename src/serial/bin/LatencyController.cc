@@ -0,0 +1,80 @@
+#include <algorithm>
+#include <stdexcept>
+
+#include "LatencyController.h"
+
+namespace {
+  // minimum number of finished events between two changes of the limit
+  constexpr int kMinWindow = 4;
+}  // namespace
+
+namespace edm {
+  LatencyController::LatencyController(int maxInFlight, Clock::duration target)
+      : target_(target), maxInFlight_(maxInFlight) {
+    if (maxInFlight_ < 1) {
+      throw std::runtime_error("The maximum number of events in flight must be positive");
+    }
+    if (target_ <= Clock::duration::zero()) {
+      throw std::runtime_error("The target latency must be positive");
+    }
+  }
+
+  bool LatencyController::admit(std::function<void()> resume) {
+    std::lock_guard<std::mutex> guard(mutex_);
+    if (draining_ or active_ < limit_) {
+      ++active_;
+      return true;
+    }
+    parked_.push_back(std::move(resume));
+    return false;
+  }
+
+  void LatencyController::eventDone(Clock::duration latency) {
+    std::vector<std::function<void()>> resume;
+    {
+      std::lock_guard<std::mutex> guard(mutex_);
+      --active_;
+      ++windowEvents_;
+      windowMax_ = std::max(windowMax_, latency);
+      // let all the events admitted with the current limit contribute to the window
+      if (windowEvents_ >= std::max(kMinWindow, 2 * limit_)) {
+        if (windowMax_ > target_ and limit_ > 1) {
+          --limit_;
+        } else if (windowMax_ * (limit_ + 1) < target_ * limit_ and limit_ < maxInFlight_) {
+          // with the threads already busy, one more event makes each event slower by about (limit + 1) / limit
+          ++limit_;
+        }
+        minUsed_ = std::min(minUsed_, limit_);
+        maxUsed_ = std::max(maxUsed_, limit_);
+        windowEvents_ = 0;
+        windowMax_ = Clock::duration::zero();
+      }
+      resume = resumable();
+    }
+    for (auto& f : resume) {
+      f();
+    }
+  }
+
+  void LatencyController::drain() {
+    std::vector<std::function<void()>> resume;
+    {
+      std::lock_guard<std::mutex> guard(mutex_);
+      draining_ = true;
+      resume = resumable();
+    }
+    for (auto& f : resume) {
+      f();
+    }
+  }
+
+  std::vector<std::function<void()>> LatencyController::resumable() {
+    std::vector<std::function<void()>> resume;
+    while (not parked_.empty() and (draining_ or active_ < limit_)) {
+      ++active_;
+      resume.push_back(std::move(parked_.back()));
+      parked_.pop_back();
+    }
+    return resume;
+  }
+}  // namespace edm
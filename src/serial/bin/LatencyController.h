@@ -0,0 +1,69 @@
+#ifndef LatencyController_h
+#define LatencyController_h
+
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <vector>
+
+namespace edm {
+  // Adapts the number of events processed concurrently to keep the
+  // latency per event below a target
+  //
+  // Each StreamSchedule asks for a slot before reading an event, and
+  // gives it back at the end of the event. A stream that does not get
+  // a slot is parked, and resumed when the limit is raised or when the
+  // processing ends. The limit starts at one event, so that the spare
+  // threads are available to the parallel loops within the event, and
+  // is re-evaluated after each window of finished events: it is lowered
+  // if the largest latency in the window exceeds the target, and raised
+  // if that latency, scaled by the expected cost of one more concurrent
+  // event, still fits in the target.
+  class LatencyController {
+  public:
+    using Clock = std::chrono::steady_clock;
+
+    LatencyController(int maxInFlight, Clock::duration target);
+
+    LatencyController(LatencyController const&) = delete;
+    LatencyController& operator=(LatencyController const&) = delete;
+
+    // thread safe
+    // returns true if the stream can process one more event, otherwise
+    // keeps resume, that will be called once a slot is available
+    bool admit(std::function<void()> resume);
+
+    // thread safe
+    // gives back the slot of an event that has been processed
+    void eventDone(Clock::duration latency);
+
+    // thread safe
+    // no more events will be processed, admits all parked and future streams
+    void drain();
+
+    Clock::duration target() const { return target_; }
+    int maxInFlight() const { return maxInFlight_; }
+    // not thread safe
+    int inFlight() const { return limit_; }
+    int minUsed() const { return minUsed_; }
+    int maxUsed() const { return maxUsed_; }
+
+  private:
+    std::vector<std::function<void()>> resumable();
+
+    Clock::duration const target_;
+    int const maxInFlight_;
+
+    std::mutex mutex_;
+    int limit_ = 1;
+    int active_ = 0;
+    bool draining_ = false;
+    int minUsed_ = 1;
+    int maxUsed_ = 1;
+    int windowEvents_ = 0;
+    Clock::duration windowMax_{};
+    std::vector<std::function<void()>> parked_;
+  };
+}  // namespace edm
+
+#endif
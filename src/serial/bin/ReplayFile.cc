@@ -0,0 +1,318 @@
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+#include <stdexcept>
+
+#include "CondFormats/PixelCPEFast.h"
+
+#include "ReplayFile.h"
+
+namespace {
+  constexpr char kMagic[8] = {'S', 'E', 'R', 'I', 'A', 'L', 'R', 'P'};
+  constexpr uint32_t kVersion = 1;
+
+  // appends the bytes of the products of an event to the record
+  class RecordWriter {
+  public:
+    template <typename T>
+    void write(T const& value) {
+      write(&value, sizeof(T));
+    }
+
+    void write(void const* data, size_t size) {
+      auto const* bytes = static_cast<char const*>(data);
+      buffer_.insert(buffer_.end(), bytes, bytes + size);
+    }
+
+    // one column of n elements, read through the accessor f(i)
+    template <typename T, typename F>
+    void writeColumn(uint32_t n, F&& f) {
+      for (uint32_t i = 0; i < n; ++i) {
+        write<T>(f(i));
+      }
+    }
+
+    std::vector<char> const& buffer() const { return buffer_; }
+
+  private:
+    std::vector<char> buffer_;
+  };
+
+  class RecordReader {
+  public:
+    RecordReader(char const* data, size_t size) : data_(data), end_(data + size) {}
+
+    template <typename T>
+    T read() {
+      T value;
+      read(&value, sizeof(T));
+      return value;
+    }
+
+    void read(void* data, size_t size) {
+      if (size > size_t(end_ - data_)) {
+        throw std::runtime_error("Truncated record in the replay file");
+      }
+      std::memcpy(data, data_, size);
+      data_ += size;
+    }
+
+    template <typename T, typename F>
+    void readColumn(uint32_t n, F&& f) {
+      for (uint32_t i = 0; i < n; ++i) {
+        f(i) = read<T>();
+      }
+    }
+
+  private:
+    char const* data_;
+    char const* end_;
+  };
+
+  template <typename L>
+  void writeLayout(RecordWriter& record, L const& layout) {
+    record.write<uint32_t>(layout.size());
+    record.write(layout.data(), layout.dataSize());
+  }
+
+  // the layout must have been constructed for the number of entries that was written
+  template <typename L>
+  void readLayout(RecordReader& record, L& layout) {
+    record.read(layout.data(), layout.dataSize());
+  }
+
+  template <typename H>
+  void writeAssoc(RecordWriter& record, H const& assoc, uint32_t n) {
+    record.write(assoc.off, (n + 1) * sizeof(typename H::Counter));
+    record.write(assoc.bins, assoc.off[n] * sizeof(typename H::index_type));
+  }
+
+  template <typename H>
+  void readAssoc(RecordReader& record, H& assoc, uint32_t n) {
+    record.read(assoc.off, (n + 1) * sizeof(typename H::Counter));
+    if (assoc.off[n] > H::capacity()) {
+      throw std::runtime_error("Corrupted tracks in the replay file");
+    }
+    record.read(assoc.bins, assoc.off[n] * sizeof(typename H::index_type));
+    // the bins after the last track are empty
+    std::fill(assoc.off + n + 1, assoc.off + H::totbins(), assoc.off[n]);
+  }
+
+  void writeTracks(RecordWriter& record, pixelTrack::TrackSoA const& tracks) {
+    // only the tracks up to the last one with hits are written
+    uint32_t n = 0;
+    for (int32_t i = 0; i < tracks.stride(); ++i) {
+      if (tracks.hitIndices.size(i) > 0) {
+        n = i + 1;
+      }
+    }
+    record.write<uint32_t>(n);
+    record.write(tracks.m_quality.data(), n * sizeof(uint8_t));
+    record.write(tracks.chi2.data(), n * sizeof(float));
+    record.write(tracks.eta.data(), n * sizeof(float));
+    record.write(tracks.pt.data(), n * sizeof(float));
+    for (int j = 0; j < 5; ++j) {
+      record.writeColumn<float>(n, [&](int i) { return tracks.stateAtBS.state(i)(j); });
+    }
+    for (int j = 0; j < 15; ++j) {
+      record.writeColumn<float>(n, [&](int i) { return tracks.stateAtBS.covariance(i)(j); });
+    }
+    writeAssoc(record, tracks.hitIndices, n);
+    writeAssoc(record, tracks.detIndices, n);
+  }
+
+  void readTracks(RecordReader& record, pixelTrack::TrackSoA& tracks) {
+    auto n = record.read<uint32_t>();
+    if (n > uint32_t(tracks.stride())) {
+      throw std::runtime_error("Corrupted tracks in the replay file");
+    }
+    record.read(tracks.m_quality.data(), n * sizeof(uint8_t));
+    record.read(tracks.chi2.data(), n * sizeof(float));
+    record.read(tracks.eta.data(), n * sizeof(float));
+    record.read(tracks.pt.data(), n * sizeof(float));
+    for (int j = 0; j < 5; ++j) {
+      record.readColumn<float>(n, [&](int i) -> float& { return tracks.stateAtBS.state(i)(j); });
+    }
+    for (int j = 0; j < 15; ++j) {
+      record.readColumn<float>(n, [&](int i) -> float& { return tracks.stateAtBS.covariance(i)(j); });
+    }
+    readAssoc(record, tracks.hitIndices, n);
+    readAssoc(record, tracks.detIndices, n);
+  }
+
+  edm::replay::Stage readHeader(std::istream& in) {
+    char magic[sizeof(kMagic)];
+    uint32_t version;
+    uint32_t stage;
+    in.read(magic, sizeof(magic));
+    in.read(reinterpret_cast<char*>(&version), sizeof(uint32_t));
+    in.read(reinterpret_cast<char*>(&stage), sizeof(uint32_t));
+    if (not in or not std::equal(std::begin(magic), std::end(magic), std::begin(kMagic))) {
+      throw std::runtime_error("Not a replay file");
+    }
+    if (version != kVersion) {
+      throw std::runtime_error("Unsupported version " + std::to_string(version) + " of the replay file");
+    }
+    if (stage < uint32_t(edm::replay::Stage::clusters) or stage > uint32_t(edm::replay::Stage::tracks)) {
+      throw std::runtime_error("Invalid stage " + std::to_string(stage) + " in the replay file");
+    }
+    return edm::replay::Stage(stage);
+  }
+}  // namespace
+
+namespace edm {
+  namespace replay {
+    Stage stageFromName(std::string const& name) {
+      for (auto stage : {Stage::clusters, Stage::hits, Stage::tracks}) {
+        if (name == stageName(stage)) {
+          return stage;
+        }
+      }
+      throw std::runtime_error("Invalid stage " + name + ", it must be one of clusters, hits or tracks");
+    }
+
+    char const* stageName(Stage stage) {
+      switch (stage) {
+        case Stage::clusters:
+          return "clusters";
+        case Stage::hits:
+          return "hits";
+        case Stage::tracks:
+          return "tracks";
+      }
+      return "";
+    }
+
+    Stage readStage(std::filesystem::path const& path) {
+      std::ifstream in(path, std::ios::binary);
+      if (not in) {
+        throw std::runtime_error("Cannot open the replay file " + path.string());
+      }
+      return readHeader(in);
+    }
+  }  // namespace replay
+
+  ReplayWriter::ReplayWriter(std::filesystem::path const& path, replay::Stage stage)
+      : stage_(stage), out_(path, std::ios::binary) {
+    if (not out_) {
+      throw std::runtime_error("Cannot open the output file " + path.string());
+    }
+    out_.exceptions(std::ofstream::badbit | std::ofstream::failbit);
+    auto stageValue = static_cast<uint32_t>(stage_);
+    out_.write(kMagic, sizeof(kMagic));
+    out_.write(reinterpret_cast<char const*>(&kVersion), sizeof(uint32_t));
+    out_.write(reinterpret_cast<char const*>(&stageValue), sizeof(uint32_t));
+  }
+
+  void ReplayWriter::consumes(ProductRegistry& reg) {
+    digiToken_ = reg.consumes<SiPixelDigisSoA>();
+    clusterToken_ = reg.consumes<SiPixelClustersSoA>();
+    if (stage_ >= replay::Stage::hits) {
+      hitToken_ = reg.consumes<TrackingRecHit2DCPU>();
+    }
+    if (stage_ >= replay::Stage::tracks) {
+      trackToken_ = reg.consumes<PixelTrackHeterogeneous>();
+    }
+  }
+
+  void ReplayWriter::write(Event const& event) {
+    // the record is filled before taking the lock, only the writing to the file is serialised
+    RecordWriter record;
+    auto const& digis = event.get(digiToken_);
+    record.write<uint32_t>(digis.nModules());
+    record.write<uint32_t>(digis.nDigis());
+    writeLayout(record, digis.layout());
+    auto const& clusters = event.get(clusterToken_);
+    record.write<uint32_t>(clusters.nClusters());
+    writeLayout(record, clusters.layout());
+    if (stage_ >= replay::Stage::hits) {
+      writeLayout(record, event.get(hitToken_).layout());
+    }
+    if (stage_ >= replay::Stage::tracks) {
+      writeTracks(record, *event.get(trackToken_));
+    }
+
+    int32_t eventID = event.eventID();
+    uint64_t size = record.buffer().size();
+    std::scoped_lock lock(mutex_);
+    out_.write(reinterpret_cast<char const*>(&eventID), sizeof(int32_t));
+    out_.write(reinterpret_cast<char const*>(&size), sizeof(uint64_t));
+    out_.write(record.buffer().data(), size);
+    ++nEvents_;
+  }
+
+  ReplayReader::ReplayReader(std::filesystem::path const& path) {
+    std::ifstream in(path, std::ios::binary);
+    if (not in) {
+      throw std::runtime_error("Cannot open the replay file " + path.string());
+    }
+    stage_ = readHeader(in);
+    data_.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+
+    size_t offset = 0;
+    while (offset < data_.size()) {
+      int32_t eventID;
+      uint64_t size;
+      if (data_.size() - offset < sizeof(int32_t) + sizeof(uint64_t)) {
+        throw std::runtime_error("Truncated record in the replay file");
+      }
+      std::memcpy(&eventID, data_.data() + offset, sizeof(int32_t));
+      std::memcpy(&size, data_.data() + offset + sizeof(int32_t), sizeof(uint64_t));
+      offset += sizeof(int32_t) + sizeof(uint64_t);
+      if (size > data_.size() - offset) {
+        throw std::runtime_error("Truncated record in the replay file");
+      }
+      records_.push_back(Record{eventID, offset, size});
+      offset += size;
+    }
+    if (records_.empty()) {
+      throw std::runtime_error("No events in the replay file " + path.string());
+    }
+    // the records are written in the order in which the events end
+    std::sort(records_.begin(), records_.end(), [](Record const& a, Record const& b) { return a.eventID < b.eventID; });
+  }
+
+  void ReplayReader::produces(ProductRegistry& reg) {
+    digiToken_ = reg.produces<SiPixelDigisSoA>();
+    clusterToken_ = reg.produces<SiPixelClustersSoA>();
+    if (stage_ >= replay::Stage::hits) {
+      hitToken_ = reg.produces<TrackingRecHit2DCPU>();
+    }
+    if (stage_ >= replay::Stage::tracks) {
+      trackToken_ = reg.produces<PixelTrackHeterogeneous>();
+    }
+  }
+
+  void ReplayReader::fill(Event& event, EventSetup const& eventSetup, int index) {
+    auto const& r = records_[index];
+    RecordReader record(data_.data() + r.offset, r.size);
+
+    auto nModules = record.read<uint32_t>();
+    auto nDigis = record.read<uint32_t>();
+    SiPixelDigisSoA digis(record.read<uint32_t>(), bufferPool_);
+    readLayout(record, digis.layout());
+    digis.setNModulesDigis(nModules, nDigis);
+
+    auto nClusters = record.read<uint32_t>();
+    // the layout has one more entry than the number of clusters it is constructed for
+    SiPixelClustersSoA clusters(record.read<uint32_t>() - 1, bufferPool_);
+    readLayout(record, clusters.layout());
+    clusters.setNClusters(nClusters);
+
+    if (stage_ >= replay::Stage::hits) {
+      // the hits refer to the buffer of the clusters, that stays in place when they are moved to the event
+      auto const* cpeParams = &eventSetup.get<PixelCPEFast>().getCPUProduct();
+      TrackingRecHit2DCPU hits(record.read<uint32_t>(), cpeParams, clusters.clusModuleStart(), nullptr);
+      readLayout(record, hits.layout());
+      event.emplace(hitToken_, std::move(hits));
+    }
+    if (stage_ >= replay::Stage::tracks) {
+      PixelTrackHeterogeneous tracks(std::make_unique<pixelTrack::TrackSoA>());
+      readTracks(record, *tracks);
+      event.emplace(trackToken_, std::move(tracks));
+    }
+
+    event.emplace(digiToken_, std::move(digis));
+    event.emplace(clusterToken_, std::move(clusters));
+  }
+}  // namespace edm
@@ -0,0 +1,106 @@
+#ifndef ReplayFile_h
+#define ReplayFile_h
+
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "CUDACore/HostBufferPool.h"
+#include "CUDADataFormats/PixelTrackHeterogeneous.h"
+#include "CUDADataFormats/SiPixelClustersSoA.h"
+#include "CUDADataFormats/SiPixelDigisSoA.h"
+#include "CUDADataFormats/TrackingRecHit2DHeterogeneous.h"
+#include "Framework/Event.h"
+#include "Framework/EventSetup.h"
+
+namespace edm {
+  // Products of the first stages of the reconstruction, written at the end of each event with --output, and read
+  // back by the replay mode of the Source, so that the processing can start after these stages.
+  //
+  // The file starts with a header (magic, version, stage), followed by one record per event: the event number, the
+  // size of the record, and the products of all the stages up to the one of the file, in the order of the stages.
+  // The digis, the clusters and the hits are stored as the data of their cms::soa::Layout, the tracks as one column
+  // per field, for the tracks actually found.
+  namespace replay {
+    // the last stage of the reconstruction whose products are in the file
+    enum class Stage : uint32_t {
+      clusters = 1,  // SiPixelDigisSoA and SiPixelClustersSoA
+      hits = 2,      // and TrackingRecHit2DCPU
+      tracks = 3     // and PixelTrackHeterogeneous
+    };
+
+    // throws if the name is not one of "clusters", "hits" or "tracks"
+    Stage stageFromName(std::string const& name);
+    char const* stageName(Stage stage);
+
+    // reads only the header of the file
+    Stage readStage(std::filesystem::path const& path);
+  }  // namespace replay
+
+  // Writes the products of each event to the file, in the order in which the events end (thread safe)
+  class ReplayWriter {
+  public:
+    ReplayWriter(std::filesystem::path const& path, replay::Stage stage);
+
+    // to be called after the construction of the modules that produce the products
+    void consumes(ProductRegistry& reg);
+
+    void write(Event const& event);
+
+    int writtenEvents() const { return nEvents_; }
+
+  private:
+    replay::Stage const stage_;
+    EDGetTokenT<SiPixelDigisSoA> digiToken_;
+    EDGetTokenT<SiPixelClustersSoA> clusterToken_;
+    EDGetTokenT<TrackingRecHit2DCPU> hitToken_;
+    EDGetTokenT<PixelTrackHeterogeneous> trackToken_;
+
+    std::mutex mutex_;
+    std::ofstream out_;
+    int nEvents_ = 0;
+  };
+
+  // Reads all the records of the file in memory, and builds the products of each event from them on demand
+  class ReplayReader {
+  public:
+    explicit ReplayReader(std::filesystem::path const& path);
+
+    replay::Stage stage() const { return stage_; }
+
+    // number of events in the file
+    int size() const { return records_.size(); }
+
+    // event number of the index-th record, in the run that wrote the file; the records are sorted by event number
+    int eventID(int index) const { return records_[index].eventID; }
+
+    void produces(ProductRegistry& reg);
+
+    // thread safe
+    void fill(Event& event, EventSetup const& eventSetup, int index);
+
+  private:
+    struct Record {
+      int eventID;
+      size_t offset;
+      size_t size;
+    };
+
+    replay::Stage stage_;
+    std::vector<char> data_;
+    std::vector<Record> records_;
+
+    EDPutTokenT<SiPixelDigisSoA> digiToken_;
+    EDPutTokenT<SiPixelClustersSoA> clusterToken_;
+    EDPutTokenT<TrackingRecHit2DCPU> hitToken_;
+    EDPutTokenT<PixelTrackHeterogeneous> trackToken_;
+
+    // the digis and clusters of the events are allocated from it, so it must outlive the events
+    cms::cuda::HostBufferPool bufferPool_;
+  };
+}  // namespace edm
+
+#endif
@@ -23,13 +23,17 @@ namespace {
 }  // namespace
 
 namespace edm {
-  Source::Source(
-      int maxEvents, int runForMinutes, ProductRegistry &reg, std::filesystem::path const &datadir, bool validation)
+  Source::Source(int maxEvents,
+                 int runForMinutes,
+                 ProductRegistry &reg,
+                 std::filesystem::path const &datadir,
+                 bool validation,
+                 Mode mode,
+                 int numberOfBuffers)
       : maxEvents_(maxEvents),
         runForMinutes_(runForMinutes),
-        rawToken_(reg.produces<FEDRawDataCollection>()),
+        rawToken_(reg.produces<FEDRawDataCollectionView>()),
         validation_(validation) {
-    std::ifstream in_raw(datadir / "raw.bin", std::ios::binary);
     std::ifstream in_digiclusters;
     std::ifstream in_tracks;
     std::ifstream in_vertices;
@@ -47,39 +51,95 @@ namespace edm {
       in_vertices.exceptions(std::ifstream::badbit | std::ifstream::failbit | std::ifstream::eofbit);
     }
 
-    unsigned int nfeds;
-    in_raw.exceptions(std::ifstream::badbit);
-    in_raw.read(reinterpret_cast<char *>(&nfeds), sizeof(unsigned int));
-    while (not in_raw.eof()) {
-      in_raw.exceptions(std::ifstream::badbit | std::ifstream::failbit | std::ifstream::eofbit);
-
-      raw_.emplace_back(readRaw(in_raw, nfeds));
-
+    auto readCounts = [&]() {
+      unsigned int nm, nd, nc, nt, nv;
+      in_digiclusters.read(reinterpret_cast<char *>(&nm), sizeof(unsigned int));
+      in_digiclusters.read(reinterpret_cast<char *>(&nd), sizeof(unsigned int));
+      in_digiclusters.read(reinterpret_cast<char *>(&nc), sizeof(unsigned int));
+      in_tracks.read(reinterpret_cast<char *>(&nt), sizeof(unsigned int));
+      in_vertices.read(reinterpret_cast<char *>(&nv), sizeof(unsigned int));
+      digiclusters_.emplace_back(nm, nd, nc);
+      tracks_.emplace_back(nt);
+      vertices_.emplace_back(nv);
+    };
+
+    if (mode == Mode::mmap) {
+      // only the header and the offset table are read here, the events are built lazily in produce()
+      indexedRaw_ = std::make_unique<IndexedRawFile>(datadir / "raw_indexed.bin");
+      numInputEvents_ = indexedRaw_->size();
       if (validation_) {
-        unsigned int nm, nd, nc, nt, nv;
-        in_digiclusters.read(reinterpret_cast<char *>(&nm), sizeof(unsigned int));
-        in_digiclusters.read(reinterpret_cast<char *>(&nd), sizeof(unsigned int));
-        in_digiclusters.read(reinterpret_cast<char *>(&nc), sizeof(unsigned int));
-        in_tracks.read(reinterpret_cast<char *>(&nt), sizeof(unsigned int));
-        in_vertices.read(reinterpret_cast<char *>(&nv), sizeof(unsigned int));
-        digiclusters_.emplace_back(nm, nd, nc);
-        tracks_.emplace_back(nt);
-        vertices_.emplace_back(nv);
+        for (int i = 0; i < numInputEvents_; ++i) {
+          readCounts();
+        }
       }
-
-      // next event
+    } else if (mode == Mode::stream) {
+      // only the event boundaries are read here, the events are read by the I/O thread once the processing starts
+      streamingRaw_ = std::make_unique<StreamingRawFile>(datadir / "raw.bin", numberOfBuffers);
+      numInputEvents_ = streamingRaw_->size();
+      if (validation_) {
+        for (int i = 0; i < numInputEvents_; ++i) {
+          readCounts();
+        }
+      }
+    } else if (mode == Mode::replay) {
+      replay_ = std::make_unique<ReplayReader>(datadir / "replay.bin");
+      replay_->produces(reg);
+      numInputEvents_ = replay_->size();
+      if (validation_) {
+        // the records refer to the input events by their number in the run that wrote them
+        int lastEvent = replay_->eventID(numInputEvents_ - 1);
+        for (int i = 0; i < lastEvent; ++i) {
+          readCounts();
+        }
+        std::vector<DigiClusterCount> digiclusters;
+        std::vector<TrackCount> tracks;
+        std::vector<VertexCount> vertices;
+        for (int i = 0; i < numInputEvents_; ++i) {
+          auto index = replay_->eventID(i) - 1;
+          digiclusters.push_back(digiclusters_[index]);
+          tracks.push_back(tracks_[index]);
+          vertices.push_back(vertices_[index]);
+        }
+        digiclusters_ = std::move(digiclusters);
+        tracks_ = std::move(tracks);
+        vertices_ = std::move(vertices);
+      }
+    } else {
+      std::ifstream in_raw(datadir / "raw.bin", std::ios::binary);
+      unsigned int nfeds;
       in_raw.exceptions(std::ifstream::badbit);
       in_raw.read(reinterpret_cast<char *>(&nfeds), sizeof(unsigned int));
+      while (not in_raw.eof()) {
+        in_raw.exceptions(std::ifstream::badbit | std::ifstream::failbit | std::ifstream::eofbit);
+
+        raw_.emplace_back(readRaw(in_raw, nfeds));
+
+        if (validation_) {
+          readCounts();
+        }
+
+        // next event
+        in_raw.exceptions(std::ifstream::badbit);
+        in_raw.read(reinterpret_cast<char *>(&nfeds), sizeof(unsigned int));
+      }
+      numInputEvents_ = raw_.size();
+
+      // the events refer to the raw data owned by the Source instead of copying them
+      rawIndex_.reserve(raw_.size());
+      for (auto const &raw : raw_) {
+        rawIndex_.emplace_back(
+            std::make_shared<FEDRawDataCollectionView::Index const>(FEDRawDataCollectionView::makeIndex(raw)));
+      }
     }
 
     if (validation_) {
-      assert(raw_.size() == digiclusters_.size());
-      assert(raw_.size() == tracks_.size());
-      assert(raw_.size() == vertices_.size());
+      assert(numInputEvents_ == static_cast<int>(digiclusters_.size()));
+      assert(numInputEvents_ == static_cast<int>(tracks_.size()));
+      assert(numInputEvents_ == static_cast<int>(vertices_.size()));
     }
 
     if (runForMinutes_ < 0 and maxEvents_ < 0) {
-      maxEvents_ = raw_.size();
+      maxEvents_ = numInputEvents_;
     }
   }
 
@@ -87,9 +147,12 @@ namespace edm {
     if (runForMinutes_ >= 0) {
       startTime_ = std::chrono::steady_clock::now();
     }
+    if (streamingRaw_) {
+      streamingRaw_->start(runForMinutes_ < 0 ? maxEvents_ : -1);
+    }
   }
 
-  std::unique_ptr<Event> Source::produce(int streamId, ProductRegistry const &reg) {
+  std::unique_ptr<Event> Source::produce(int streamId, ProductRegistry const &reg, EventSetup const &eventSetup) {
     if (shouldStop_) {
       return nullptr;
     }
@@ -103,15 +166,15 @@ namespace edm {
         return nullptr;
       }
     } else {
-      if (numEvents_ - numEventsTimeLastCheck_ > static_cast<int>(raw_.size())) {
+      if (numEvents_ - numEventsTimeLastCheck_ > numInputEvents_) {
         std::scoped_lock lock(timeMutex_);
         // if some other thread beat us, no need to do anything
-        if (numEvents_ - numEventsTimeLastCheck_ > static_cast<int>(raw_.size())) {
+        if (numEvents_ - numEventsTimeLastCheck_ > numInputEvents_) {
           auto processingTime = std::chrono::steady_clock::now() - startTime_;
           if (std::chrono::duration_cast<std::chrono::minutes>(processingTime).count() >= runForMinutes_) {
             shouldStop_ = true;
           }
-          numEventsTimeLastCheck_ = (numEvents_ / raw_.size()) * raw_.size();
+          numEventsTimeLastCheck_ = (numEvents_ / numInputEvents_) * numInputEvents_;
         }
         if (shouldStop_) {
           --numEvents_;
@@ -120,9 +183,19 @@ namespace edm {
       }
     }
     auto ev = std::make_unique<Event>(streamId, iev, reg);
-    const int index = old % raw_.size();
-
-    ev->emplace(rawToken_, raw_[index]);
+    int index = old % numInputEvents_;
+
+    if (replay_) {
+      replay_->fill(*ev, eventSetup, index);
+    } else if (streamingRaw_) {
+      auto [event, raw] = streamingRaw_->next();
+      index = event;
+      ev->emplace(rawToken_, std::move(raw));
+    } else if (indexedRaw_) {
+      ev->emplace(rawToken_, std::make_shared<FEDRawDataCollectionView::Index const>(indexedRaw_->index(index)));
+    } else {
+      ev->emplace(rawToken_, rawIndex_[index]);
+    }
     if (validation_) {
       ev->emplace(digiClusterToken_, digiclusters_[index]);
       ev->emplace(trackToken_, tracks_[index]);
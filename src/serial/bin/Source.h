@@ -9,24 +9,45 @@
 #include <string>
 
 #include "Framework/Event.h"
+#include "Framework/EventSetup.h"
 #include "DataFormats/FEDRawDataCollection.h"
+#include "DataFormats/FEDRawDataCollectionView.h"
 #include "DataFormats/DigiClusterCount.h"
 #include "DataFormats/TrackCount.h"
 #include "DataFormats/VertexCount.h"
 
+#include "IndexedRawFile.h"
+#include "ReplayFile.h"
+#include "StreamingRawFile.h"
+
 namespace edm {
   class Source {
   public:
-    explicit Source(
-        int maxEvents, int runForMinutes, ProductRegistry& reg, std::filesystem::path const& datadir, bool validation);
+    enum class Mode {
+      preload,  // read all of raw.bin in memory at construction
+      mmap,     // memory-map raw_indexed.bin, and build each event lazily
+      stream,   // read raw.bin sequentially on an I/O thread, in a bounded ring of buffers
+      replay    // read replay.bin in memory at construction, and produce the products it contains instead of the raw data
+    };
+
+    explicit Source(int maxEvents,
+                    int runForMinutes,
+                    ProductRegistry& reg,
+                    std::filesystem::path const& datadir,
+                    bool validation,
+                    Mode mode = Mode::preload,
+                    int numberOfBuffers = 0);
 
     void startProcessing();
 
     int maxEvents() const { return maxEvents_; }
     int processedEvents() const { return numEvents_; }
 
+    // the last stage whose products are given by the Source in the replay mode
+    replay::Stage replayStage() const { return replay_->stage(); }
+
     // thread safe
-    std::unique_ptr<Event> produce(int streamId, ProductRegistry const& reg);
+    std::unique_ptr<Event> produce(int streamId, ProductRegistry const& reg, EventSetup const& eventSetup);
 
   private:
     int maxEvents_;
@@ -39,11 +60,17 @@ namespace edm {
     std::atomic<bool> shouldStop_ = false;
 
     std::atomic<int> numEvents_ = 0;
-    EDPutTokenT<FEDRawDataCollection> const rawToken_;
+    EDPutTokenT<FEDRawDataCollectionView> const rawToken_;
     EDPutTokenT<DigiClusterCount> digiClusterToken_;
     EDPutTokenT<TrackCount> trackToken_;
     EDPutTokenT<VertexCount> vertexToken_;
+    int numInputEvents_ = 0;
+    std::unique_ptr<IndexedRawFile> indexedRaw_;
+    std::unique_ptr<StreamingRawFile> streamingRaw_;
+    std::unique_ptr<ReplayReader> replay_;
     std::vector<FEDRawDataCollection> raw_;
+    // read-only views of raw_, shared by all the events that replay the same input event
+    std::vector<std::shared_ptr<FEDRawDataCollectionView::Index const>> rawIndex_;
     std::vector<DigiClusterCount> digiclusters_;
     std::vector<TrackCount> tracks_;
     std::vector<VertexCount> vertices_;
@@ -1,13 +1,18 @@
 //#include <iostream>
+#include <algorithm>
+#include <chrono>
 
 #include <tbb/task.h>
 
 #include "Framework/FunctorTask.h"
 #include "Framework/PluginFactory.h"
+#include "Framework/TraceService.h"
 #include "Framework/WaitingTask.h"
 #include "Framework/Worker.h"
 
+#include "LatencyController.h"
 #include "PluginManager.h"
+#include "ReplayFile.h"
 #include "Source.h"
 #include "StreamSchedule.h"
 
@@ -17,8 +22,18 @@ namespace edm {
                                  Source* source,
                                  EventSetup const* eventSetup,
                                  int streamId,
-                                 std::vector<std::string> const& path)
-      : registry_(std::move(reg)), source_(source), eventSetup_(eventSetup), streamId_(streamId) {
+                                 std::vector<std::string> const& path,
+                                 TimingService* timing,
+                                 TraceService* tracer,
+                                 LatencyController* controller,
+                                 ReplayWriter* output)
+      : registry_(std::move(reg)),
+        source_(source),
+        eventSetup_(eventSetup),
+        tracer_(tracer),
+        controller_(controller),
+        output_(output),
+        streamId_(streamId) {
     path_.reserve(path.size());
     int modInd = 1;
     for (auto const& name : path) {
@@ -34,8 +49,13 @@ namespace edm {
         }
       }
       path_.back()->setItemsToGet(std::move(consumes));
+      path_.back()->setServices(timing, tracer, modInd - 1);
       ++modInd;
     }
+    if (output_) {
+      // the same tokens in all the streams
+      output_->consumes(registry_);
+    }
   }
 
   StreamSchedule::~StreamSchedule() = default;
@@ -43,6 +63,9 @@ namespace edm {
   StreamSchedule& StreamSchedule::operator=(StreamSchedule&&) = default;
 
   void StreamSchedule::runToCompletionAsync(WaitingTaskHolder h) {
+    if (controller_ and not controller_->admit([this, h]() { resumeAsync(h); })) {
+      return;
+    }
     auto task = make_functor_task([this, h]() mutable { processOneEventAsync(std::move(h)); });
     if (streamId_ == 0) {
       h.group()->run([task]() {
@@ -58,24 +81,56 @@ namespace edm {
     }
   }
 
+  void StreamSchedule::resumeAsync(WaitingTaskHolder h) {
+    // called from a task of another stream, spawn in the task group so
+    // that the waiting for the group does not end in the meantime
+    auto task = make_functor_task([this, h]() mutable { processOneEventAsync(std::move(h)); });
+    h.group()->run([task]() {
+      TaskSentry s{task};
+      task->execute();
+    });
+  }
+
   void StreamSchedule::processOneEventAsync(WaitingTaskHolder h) {
-    auto event = source_->produce(streamId_, registry_);
+    auto sourceBegin = tracer_ ? TraceService::now() : TraceService::Clock::time_point{};
+    auto event = source_->produce(streamId_, registry_, *eventSetup_);
     if (event) {
+      auto start = std::chrono::steady_clock::now();
+      if (tracer_) {
+        tracer_->record(TraceService::Kind::source, -1, streamId_, event->eventID(), sourceBegin, TraceService::now());
+      }
       // Pass the event object ownership to the "end-of-event" task
       // Pass a non-owning pointer to the event to preceding tasks
       //std::cout << "Begin processing event " << event->eventID() << std::endl;
       auto eventPtr = event.get();
       auto* group = h.group();
-      auto nextEventTask =
-          make_waiting_task([this, h = std::move(h), ev = std::move(event)](std::exception_ptr const* iPtr) mutable {
+      auto nextEventTask = make_waiting_task(
+          [this, h = std::move(h), ev = std::move(event), start](std::exception_ptr const* iPtr) mutable {
+            auto end = std::chrono::steady_clock::now();
+            auto latency = end - start;
+            latencies_.push_back(latency);
+            auto eventId = ev->eventID();
+            if (output_ and not iPtr) {
+              output_->write(*ev);
+            }
             ev.reset();
+            if (controller_) {
+              controller_->eventDone(latency);
+            }
             if (iPtr) {
+              // do not leave the parked streams waiting for this one
+              if (controller_) {
+                controller_->drain();
+              }
               h.doneWaiting(*iPtr);
             } else {
               for (auto const& worker : path_) {
                 worker->reset();
               }
-              processOneEventAsync(std::move(h));
+              if (tracer_) {
+                tracer_->record(TraceService::Kind::endEvent, -1, streamId_, eventId, end, TraceService::now());
+              }
+              processNextEventAsync(std::move(h));
             }
           });
       // To guarantee that the nextEventTask is spawned also in
@@ -88,10 +143,20 @@ namespace edm {
         (*iWorker)->doWorkAsync(*eventPtr, *eventSetup_, nextEventTaskHolder);
       }
     } else {
+      if (controller_) {
+        controller_->drain();
+      }
       h.doneWaiting(std::exception_ptr{});
     }
   }
 
+  void StreamSchedule::processNextEventAsync(WaitingTaskHolder h) {
+    if (controller_ and not controller_->admit([this, h]() { resumeAsync(h); })) {
+      return;
+    }
+    processOneEventAsync(std::move(h));
+  }
+
   void StreamSchedule::endJob() {
     for (auto& w : path_) {
       w->doEndJob();
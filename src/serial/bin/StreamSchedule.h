@@ -1,6 +1,7 @@
 #ifndef StreamSchedule_h
 #define StreamSchedule_h
 
+#include <chrono>
 #include <memory>
 #include <string>
 #include <vector>
@@ -14,7 +15,11 @@ namespace edmplugin {
 
 namespace edm {
   class EventSetup;
+  class LatencyController;
+  class ReplayWriter;
   class Source;
+  class TimingService;
+  class TraceService;
   class Worker;
 
   // Schedule of modules per stream (concurrent event)
@@ -26,7 +31,11 @@ namespace edm {
                             Source* source,
                             EventSetup const* eventSetup,
                             int streamId,
-                            std::vector<std::string> const& path);
+                            std::vector<std::string> const& path,
+                            TimingService* timing = nullptr,
+                            TraceService* tracer = nullptr,
+                            LatencyController* controller = nullptr,
+                            ReplayWriter* output = nullptr);
     ~StreamSchedule();
     StreamSchedule(StreamSchedule const&) = delete;
     StreamSchedule& operator=(StreamSchedule const&) = delete;
@@ -37,14 +46,23 @@ namespace edm {
 
     void endJob();
 
+    // time from the reading of each event to the end of its processing, in the order of processing
+    std::vector<std::chrono::steady_clock::duration> const& latencies() const { return latencies_; }
+
   private:
+    void resumeAsync(WaitingTaskHolder h);
+    void processNextEventAsync(WaitingTaskHolder h);
     void processOneEventAsync(WaitingTaskHolder h);
 
     ProductRegistry registry_;
     Source* source_;
     EventSetup const* eventSetup_;
+    TraceService* tracer_;
+    LatencyController* controller_;
+    ReplayWriter* output_;
     std::vector<std::unique_ptr<Worker>> path_;
     int streamId_;
+    std::vector<std::chrono::steady_clock::duration> latencies_;
   };
 }  // namespace edm
 
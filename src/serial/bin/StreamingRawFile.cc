@@ -0,0 +1,126 @@
+#include <stdexcept>
+
+#include "StreamingRawFile.h"
+
+namespace {
+  // count the events without reading the FED payloads
+  int countEvents(std::ifstream& is) {
+    int nEvents = 0;
+    unsigned int nfeds;
+    is.exceptions(std::ifstream::badbit);
+    is.read(reinterpret_cast<char*>(&nfeds), sizeof(unsigned int));
+    while (not is.eof()) {
+      is.exceptions(std::ifstream::badbit | std::ifstream::failbit | std::ifstream::eofbit);
+      for (unsigned int ifed = 0; ifed < nfeds; ++ifed) {
+        unsigned int fedId;
+        is.read(reinterpret_cast<char*>(&fedId), sizeof(unsigned int));
+        unsigned int fedSize;
+        is.read(reinterpret_cast<char*>(&fedSize), sizeof(unsigned int));
+        is.seekg(fedSize, std::ios::cur);
+      }
+      ++nEvents;
+
+      // next event
+      is.exceptions(std::ifstream::badbit);
+      is.read(reinterpret_cast<char*>(&nfeds), sizeof(unsigned int));
+    }
+    return nEvents;
+  }
+}  // namespace
+
+namespace edm {
+  StreamingRawFile::StreamingRawFile(std::filesystem::path const& path, int numberOfBuffers)
+      : in_(path, std::ios::binary), buffers_(numberOfBuffers) {
+    if (not in_) {
+      throw std::runtime_error("Unable to open " + path.string());
+    }
+    nEvents_ = countEvents(in_);
+    if (nEvents_ == 0) {
+      throw std::runtime_error(path.string() + " does not contain any event");
+    }
+    in_.clear();
+    in_.seekg(0);
+
+    free_.set_capacity(numberOfBuffers);
+    filled_.set_capacity(numberOfBuffers + 1);
+    for (auto& buffer : buffers_) {
+      free_.push(&buffer);
+    }
+  }
+
+  StreamingRawFile::~StreamingRawFile() {
+    if (thread_.joinable()) {
+      stop_ = true;
+      // wake up the I/O thread if it is waiting for a free buffer
+      free_.abort();
+      thread_.join();
+    }
+  }
+
+  void StreamingRawFile::start(int maxEvents) {
+    maxEvents_ = maxEvents;
+    thread_ = std::thread([this]() { read(); });
+  }
+
+  std::pair<int, std::shared_ptr<FEDRawDataCollectionView::Index const>> StreamingRawFile::next() {
+    Buffer* buffer;
+    filled_.pop(buffer);
+    if (buffer == nullptr) {
+      // let the other callers see the error as well
+      filled_.push(nullptr);
+      std::rethrow_exception(exception_);
+    }
+    // the buffer is recycled when the last event referring to it is destroyed
+    return {buffer->event,
+            std::shared_ptr<FEDRawDataCollectionView::Index const>(
+                &buffer->index, [this, buffer](FEDRawDataCollectionView::Index const*) { free_.push(buffer); })};
+  }
+
+  void StreamingRawFile::read() {
+    try {
+      int event = 0;
+      for (int ievent = 0; maxEvents_ < 0 or ievent < maxEvents_; ++ievent) {
+        Buffer* buffer;
+        try {
+          free_.pop(buffer);
+        } catch (tbb::user_abort const&) {
+          return;
+        }
+        if (stop_) {
+          return;
+        }
+
+        if (event == nEvents_) {
+          in_.seekg(0);
+          event = 0;
+        }
+
+        // clear the FEDs of the previous event, keeping their capacity
+        for (unsigned int i = 0; i < buffer->index.feds.size(); ++i) {
+          buffer->raw.FEDData(buffer->index.firstFedId + i).resize(0);
+        }
+
+        in_.exceptions(std::ifstream::badbit | std::ifstream::failbit | std::ifstream::eofbit);
+        unsigned int nfeds;
+        in_.read(reinterpret_cast<char*>(&nfeds), sizeof(unsigned int));
+        for (unsigned int ifed = 0; ifed < nfeds; ++ifed) {
+          unsigned int fedId;
+          in_.read(reinterpret_cast<char*>(&fedId), sizeof(unsigned int));
+          unsigned int fedSize;
+          in_.read(reinterpret_cast<char*>(&fedSize), sizeof(unsigned int));
+          FEDRawData& rawData = buffer->raw.FEDData(fedId);
+          rawData.resize(fedSize);
+          in_.read(reinterpret_cast<char*>(rawData.data()), fedSize);
+        }
+        buffer->index = FEDRawDataCollectionView::makeIndex(buffer->raw);
+        buffer->event = event;
+        ++event;
+
+        filled_.push(buffer);
+      }
+    } catch (...) {
+      exception_ = std::current_exception();
+      filled_.push(nullptr);
+    }
+  }
+}  // namespace edm
@@ -0,0 +1,74 @@
+#ifndef StreamingRawFile_h
+#define StreamingRawFile_h
+
+#include <atomic>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <tbb/concurrent_queue.h>
+
+#include "DataFormats/FEDRawDataCollection.h"
+#include "DataFormats/FEDRawDataCollectionView.h"
+
+namespace edm {
+  // Sequential reader of the raw.bin format
+  //
+  // A dedicated I/O thread decodes the events in a bounded ring of
+  // FEDRawDataCollection buffers, ahead of their processing. Each
+  // buffer is given to an event through the shared_ptr of its
+  // FEDRawDataCollectionView::Index, and goes back to the I/O thread
+  // when the event is destroyed at the end of its processing. The
+  // memory used is thus bounded by the number of buffers times the
+  // event size, independently of the size of the file.
+  //
+  // When more events are requested than the file contains, the reading
+  // starts again from the beginning of the file.
+  class StreamingRawFile {
+  public:
+    // numberOfBuffers must be larger than the number of events being
+    // processed concurrently, otherwise the processing can deadlock
+    StreamingRawFile(std::filesystem::path const& path, int numberOfBuffers);
+    ~StreamingRawFile();
+
+    StreamingRawFile(StreamingRawFile const&) = delete;
+    StreamingRawFile& operator=(StreamingRawFile const&) = delete;
+
+    // number of events in the file
+    int size() const { return nEvents_; }
+
+    // start the I/O thread, reading maxEvents events (maxEvents < 0 means no limit)
+    void start(int maxEvents);
+
+    // thread safe, blocks until the next event has been read
+    // returns the index of the event in the file and its raw data
+    std::pair<int, std::shared_ptr<FEDRawDataCollectionView::Index const>> next();
+
+  private:
+    struct Buffer {
+      int event = -1;
+      FEDRawDataCollection raw;
+      FEDRawDataCollectionView::Index index;
+    };
+
+    void read();
+
+    std::ifstream in_;
+    int nEvents_ = 0;
+    int maxEvents_ = -1;
+    std::vector<Buffer> buffers_;
+    // empty buffers, to be filled by the I/O thread
+    tbb::concurrent_bounded_queue<Buffer*> free_;
+    // filled buffers, in the order of the file; nullptr signals an error in the I/O thread
+    tbb::concurrent_bounded_queue<Buffer*> filled_;
+    std::exception_ptr exception_;
+    std::atomic<bool> stop_ = false;
+    std::thread thread_;
+  };
+}  // namespace edm
+
+#endif
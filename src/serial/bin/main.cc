@@ -19,7 +19,8 @@ namespace {
     std::cout
         << name
         << ": [--numberOfThreads NT] [--numberOfStreams NS] [--maxEvents ME] [--data PATH] [--validation] "
-           "[--histogram] [--empty]\n\n"
+           "[--histogram] [--empty] [--sourceMode MODE] [--prefetchEvents N] [--timing] [--timingOutput FILE] "
+           "[--trace FILE] [--traceBufferSize N] [--targetLatencyMs T] [--output FILE] [--outputStage STAGE]\n\n"
         << "Options\n"
         << " --numberOfThreads   Number of threads to use (default 1, use 0 to use all CPU cores)\n"
         << " --numberOfStreams   Number of concurrent events (default 0 = numberOfThreads)\n"
@@ -30,6 +31,33 @@ namespace {
         << " --validation        Run (rudimentary) validation at the end\n"
         << " --histogram         Produce histograms at the end\n"
         << " --empty             Ignore all producers (for testing only)\n"
+        << " --sourceMode        How the Source reads the raw data (default 'preload')\n"
+        << "                     preload: read all of 'raw.bin' in memory before the processing\n"
+        << "                     mmap: memory-map 'raw_indexed.bin' (see convert-raw-to-indexed.py) and read each "
+           "event on demand\n"
+        << "                     stream: read 'raw.bin' sequentially on a separate thread, keeping in memory only the "
+           "events being processed or prefetched\n"
+        << "                     replay: read 'replay.bin' (written with --output) in memory before the processing, "
+           "and start the\n"
+        << "                     processing after the stage of the products it contains\n"
+        << " --prefetchEvents    Number of events read ahead in the 'stream' source mode (default numberOfStreams)\n"
+        << " --timing            Measure the time spent in each module, and print a summary at the end\n"
+        << " --timingOutput      Write the time spent in each module in each event to this file, in CSV (.csv) or "
+           "JSON (.json) format (implies --timing)\n"
+        << " --trace             Write the timeline of the Source, the modules, and the end of each event to this "
+           "file, in the Chrome trace format\n"
+        << "                     (to be opened with chrome://tracing or https://ui.perfetto.dev)\n"
+        << " --traceBufferSize   Number of spans kept per thread for --trace, older spans are overwritten (default "
+           "65536)\n"
+        << " --targetLatencyMs   Adapt the number of concurrent events, between 1 and the number of streams, to keep "
+           "the latency per event\n"
+        << "                     below this value, leaving the spare threads to the parallel loops within each "
+           "event (default 0 = disabled)\n"
+        << " --output            Write the products of each event up to the --outputStage to this file, to be "
+           "replayed with --sourceMode replay\n"
+        << " --outputStage       Last stage whose products are written to the --output file: clusters (digis and "
+           "clusters), hits\n"
+        << "                     (and hits), or tracks (and tracks) (default 'tracks')\n"
         << std::endl;
   }
 }  // namespace
@@ -45,6 +73,15 @@ int main(int argc, char** argv) {
   bool validation = false;
   bool histogram = false;
   bool empty = false;
+  edm::Source::Mode sourceMode = edm::Source::Mode::preload;
+  int prefetchEvents = 0;
+  bool timing = false;
+  std::filesystem::path timingOutput;
+  std::filesystem::path traceOutput;
+  int traceBufferSize = 65536;
+  double targetLatencyMs = 0.;
+  std::filesystem::path output;
+  edm::replay::Stage outputStage = edm::replay::Stage::tracks;
   for (auto i = args.begin() + 1, e = args.end(); i != e; ++i) {
     if (*i == "-h" or *i == "--help") {
       print_help(args.front());
@@ -70,6 +107,51 @@ int main(int argc, char** argv) {
       histogram = true;
     } else if (*i == "--empty") {
       empty = true;
+    } else if (*i == "--sourceMode") {
+      ++i;
+      if (*i == "preload") {
+        sourceMode = edm::Source::Mode::preload;
+      } else if (*i == "mmap") {
+        sourceMode = edm::Source::Mode::mmap;
+      } else if (*i == "stream") {
+        sourceMode = edm::Source::Mode::stream;
+      } else if (*i == "replay") {
+        sourceMode = edm::Source::Mode::replay;
+      } else {
+        std::cout << "Invalid source mode " << *i << std::endl << std::endl;
+        print_help(args.front());
+        return EXIT_FAILURE;
+      }
+    } else if (*i == "--prefetchEvents") {
+      ++i;
+      prefetchEvents = std::stoi(*i);
+    } else if (*i == "--timing") {
+      timing = true;
+    } else if (*i == "--timingOutput") {
+      ++i;
+      timingOutput = *i;
+      timing = true;
+    } else if (*i == "--trace") {
+      ++i;
+      traceOutput = *i;
+    } else if (*i == "--traceBufferSize") {
+      ++i;
+      traceBufferSize = std::stoi(*i);
+    } else if (*i == "--targetLatencyMs") {
+      ++i;
+      targetLatencyMs = std::stod(*i);
+    } else if (*i == "--output") {
+      ++i;
+      output = *i;
+    } else if (*i == "--outputStage") {
+      ++i;
+      try {
+        outputStage = edm::replay::stageFromName(*i);
+      } catch (std::runtime_error& e) {
+        std::cout << e.what() << std::endl << std::endl;
+        print_help(args.front());
+        return EXIT_FAILURE;
+      }
     } else {
       std::cout << "Invalid parameter " << *i << std::endl << std::endl;
       print_help(args.front());
@@ -86,6 +168,21 @@ int main(int argc, char** argv) {
   if (numberOfStreams == 0) {
     numberOfStreams = numberOfThreads;
   }
+  if (prefetchEvents <= 0) {
+    prefetchEvents = numberOfStreams;
+  }
+  if (not timingOutput.empty() and timingOutput.extension() != ".csv" and timingOutput.extension() != ".json") {
+    std::cout << "The file given to --timingOutput must have the .csv or .json extension" << std::endl;
+    return EXIT_FAILURE;
+  }
+  if (traceBufferSize <= 0) {
+    std::cout << "--traceBufferSize must be positive" << std::endl;
+    return EXIT_FAILURE;
+  }
+  if (targetLatencyMs < 0.) {
+    std::cout << "--targetLatencyMs must not be negative" << std::endl;
+    return EXIT_FAILURE;
+  }
   if (datadir.empty()) {
     datadir = std::filesystem::path(args[0]).parent_path() / "data";
   }
@@ -104,6 +201,25 @@ int main(int argc, char** argv) {
                  "SiPixelFedCablingMapGPUWrapperESProducer",
                  "SiPixelGainCalibrationForHLTGPUESProducer",
                  "PixelCPEFastESProducer"};
+    if (sourceMode == edm::Source::Mode::replay) {
+      // the Source gives the products of the stages in the file, the processing starts with the following stage
+      edm::replay::Stage stage;
+      try {
+        stage = edm::replay::readStage(datadir / "replay.bin");
+      } catch (std::runtime_error& e) {
+        std::cout << e.what() << std::endl;
+        return EXIT_FAILURE;
+      }
+      esmodules = {"BeamSpotESProducer", "PixelCPEFastESProducer"};
+      if (stage == edm::replay::Stage::clusters) {
+        edmodules = {"BeamSpotToPOD", "SiPixelRecHitCUDA", "CAHitNtupletCUDA", "PixelVertexProducerCUDA"};
+      } else if (stage == edm::replay::Stage::hits) {
+        edmodules = {"CAHitNtupletCUDA", "PixelVertexProducerCUDA"};
+      } else {
+        edmodules = {"PixelVertexProducerCUDA"};
+      }
+      std::cout << "Replaying the products up to the " << edm::replay::stageName(stage) << " stage" << std::endl;
+    }
     if (validation) {
       edmodules.emplace_back("CountValidator");
     }
@@ -111,9 +227,28 @@ int main(int argc, char** argv) {
       edmodules.emplace_back("HistoValidator");
     }
   }
-  edm::EventProcessor processor(
-      maxEvents, runForMinutes, numberOfStreams, std::move(edmodules), std::move(esmodules), datadir, validation);
+  edm::EventProcessor processor(maxEvents,
+                                runForMinutes,
+                                numberOfStreams,
+                                std::move(edmodules),
+                                std::move(esmodules),
+                                datadir,
+                                validation,
+                                sourceMode,
+                                prefetchEvents,
+                                timing,
+                                timingOutput,
+                                traceOutput,
+                                traceBufferSize,
+                                std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+                                    std::chrono::duration<double, std::milli>(targetLatencyMs)),
+                                output,
+                                outputStage);
 
+  if (targetLatencyMs > 0.) {
+    std::cout << "Adapting the number of concurrent events, up to " << numberOfStreams
+              << ", to a target latency per event of " << targetLatencyMs << " ms." << std::endl;
+  }
   if (runForMinutes < 0) {
     std::cout << "Processing " << processor.maxEvents() << " events, of which " << numberOfStreams
               << " concurrently, with " << numberOfThreads << " threads." << std::endl;
@@ -168,9 +303,30 @@ int main(int argc, char** argv) {
   auto time = static_cast<double>(std::chrono::duration_cast<std::chrono::microseconds>(diff).count()) / 1e6;
   auto cpu_diff = cpu_stop - cpu_start;
   auto cpu = static_cast<double>(std::chrono::duration_cast<std::chrono::microseconds>(cpu_diff).count()) / 1e6;
+  auto toMs = [](std::chrono::steady_clock::duration d) {
+    return std::chrono::duration<double, std::milli>(d).count();
+  };
+  auto averageLatency = toMs(processor.averageLatency());
+  auto maxLatency = toMs(processor.maxLatency());
   maxEvents = processor.processedEvents();
   std::cout << "Processed " << maxEvents << " events in " << std::scientific << time << " seconds, throughput "
-            << std::defaultfloat << (maxEvents / time) << " events/s, CPU usage per thread: " << std::fixed
-            << std::setprecision(1) << (cpu / time / numberOfThreads * 100) << "%" << std::endl;
+            << std::defaultfloat << (maxEvents / time) << " events/s, latency per event " << averageLatency
+            << " ms (max " << maxLatency << " ms), CPU usage per thread: " << std::fixed << std::setprecision(1)
+            << (cpu / time / numberOfThreads * 100) << "%" << std::endl;
+  std::cout << "Latency per event: p50 " << std::setprecision(3) << toMs(processor.latencyPercentile(0.50))
+            << " ms, p90 " << toMs(processor.latencyPercentile(0.90)) << " ms, p99 "
+            << toMs(processor.latencyPercentile(0.99)) << " ms, max " << toMs(processor.maxLatency()) << " ms"
+            << std::endl;
+  if (auto const* writer = processor.output()) {
+    std::cout << "Wrote the products up to the " << edm::replay::stageName(outputStage) << " stage of "
+              << writer->writtenEvents() << " events to " << output << std::endl;
+  }
+  if (auto const* controller = processor.latencyController()) {
+    auto above = processor.eventsAboveTargetLatency();
+    std::cout << above << " events (" << std::setprecision(1) << (maxEvents > 0 ? 100. * above / maxEvents : 0.)
+              << "%) above the target latency of " << std::setprecision(3) << toMs(controller->target())
+              << " ms, " << controller->inFlight() << " concurrent events at the end of the job (between "
+              << controller->minUsed() << " and " << controller->maxUsed() << ")" << std::endl;
+  }
   return EXIT_SUCCESS;
 }
@@ -0,0 +1,241 @@
+#ifndef RecoPixelVertexing_PixelTriplets_plugins_CACellsSoA_h
+#define RecoPixelVertexing_PixelTriplets_plugins_CACellsSoA_h
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "CUDACore/cudaCompat.h"
+
+#include "CUDACore/AtomicPairCounter.h"
+#include "CUDACore/cuda_assert.h"
+
+#include "GPUCACell.h"
+
+// The cells of the CA as a structure of arrays, for the CPU: the fields read while connecting the cells and searching
+// the ntuplets are kept in separate arrays (20 bytes per cell, instead of the 40 bytes of a GPUCACell), and the outer
+// neighbours and the tracks of the cells are stored, once they are all known, as lists in a single array with the
+// offset of the list of each cell (CSR), without a maximum number per cell and without the VecArray slots of
+// CellNeighborsVector and CellTracksVector.
+//
+// The cuts, the order of the neighbours and the order of the ntuplets are those of kernel_connect and
+// kernel_find_ntuplets, so that the two layouts give the same ntuplets when the lists of the GPUCACell do not
+// overflow.
+class CACellsSoA {
+public:
+  using Hits = GPUCACell::Hits;
+  using hindex_type = GPUCACell::hindex_type;
+  using tindex_type = CAConstants::tindex_type;
+  using OuterHitOfCell = GPUCACell::OuterHitOfCell;
+  using TmpTuple = GPUCACell::TmpTuple;
+  using HitContainer = GPUCACell::HitContainer;
+  using Quality = GPUCACell::Quality;
+
+  CACellsSoA() = default;
+
+  // the hot fields of the doublets found by getDoubletsFromHisto, in the same order
+  void fill(Hits const& hh, GPUCACell const* cells, uint32_t nCells) {
+    resize(nCells);
+    for (uint32_t i = 0; i < nCells; ++i) {
+      auto const& cell = cells[i];
+      innerHitId_[i] = cell.get_inner_hit_id();
+      outerHitId_[i] = cell.get_outer_hit_id();
+      innerZ_[i] = cell.get_inner_z(hh);
+      innerR_[i] = cell.get_inner_r(hh);
+      doubletId_[i] = cell.theDoubletId;
+      layerPairId_[i] = cell.theLayerPairId;
+      used_[i] = cell.theUsed;
+    }
+  }
+
+  uint32_t size() const { return innerHitId_.size(); }
+
+  hindex_type innerHitId(uint32_t i) const { return innerHitId_[i]; }
+  hindex_type outerHitId(uint32_t i) const { return outerHitId_[i]; }
+  int32_t doubletId(uint32_t i) const { return doubletId_[i]; }
+  int16_t layerPairId(uint32_t i) const { return layerPairId_[i]; }
+  uint16_t used(uint32_t i) const { return used_[i]; }
+
+  // the outer neighbours and the tracks of a cell
+  uint32_t const* neighborsBegin(uint32_t i) const { return neighbors_.data() + neighborStart_[i]; }
+  uint32_t const* neighborsEnd(uint32_t i) const { return neighbors_.data() + neighborStart_[i + 1]; }
+  tindex_type const* tracksBegin(uint32_t i) const { return tracks_.data() + trackStart_[i]; }
+  tindex_type const* tracksEnd(uint32_t i) const { return tracks_.data() + trackStart_[i + 1]; }
+
+  // the same as kernel_connect: the pairs (inner cell, outer cell) are collected in the order of the outer cells, and
+  // then sorted by inner cell
+  void connect(Hits const& hh,
+               OuterHitOfCell const* __restrict__ isOuterHitOfCell,
+               float hardCurvCut,
+               float ptmin,
+               float CAThetaCutBarrel,
+               float CAThetaCutForward,
+               float dcaCutInnerTriplet,
+               float dcaCutOuterTriplet) {
+    constexpr uint32_t last_bpix1_detIndex = 96;
+    constexpr uint32_t last_barrel_detIndex = 1184;
+    pairs_.clear();
+    for (uint32_t idx = 0, nt = size(); idx < nt; ++idx) {
+      auto innerHitId = innerHitId_[idx];
+      if (isOuterHitOfCell->size(innerHitId) == 0)
+        continue;
+
+      auto ri = innerR_[idx];
+      auto zi = innerZ_[idx];
+      auto ro = hh.rGlobal(outerHitId_[idx]);
+      auto zo = hh.zGlobal(outerHitId_[idx]);
+      auto x2 = hh.xGlobal(innerHitId);
+      auto y2 = hh.yGlobal(innerHitId);
+      auto x3 = hh.xGlobal(outerHitId_[idx]);
+      auto y3 = hh.yGlobal(outerHitId_[idx]);
+      auto thetaCut = hh.detectorIndex(innerHitId) < last_barrel_detIndex ? CAThetaCutBarrel : CAThetaCutForward;
+
+      bool connected = false;
+      for (auto vi = isOuterHitOfCell->begin(innerHitId); vi != isOuterHitOfCell->end(innerHitId); ++vi) {
+        auto otherCell = *vi;
+        auto otherHitId = innerHitId_[otherCell];
+        if (GPUCACell::areAlignedRZ(innerR_[otherCell], innerZ_[otherCell], ri, zi, ro, zo, ptmin, thetaCut) &&
+            GPUCACell::dcaCutH(hh.xGlobal(otherHitId),
+                               hh.yGlobal(otherHitId),
+                               x2,
+                               y2,
+                               x3,
+                               y3,
+                               hh.detectorIndex(otherHitId) < last_bpix1_detIndex ? dcaCutInnerTriplet
+                                                                                  : dcaCutOuterTriplet,
+                               hardCurvCut)) {
+          pairs_.emplace_back(otherCell, idx);
+          used_[otherCell] |= 1;
+          connected = true;
+        }
+      }
+      if (connected)
+        used_[idx] |= 1;
+    }
+    fillLists(pairs_, neighborStart_, neighbors_);
+  }
+
+  // the same as kernel_find_ntuplets
+  void findNtuplets(HitContainer& foundNtuplets,
+                    cms::cuda::AtomicPairCounter& apc,
+                    Quality* __restrict__ quality,
+                    unsigned int minHitsPerNtuplet) {
+    trackPairs_.clear();
+    for (uint32_t idx = 0, nt = size(); idx < nt; ++idx) {
+      if (doubletId_[idx] < 0)
+        continue;  // cut by earlyFishbone
+      auto pid = layerPairId_[idx];
+      if (minHitsPerNtuplet > 3 ? pid < 3 : pid < 8 || pid > 12) {
+        TmpTuple stack;
+        stack.reset();
+        visit<6>(idx, stack, minHitsPerNtuplet, [&](hindex_type const* hits, uint32_t nHits) {
+          auto it = foundNtuplets.bulkFill(apc, hits, nHits);
+          if (it >= 0) {  // if negative is overflow....
+            for (auto c : stack)
+              trackPairs_.emplace_back(c, it);
+            quality[it] = trackQuality::bad;  // initialize to bad
+          }
+        });
+        assert(stack.empty());
+      }
+    }
+    fillLists(trackPairs_, trackStart_, tracks_);
+  }
+
+  // the memory used by the cells and by their lists
+  size_t cellBytes() const {
+    return size() * (sizeof(hindex_type) * 2 + sizeof(float) * 2 + sizeof(int32_t) + sizeof(int16_t) +
+                     sizeof(uint16_t)) +
+           (neighborStart_.size() + trackStart_.size()) * sizeof(uint32_t);
+  }
+  size_t listBytes() const { return neighbors_.size() * sizeof(uint32_t) + tracks_.size() * sizeof(tindex_type); }
+
+private:
+  void resize(uint32_t nCells) {
+    innerHitId_.resize(nCells);
+    outerHitId_.resize(nCells);
+    innerZ_.resize(nCells);
+    innerR_.resize(nCells);
+    doubletId_.resize(nCells);
+    layerPairId_.resize(nCells);
+    used_.resize(nCells);
+    neighborStart_.assign(nCells + 1, 0);
+    trackStart_.assign(nCells + 1, 0);
+    neighbors_.clear();
+    tracks_.clear();
+  }
+
+  // counting sort of the pairs (cell, value) by cell, keeping the order of the values of each cell
+  template <typename T>
+  void fillLists(std::vector<std::pair<uint32_t, uint32_t>> const& pairs,
+                 std::vector<uint32_t>& start,
+                 std::vector<T>& values) const {
+    start.assign(size() + 1, 0);
+    for (auto const& p : pairs)
+      ++start[p.first + 1];
+    for (uint32_t i = 0, n = size(); i < n; ++i)
+      start[i + 1] += start[i];
+    values.resize(pairs.size());
+    for (auto const& p : pairs)
+      values[start[p.first]++] = p.second;
+    // each start has been moved to the end of its list, that is the start of the next one
+    for (uint32_t i = size(); i > 0; --i)
+      start[i] = start[i - 1];
+    start[0] = 0;
+  }
+
+  // the same visit as GPUCACell::find_ntuplets
+  template <int DEPTH, typename Found>
+  void visit(uint32_t idx, TmpTuple& tmpNtuplet, const unsigned int minHitsPerNtuplet, Found&& found) const {
+    if constexpr (DEPTH == 0) {
+      printf("ERROR: CACellsSoA::visit reached full depth!\n");
+      abort();
+    } else {
+      tmpNtuplet.push_back_unsafe(doubletId_[idx]);
+      assert(tmpNtuplet.size() <= 4);
+
+      bool last = true;
+      for (auto otherCell = neighborsBegin(idx), end = neighborsEnd(idx); otherCell != end; ++otherCell) {
+        if (doubletId_[*otherCell] < 0)
+          continue;  // killed by earlyFishbone
+        last = false;
+        visit<DEPTH - 1>(*otherCell, tmpNtuplet, minHitsPerNtuplet, found);
+      }
+      if (last) {  // if long enough save...
+        if ((unsigned int)(tmpNtuplet.size()) >= minHitsPerNtuplet - 1) {
+          hindex_type hits[6];
+          auto nh = 0U;
+          for (auto c : tmpNtuplet) {
+            hits[nh++] = innerHitId_[c];
+          }
+          hits[nh] = outerHitId_[idx];
+          found(hits, tmpNtuplet.size() + 1);
+        }
+      }
+      tmpNtuplet.pop_back();
+      assert(tmpNtuplet.size() < 4);
+    }
+  }
+
+  // hot fields, one entry per cell
+  std::vector<hindex_type> innerHitId_;
+  std::vector<hindex_type> outerHitId_;
+  std::vector<float> innerZ_;
+  std::vector<float> innerR_;
+  std::vector<int32_t> doubletId_;
+  std::vector<int16_t> layerPairId_;
+  std::vector<uint16_t> used_;
+
+  // the lists of the cells, with one more offset than cells
+  std::vector<uint32_t> neighborStart_;
+  std::vector<uint32_t> neighbors_;
+  std::vector<uint32_t> trackStart_;
+  std::vector<tindex_type> tracks_;
+
+  // the pairs (cell, neighbour) and (cell, track) from which the lists are filled
+  std::vector<std::pair<uint32_t, uint32_t>> pairs_;
+  std::vector<std::pair<uint32_t, uint32_t>> trackPairs_;
+};
+
+#endif  // RecoPixelVertexing_PixelTriplets_plugins_CACellsSoA_h
@@ -28,14 +28,11 @@ namespace CAConstants {
 #ifndef ONLY_PHICUT
 #ifndef GPU_SMALL_EVENTS
   constexpr uint32_t maxNumberOfDoublets() { return 512 * 1024; }
-  constexpr uint32_t maxCellsPerHit() { return 128; }
 #else
   constexpr uint32_t maxNumberOfDoublets() { return 128 * 1024; }
-  constexpr uint32_t maxCellsPerHit() { return 128 / 2; }
 #endif
 #else
   constexpr uint32_t maxNumberOfDoublets() { return 2 * 1024 * 1024; }
-  constexpr uint32_t maxCellsPerHit() { return 8 * 128; }
 #endif
   constexpr uint32_t maxNumOfActiveDoublets() { return maxNumberOfDoublets() / 8; }
 
@@ -58,7 +55,9 @@ namespace CAConstants {
   using CellNeighborsVector = cms::cuda::SimpleVector<CellNeighbors>;
   using CellTracksVector = cms::cuda::SimpleVector<CellTracks>;
 
-  using OuterHitOfCell = cms::cuda::VecArray<uint32_t, maxCellsPerHit()>;
+  // the cells ending on each hit, for all the hits of the event: counted and filled once all the cells are found, so
+  // that there is no maximum number of cells per hit
+  using OuterHitOfCell = cms::cuda::OneToManyAssoc<uint32_t, pixelGPUConstants::maxNumberOfHits, maxNumberOfDoublets()>;
   using TuplesContainer = cms::cuda::OneToManyAssoc<hindex_type, maxTuples(), 5 * maxTuples()>;
   using HitToTuple =
       cms::cuda::OneToManyAssoc<tindex_type, pixelGPUConstants::maxNumberOfHits, 4 * maxTuples()>;  // 3.5 should be enough
@@ -22,29 +22,29 @@ void CAHitNtupletGeneratorKernelsCPU::buildDoublets(HitsOnCPU const &hh, cudaStr
   std::cout << "building Doublets out of " << nhits << " Hits" << std::endl;
 #endif
 
-  // in principle we can use "nhits" to heuristically dimension the workspace...
-  // overkill to use template here (std::make_unique would suffice)
-  // device_isOuterHitOfCell_ = Traits:: template make_unique<GPUCACell::OuterHitOfCell[]>(cs, std::max(1U,nhits), stream);
-  device_isOuterHitOfCell_.reset(
-      (GPUCACell::OuterHitOfCell *)malloc(std::max(1U, nhits) * sizeof(GPUCACell::OuterHitOfCell)));
+  // isOuterHitOfCell is allocated for the maximum number of hits and cells in allocateOnGPU
   assert(device_isOuterHitOfCell_.get());
 
-  cellStorage_.reset((unsigned char *)malloc(CAConstants::maxNumOfActiveDoublets() * sizeof(GPUCACell::CellNeighbors) +
-                                             CAConstants::maxNumOfActiveDoublets() * sizeof(GPUCACell::CellTracks)));
-  device_theCellNeighborsContainer_ = (GPUCACell::CellNeighbors *)cellStorage_.get();
-  device_theCellTracksContainer_ =
-      (GPUCACell::CellTracks *)(cellStorage_.get() +
-                                CAConstants::maxNumOfActiveDoublets() * sizeof(GPUCACell::CellNeighbors));
+  if (not cellStorage_) {
+    cellStorage_.reset(
+        (unsigned char *)malloc(CAConstants::maxNumOfActiveDoublets() * sizeof(GPUCACell::CellNeighbors) +
+                                CAConstants::maxNumOfActiveDoublets() * sizeof(GPUCACell::CellTracks)));
+    device_theCellNeighborsContainer_ = (GPUCACell::CellNeighbors *)cellStorage_.get();
+    device_theCellTracksContainer_ =
+        (GPUCACell::CellTracks *)(cellStorage_.get() +
+                                  CAConstants::maxNumOfActiveDoublets() * sizeof(GPUCACell::CellNeighbors));
+  }
 
   gpuPixelDoublets::initDoublets(device_isOuterHitOfCell_.get(),
-                                 nhits,
                                  device_theCellNeighbors_.get(),
                                  device_theCellNeighborsContainer_,
                                  device_theCellTracks_.get(),
                                  device_theCellTracksContainer_);
 
   // device_theCells_ = Traits:: template make_unique<GPUCACell[]>(cs, m_params.maxNumberOfDoublets_, stream);
-  device_theCells_.reset((GPUCACell *)malloc(sizeof(GPUCACell) * m_params.maxNumberOfDoublets_));
+  if (not device_theCells_) {
+    device_theCells_.reset((GPUCACell *)malloc(sizeof(GPUCACell) * m_params.maxNumberOfDoublets_));
+  }
   if (0 == nhits)
     return;  // protect against empty events
 
@@ -143,7 +143,6 @@ void CAHitNtupletGeneratorKernelsCPU::launchKernels(HitsOnCPU const &hh, TkSoA *
                           device_nCells_,
                           device_theCellNeighbors_.get(),
                           device_theCellTracks_.get(),
-                          device_isOuterHitOfCell_.get(),
                           nhits,
                           m_params.maxNumberOfDoublets_,
                           counters_);
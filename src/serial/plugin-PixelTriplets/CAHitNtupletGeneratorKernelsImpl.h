@@ -4,8 +4,16 @@
 
 // #define NTUPLE_DEBUG
 
+#include <algorithm>
+#include <atomic>
 #include <cmath>
 #include <cstdint>
+#include <vector>
+
+#ifdef SERIAL_ENABLE_INTRA_EVENT_PARALLELISM
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+#endif
 
 #include "CUDACore/cudaCompat.h"
 
@@ -32,7 +40,6 @@ void kernel_checkOverflows(HitContainer const *foundNtuplets,
                            uint32_t const *__restrict__ nCells,
                            gpuPixelDoublets::CellNeighborsVector const *cellNeighbors,
                            gpuPixelDoublets::CellTracksVector const *cellTracks,
-                           GPUCACell::OuterHitOfCell const *__restrict__ isOuterHitOfCell,
                            uint32_t nHits,
                            uint32_t maxNumberOfDoublets,
                            CAHitNtupletGeneratorKernelsCPU::Counters *counters) {
@@ -94,11 +101,6 @@ void kernel_checkOverflows(HitContainer const *foundNtuplets,
     if (thisCell.tracks().empty())
       atomicAdd(&c.nZeroTrackCells, 1);
   }
-
-  for (int idx = first, nt = nHits; idx < nt; idx++) {
-    if (isOuterHitOfCell[idx].full())  // ++tooManyOuterHitOfCell;
-      printf("OuterHitOfCell overflow %d\n", idx);
-  }
 }
 
 void kernel_fishboneCleaner(GPUCACell const *cells, uint32_t const *__restrict__ nCells, Quality *quality) {
@@ -188,6 +190,64 @@ void kernel_fastDuplicateRemover(GPUCACell const *__restrict__ cells,
   }
 }
 
+// the inner cells that are aligned with the cell idx: connected(otherCell) is called for each of them, in the order of
+// isOuterHitOfCell
+template <typename Connected>
+inline void connectCell(GPUCACell::Hits const &hh,
+                        GPUCACell const *cells,
+                        int idx,
+                        GPUCACell::OuterHitOfCell const *__restrict__ isOuterHitOfCell,
+                        float hardCurvCut,
+                        float ptmin,
+                        float CAThetaCutBarrel,
+                        float CAThetaCutForward,
+                        float dcaCutInnerTriplet,
+                        float dcaCutOuterTriplet,
+                        Connected &&connected) {
+  auto const &thisCell = cells[idx];
+  //if (thisCell.theDoubletId < 0 || thisCell.theUsed>1)
+  //  continue;
+  auto innerHitId = thisCell.get_inner_hit_id();
+  int numberOfPossibleNeighbors = isOuterHitOfCell->size(innerHitId);
+  auto vi = isOuterHitOfCell->begin(innerHitId);
+
+  constexpr uint32_t last_bpix1_detIndex = 96;
+  constexpr uint32_t last_barrel_detIndex = 1184;
+  auto ri = thisCell.get_inner_r(hh);
+  auto zi = thisCell.get_inner_z(hh);
+
+  auto ro = thisCell.get_outer_r(hh);
+  auto zo = thisCell.get_outer_z(hh);
+  auto isBarrel = thisCell.get_inner_detIndex(hh) < last_barrel_detIndex;
+
+  for (int j = 0; j < numberOfPossibleNeighbors; ++j) {
+    auto otherCell = vi[j];
+    auto const &oc = cells[otherCell];
+    // if (cells[otherCell].theDoubletId < 0 ||
+    //    cells[otherCell].theUsed>1 )
+    //  continue;
+    auto r1 = oc.get_inner_r(hh);
+    auto z1 = oc.get_inner_z(hh);
+    // auto isBarrel = oc.get_outer_detIndex(hh) < last_barrel_detIndex;
+    bool aligned = GPUCACell::areAlignedRZ(
+        r1,
+        z1,
+        ri,
+        zi,
+        ro,
+        zo,
+        ptmin,
+        isBarrel ? CAThetaCutBarrel : CAThetaCutForward);  // 2.f*thetaCut); // FIXME tune cuts
+    if (aligned &&
+        thisCell.dcaCut(hh,
+                        oc,
+                        oc.get_inner_detIndex(hh) < last_bpix1_detIndex ? dcaCutInnerTriplet : dcaCutOuterTriplet,
+                        hardCurvCut)) {  // FIXME tune cuts
+      connected(otherCell);
+    }
+  }  // loop on inner cells
+}
+
 void kernel_connect(cms::cuda::AtomicPairCounter *apc1,
                     cms::cuda::AtomicPairCounter *apc2,  // just to zero them,
                     GPUCACell::Hits const *__restrict__ hhp,
@@ -205,60 +265,77 @@ void kernel_connect(cms::cuda::AtomicPairCounter *apc1,
 
   auto firstCellIndex = 0 + 0 * 1;
   uint32_t first = 0;
-  auto stride = 1;
 
   if (0 == (firstCellIndex + first)) {
     (*apc1) = 0;
     (*apc2) = 0;
   }  // ready for next kernel
 
+#ifdef SERIAL_ENABLE_INTRA_EVENT_PARALLELISM
+  // the cells are connected in parallel, with real atomics, and the neighbours of each cell are then sorted, so that
+  // they are the same, and in the same order, as those of the sequential loop; if a neighbour could not be stored,
+  // the cells are connected again sequentially, so that the same neighbours as in the sequential loop are dropped
+  std::atomic<bool> overflow{false};
+  tbb::parallel_for(tbb::blocked_range<int>(firstCellIndex, *nCells), [&](tbb::blocked_range<int> const &range) {
+    for (auto idx = range.begin(); idx < range.end(); ++idx) {
+      bool used = false;
+      connectCell(hh,
+                  cells,
+                  idx,
+                  isOuterHitOfCell,
+                  hardCurvCut,
+                  ptmin,
+                  CAThetaCutBarrel,
+                  CAThetaCutForward,
+                  dcaCutInnerTriplet,
+                  dcaCutOuterTriplet,
+                  [&](uint32_t otherCell) {
+                    auto &oc = cells[otherCell];
+                    if (oc.addOuterNeighborConcurrent(idx, *cellNeighbors) < 0)
+                      overflow = true;
+                    oc.markUsedConcurrent(1);
+                    used = true;
+                  });
+      if (used)
+        cells[idx].markUsedConcurrent(1);
+    }
+  });
+  if (not overflow) {
+    // each list is in its own slot of cellNeighbors, the first one being the empty list
+    tbb::parallel_for(tbb::blocked_range<int>(1, cellNeighbors->size()), [&](tbb::blocked_range<int> const &range) {
+      for (auto i = range.begin(); i < range.end(); ++i) {
+        auto &neighbors = (*cellNeighbors)[i];
+        std::sort(neighbors.begin(), neighbors.end());
+      }
+    });
+    return;
+  }
+  cellNeighbors->resize(1);
+  for (int idx = firstCellIndex, nt = (*nCells); idx < nt; idx++) {
+    cells[idx].resetOuterNeighbors(*cellNeighbors);
+  }
+#endif
+
   for (int idx = firstCellIndex, nt = (*nCells); idx < nt; idx += 1) {
     auto cellIndex = idx;
     auto &thisCell = cells[idx];
-    //if (thisCell.theDoubletId < 0 || thisCell.theUsed>1)
-    //  continue;
-    auto innerHitId = thisCell.get_inner_hit_id();
-    int numberOfPossibleNeighbors = isOuterHitOfCell[innerHitId].size();
-    auto vi = isOuterHitOfCell[innerHitId].data();
-
-    constexpr uint32_t last_bpix1_detIndex = 96;
-    constexpr uint32_t last_barrel_detIndex = 1184;
-    auto ri = thisCell.get_inner_r(hh);
-    auto zi = thisCell.get_inner_z(hh);
-
-    auto ro = thisCell.get_outer_r(hh);
-    auto zo = thisCell.get_outer_z(hh);
-    auto isBarrel = thisCell.get_inner_detIndex(hh) < last_barrel_detIndex;
-
-    for (int j = first; j < numberOfPossibleNeighbors; j += stride) {
-      auto otherCell = vi[j];
-      auto &oc = cells[otherCell];
-      // if (cells[otherCell].theDoubletId < 0 ||
-      //    cells[otherCell].theUsed>1 )
-      //  continue;
-      auto r1 = oc.get_inner_r(hh);
-      auto z1 = oc.get_inner_z(hh);
-      // auto isBarrel = oc.get_outer_detIndex(hh) < last_barrel_detIndex;
-      bool aligned = GPUCACell::areAlignedRZ(
-          r1,
-          z1,
-          ri,
-          zi,
-          ro,
-          zo,
-          ptmin,
-          isBarrel ? CAThetaCutBarrel : CAThetaCutForward);  // 2.f*thetaCut); // FIXME tune cuts
-      if (aligned &&
-          thisCell.dcaCut(hh,
-                          oc,
-                          oc.get_inner_detIndex(hh) < last_bpix1_detIndex ? dcaCutInnerTriplet : dcaCutOuterTriplet,
-                          hardCurvCut)) {  // FIXME tune cuts
-        oc.addOuterNeighbor(cellIndex, *cellNeighbors);
-        thisCell.theUsed |= 1;
-        oc.theUsed |= 1;
-      }
-    }  // loop on inner cells
-  }    // loop on outer cells
+    connectCell(hh,
+                cells,
+                idx,
+                isOuterHitOfCell,
+                hardCurvCut,
+                ptmin,
+                CAThetaCutBarrel,
+                CAThetaCutForward,
+                dcaCutInnerTriplet,
+                dcaCutOuterTriplet,
+                [&](uint32_t otherCell) {
+                  auto &oc = cells[otherCell];
+                  oc.addOuterNeighbor(cellIndex, *cellNeighbors);
+                  thisCell.theUsed |= 1;
+                  oc.theUsed |= 1;
+                });
+  }  // loop on outer cells
 }
 
 void kernel_find_ntuplets(GPUCACell::Hits const *__restrict__ hhp,
@@ -272,15 +349,69 @@ void kernel_find_ntuplets(GPUCACell::Hits const *__restrict__ hhp,
   // recursive: not obvious to widen
   auto const &hh = *hhp;
 
+  // the cells from which the ntuplets are searched
+  auto isStart = [&](GPUCACell const &thisCell) {
+    if (thisCell.theDoubletId < 0)
+      return false;  // cut by earlyFishbone
+    auto pid = thisCell.theLayerPairId;
+    return minHitsPerNtuplet > 3 ? pid < 3 : pid < 8 || pid > 12;
+  };
+
   uint32_t first = 0;
+#ifdef SERIAL_ENABLE_INTRA_EVENT_PARALLELISM
+  // the ntuplets of each chunk of cells are searched in parallel, and saved in the order of the sequential loop, so
+  // that their numbering and the tracks of the cells are the same, also when there are too many of them
+  constexpr uint32_t cellsPerChunk = 256;
+  struct Chunk {
+    std::vector<GPUCACell::hindex_type> hits;
+    std::vector<uint32_t> cells;  // the cells of each ntuplet, one less than its hits
+    std::vector<uint8_t> nHits;
+  };
+  std::vector<Chunk> chunks((*nCells - first + cellsPerChunk - 1) / cellsPerChunk);
+  tbb::parallel_for(tbb::blocked_range<size_t>(0, chunks.size()), [&](tbb::blocked_range<size_t> const &range) {
+    for (auto ic = range.begin(); ic < range.end(); ++ic) {
+      auto &chunk = chunks[ic];
+      uint32_t begin = first + ic * cellsPerChunk;
+      for (auto idx = begin, nt = std::min(begin + cellsPerChunk, *nCells); idx < nt; idx++) {
+        auto const &thisCell = cells[idx];
+        if (not isStart(thisCell))
+          continue;
+        GPUCACell::TmpTuple stack;
+        stack.reset();
+        thisCell.find_ntuplets<6>(hh,
+                                  cells,
+                                  stack,
+                                  minHitsPerNtuplet,
+                                  thisCell.theLayerPairId < 3,
+                                  [&](GPUCACell::hindex_type const *hits, uint32_t nHits) {
+                                    chunk.hits.insert(chunk.hits.end(), hits, hits + nHits);
+                                    chunk.cells.insert(chunk.cells.end(), stack.begin(), stack.end());
+                                    chunk.nHits.push_back(nHits);
+                                  });
+        assert(stack.empty());
+      }
+    }
+  });
+
+  for (auto const &chunk : chunks) {
+    auto hits = chunk.hits.data();
+    auto tupleCells = chunk.cells.data();
+    for (auto nHits : chunk.nHits) {
+      auto it = foundNtuplets->bulkFill(*apc, hits, nHits);
+      if (it >= 0) {  // if negative is overflow....
+        for (uint32_t k = 0; k < nHits - 1U; ++k)
+          cells[tupleCells[k]].addTrack(it, *cellTracks);
+        quality[it] = trackQuality::bad;  // initialize to bad
+      }
+      hits += nHits;
+      tupleCells += nHits - 1;
+    }
+  }
+#else
   for (int idx = first, nt = (*nCells); idx < nt; idx++) {
     auto const &thisCell = cells[idx];
-    if (thisCell.theDoubletId < 0)
-      continue;  // cut by earlyFishbone
-
-    auto pid = thisCell.theLayerPairId;
-    auto doit = minHitsPerNtuplet > 3 ? pid < 3 : pid < 8 || pid > 12;
-    if (doit) {
+    if (isStart(thisCell)) {
+      auto pid = thisCell.theLayerPairId;
       GPUCACell::TmpTuple stack;
       stack.reset();
       thisCell.find_ntuplets<6>(
@@ -289,6 +420,7 @@ void kernel_find_ntuplets(GPUCACell::Hits const *__restrict__ hhp,
       // printf("in %d found quadruplets: %d\n", cellIndex, apc->get());
     }
   }
+#endif
 }
 
 void kernel_mark_used(GPUCACell::Hits const *__restrict__ hhp, GPUCACell *__restrict__ cells, uint32_t const *nCells) {
@@ -5,6 +5,7 @@
 #include <array>
 #include <cassert>
 #include <functional>
+#include <memory>
 #include <vector>
 
 #include "Framework/Event.h"
@@ -99,20 +100,24 @@ PixelTrackHeterogeneous CAHitNtupletGeneratorOnGPU::makeTuples(TrackingRecHit2DC
   auto* soa = tracks.get();
   assert(soa);
 
-  CAHitNtupletGeneratorKernelsCPU kernels(m_params);
-  kernels.counters_ = m_counters;
-  kernels.allocateOnGPU(nullptr);
+#ifndef SERIAL_DISABLE_CA_WORKSPACE_CACHE
+  auto kernels = m_kernelsCache.makeOrGet([this]() { return new CAHitNtupletGeneratorKernelsCPU(m_params); });
+#else
+  auto kernels = std::make_unique<CAHitNtupletGeneratorKernelsCPU>(m_params);
+#endif
+  kernels->counters_ = m_counters;
+  kernels->allocateOnGPU(nullptr);
 
-  kernels.buildDoublets(hits_d, nullptr);
-  kernels.launchKernels(hits_d, soa, nullptr);
-  kernels.fillHitDetIndices(hits_d.view(), soa, nullptr);  // in principle needed only if Hits not "available"
+  kernels->buildDoublets(hits_d, nullptr);
+  kernels->launchKernels(hits_d, soa, nullptr);
+  kernels->fillHitDetIndices(hits_d.view(), soa, nullptr);  // in principle needed only if Hits not "available"
 
   if (0 == hits_d.nHits())
     return tracks;
 
   // now fit
   HelixFitOnGPU fitter(bfield, m_params.fit5as4_);
-  fitter.allocateOnGPU(&(soa->hitIndices), kernels.tupleMultiplicity(), soa);
+  fitter.allocateOnGPU(&(soa->hitIndices), kernels->tupleMultiplicity(), soa);
 
   if (m_params.useRiemannFit_) {
     fitter.launchRiemannKernelsOnCPU(hits_d.view(), hits_d.nHits(), CAConstants::maxNumberOfQuadruplets());
@@ -120,7 +125,7 @@ PixelTrackHeterogeneous CAHitNtupletGeneratorOnGPU::makeTuples(TrackingRecHit2DC
     fitter.launchBrokenLineKernelsOnCPU(hits_d.view(), hits_d.nHits(), CAConstants::maxNumberOfQuadruplets());
   }
 
-  kernels.classifyTuples(hits_d, soa, nullptr);
+  kernels->classifyTuples(hits_d, soa, nullptr);
 
   return tracks;
 }
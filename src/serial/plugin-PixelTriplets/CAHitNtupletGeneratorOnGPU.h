@@ -6,6 +6,7 @@
 #include "CUDACore/SimpleVector.h"
 #include "CUDADataFormats/PixelTrackHeterogeneous.h"
 #include "CUDADataFormats/TrackingRecHit2DCUDA.h"
+#include "Framework/ReusableObjectHolder.h"
 
 #include "CAHitNtupletGeneratorKernels.h"
 #include "GPUCACell.h"
@@ -41,6 +42,13 @@ private:
   Params m_params;
 
   Counters* m_counters = nullptr;
+
+#ifndef SERIAL_DISABLE_CA_WORKSPACE_CACHE
+  // The CA workspace (cells, isOuterHitOfCell, HitToTuple, TupleMultiplicity, ...)
+  // is kept alive between events instead of being reallocated for each of them.
+  // The modules are instantiated per stream, so in practice the cache holds a single workspace.
+  mutable edm::ReusableObjectHolder<CAHitNtupletGeneratorKernelsCPU> m_kernelsCache;
+#endif
 };
 
 #endif  // RecoPixelVertexing_PixelTriplets_plugins_CAHitNtupletGeneratorOnGPU_h
@@ -22,7 +22,6 @@ class GPUCACell {
 public:
   using ptrAsInt = unsigned long long;
 
-  static constexpr int maxCellsPerHit = CAConstants::maxCellsPerHit();
   using OuterHitOfCell = CAConstants::OuterHitOfCell;
   using CellNeighbors = CAConstants::CellNeighbors;
   using CellTracks = CAConstants::CellTracks;
@@ -103,6 +102,28 @@ public:
     return tracks().push_back(t);
   }
 
+  // the same as addOuterNeighbor, with real atomics, for the cells connected by several threads on the CPU: as on
+  // the GPU, the slot taken by a thread that loses the race to link an empty cell is not given back
+  inline int addOuterNeighborConcurrent(CellNeighbors::value_t t, CellNeighborsVector& cellNeighbors) {
+    namespace concurrent = cms::cudacompat::concurrent;
+    auto* neighbors = concurrent::atomicLoad(&theOuterNeighbors);
+    if (neighbors == &cellNeighbors[0]) {
+      auto i = cellNeighbors.extend_concurrent();
+      if (i < 0)
+        return -1;
+      cellNeighbors[i].reset();
+      neighbors = concurrent::atomicCAS(&theOuterNeighbors, &cellNeighbors[0], &cellNeighbors[i]);
+      if (neighbors == &cellNeighbors[0])
+        neighbors = &cellNeighbors[i];
+    }
+    return neighbors->push_back_concurrent(t);
+  }
+
+  inline void markUsedConcurrent(uint16_t flag) { cms::cudacompat::concurrent::atomicOr(&theUsed, flag); }
+
+  // unlink the neighbours, after their storage has been reset
+  inline void resetOuterNeighbors(CellNeighborsVector& cellNeighbors) { theOuterNeighbors = &cellNeighbors[0]; }
+
   inline CellTracks& tracks() { return *theTracks; }
   inline CellTracks const& tracks() const { return *theTracks; }
   inline CellNeighbors& outerNeighbors() { return *theOuterNeighbors; }
@@ -285,49 +306,67 @@ public:
                             TmpTuple& tmpNtuplet,
                             const unsigned int minHitsPerNtuplet,
                             bool startAt0) const {
-    // the building process for a track ends if:
-    // it has no right neighbor
-    // it has no compatible neighbor
-    // the ntuplets is then saved if the number of hits it contains is greater
-    // than a threshold
-
-    tmpNtuplet.push_back_unsafe(theDoubletId);
-    assert(tmpNtuplet.size() <= 4);
-
-    bool last = true;
-    for (int j = 0; j < outerNeighbors().size(); ++j) {
-      auto otherCell = outerNeighbors()[j];
-      if (cells[otherCell].theDoubletId < 0)
-        continue;  // killed by earlyFishbone
-      last = false;
-      cells[otherCell].find_ntuplets<DEPTH - 1>(
-          hh, cells, cellTracks, foundNtuplets, apc, quality, tmpNtuplet, minHitsPerNtuplet, startAt0);
-    }
-    if (last) {  // if long enough save...
-      if ((unsigned int)(tmpNtuplet.size()) >= minHitsPerNtuplet - 1) {
-#ifdef ONLY_TRIPLETS_IN_HOLE
-        // triplets accepted only pointing to the hole
-        if (tmpNtuplet.size() >= 3 || (startAt0 && hole4(hh, cells[tmpNtuplet[0]])) ||
-            ((!startAt0) && hole0(hh, cells[tmpNtuplet[0]])))
-#endif
-        {
-          hindex_type hits[6];
-          auto nh = 0U;
-          for (auto c : tmpNtuplet) {
-            hits[nh++] = cells[c].theInnerHitId;
-          }
-          hits[nh] = theOuterHitId;
-          auto it = foundNtuplets.bulkFill(apc, hits, tmpNtuplet.size() + 1);
+    find_ntuplets<DEPTH>(
+        hh, cells, tmpNtuplet, minHitsPerNtuplet, startAt0, [&](hindex_type const* hits, uint32_t nHits) {
+          auto it = foundNtuplets.bulkFill(apc, hits, nHits);
           if (it >= 0) {  // if negative is overflow....
             for (auto c : tmpNtuplet)
               cells[c].addTrack(it, cellTracks);
             quality[it] = bad;  // initialize to bad
           }
+        });
+  }
+
+  // the same visit, that calls found(hits, nHits) for each ntuplet to be saved, with its cells in tmpNtuplet
+  template <int DEPTH, typename Found>
+  inline void find_ntuplets(Hits const& hh,
+                            GPUCACell const* __restrict__ cells,
+                            TmpTuple& tmpNtuplet,
+                            const unsigned int minHitsPerNtuplet,
+                            bool startAt0,
+                            Found&& found) const {
+    if constexpr (DEPTH == 0) {
+      printf("ERROR: GPUCACell::find_ntuplets reached full depth!\n");
+      abort();
+    } else {
+      // the building process for a track ends if:
+      // it has no right neighbor
+      // it has no compatible neighbor
+      // the ntuplets is then saved if the number of hits it contains is greater
+      // than a threshold
+
+      tmpNtuplet.push_back_unsafe(theDoubletId);
+      assert(tmpNtuplet.size() <= 4);
+
+      bool last = true;
+      for (int j = 0; j < outerNeighbors().size(); ++j) {
+        auto otherCell = outerNeighbors()[j];
+        if (cells[otherCell].theDoubletId < 0)
+          continue;  // killed by earlyFishbone
+        last = false;
+        cells[otherCell].find_ntuplets<DEPTH - 1>(hh, cells, tmpNtuplet, minHitsPerNtuplet, startAt0, found);
+      }
+      if (last) {  // if long enough save...
+        if ((unsigned int)(tmpNtuplet.size()) >= minHitsPerNtuplet - 1) {
+#ifdef ONLY_TRIPLETS_IN_HOLE
+          // triplets accepted only pointing to the hole
+          if (tmpNtuplet.size() >= 3 || (startAt0 && hole4(hh, cells[tmpNtuplet[0]])) ||
+              ((!startAt0) && hole0(hh, cells[tmpNtuplet[0]])))
+#endif
+          {
+            hindex_type hits[6];
+            auto nh = 0U;
+            for (auto c : tmpNtuplet) {
+              hits[nh++] = cells[c].theInnerHitId;
+            }
+            hits[nh] = theOuterHitId;
+            found(hits, tmpNtuplet.size() + 1);
+          }
         }
       }
+      tmpNtuplet.pop_back();
+      assert(tmpNtuplet.size() < 4);
     }
-    tmpNtuplet.pop_back();
-    assert(tmpNtuplet.size() < 4);
   }
 
 private:
@@ -346,18 +385,4 @@ private:
   hindex_type theOuterHitId;
 };
 
-template <>
-inline void GPUCACell::find_ntuplets<0>(Hits const& hh,
-                                        GPUCACell* __restrict__ cells,
-                                        CellTracksVector& cellTracks,
-                                        HitContainer& foundNtuplets,
-                                        cms::cuda::AtomicPairCounter& apc,
-                                        Quality* __restrict__ quality,
-                                        TmpTuple& tmpNtuplet,
-                                        const unsigned int minHitsPerNtuplet,
-                                        bool startAt0) const {
-  printf("ERROR: GPUCACell::find_ntuplets reached full depth!\n");
-  abort();
-}
-
 #endif  // RecoPixelVertexing_PixelTriplets_plugins_GPUCACell_h
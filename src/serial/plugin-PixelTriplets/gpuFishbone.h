@@ -6,6 +6,7 @@
 #include <cstdint>
 #include <cstdio>
 #include <limits>
+#include <vector>
 
 #include "DataFormats/approx_atan2.h"
 #include "Geometry/phase1PixelTopology.h"
@@ -24,8 +25,6 @@ namespace gpuPixelDoublets {
                 GPUCACell::OuterHitOfCell const* __restrict__ isOuterHitOfCell,
                 uint32_t nHits,
                 bool checkTrack) {
-    constexpr auto maxCellsPerHit = GPUCACell::maxCellsPerHit;
-
     auto const& hh = *hhp;
     // auto layer = [&](uint16_t id) { return hh.cpeParams().layer(id); };
 
@@ -33,15 +32,24 @@ namespace gpuPixelDoublets {
     auto firstY = 0 + 0 * 1;
     uint32_t firstX = 0;
 
-    float x[maxCellsPerHit], y[maxCellsPerHit], z[maxCellsPerHit], n[maxCellsPerHit];
-    uint16_t d[maxCellsPerHit];  // uint8_t l[maxCellsPerHit];
-    uint32_t cc[maxCellsPerHit];
+    // there is no maximum number of cells per hit: the buffers grow to the largest number of cells of a hit
+    std::vector<float> x, y, z, n;
+    std::vector<uint16_t> d;  // std::vector<uint8_t> l;
+    std::vector<uint32_t> cc;
 
     for (int idy = firstY, nt = nHits; idy < nt; idy += 1) {
-      auto const& vc = isOuterHitOfCell[idy];
-      auto s = vc.size();
+      auto const* vc = isOuterHitOfCell->begin(idy);
+      int32_t s = isOuterHitOfCell->size(idy);
       if (s < 2)
         continue;
+      if (cc.size() < uint32_t(s)) {
+        x.resize(s);
+        y.resize(s);
+        z.resize(s);
+        n.resize(s);
+        d.resize(s);
+        cc.resize(s);
+      }
       // if alligned kill one of the two.
       // in principle one could try to relax the cut (only in r-z?) for jumping-doublets
       auto const& c0 = cells[vc[0]];
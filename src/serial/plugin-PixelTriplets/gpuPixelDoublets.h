@@ -62,15 +62,13 @@ namespace gpuPixelDoublets {
   using CellTracksVector = CAConstants::CellTracksVector;
 
    void initDoublets(GPUCACell::OuterHitOfCell* isOuterHitOfCell,
-                               int nHits,
                                CellNeighborsVector* cellNeighbors,
                                CellNeighbors* cellNeighborsContainer,
                                CellTracksVector* cellTracks,
                                CellTracks* cellTracksContainer) {
     assert(isOuterHitOfCell);
     int first = 0;
-    for (int i = first; i < nHits; i++)
-      isOuterHitOfCell[i].reset();
+    cms::cuda::launchZero(isOuterHitOfCell);
 
     if (0 == first) {
       cellNeighbors->construct(CAConstants::maxNumOfActiveDoublets(), cellNeighborsContainer);
@@ -6,6 +6,12 @@
 #include <cstdint>
 #include <cstdio>
 #include <limits>
+#include <vector>
+
+#ifdef SERIAL_ENABLE_INTRA_EVENT_PARALLELISM
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+#endif
 
 #include "CUDADataFormats/TrackingRecHit2DCUDA.h"
 #include "DataFormats/approx_atan2.h"
@@ -22,6 +28,297 @@ namespace gpuPixelDoublets {
   using CellNeighborsVector = CAConstants::CellNeighborsVector;
   using CellTracksVector = CAConstants::CellTracksVector;
 
+  // ysize cuts (z in the barrel)  times 8
+  // these are used if doClusterCut is true
+  constexpr int minYsizeB1 = 36;
+  constexpr int minYsizeB2 = 28;
+  constexpr int maxDYsize12 = 28;
+  constexpr int maxDYsize = 20;
+  constexpr int maxDYPred = 20;
+  constexpr float dzdrFact = 8 * 0.0285 / 0.015;  // from dz/dr to "DY"
+
+#ifdef SERIAL_ENABLE_VECTORIZED_DOUBLETS
+  constexpr bool vectorizedDoublets = true;
+#else
+  constexpr bool vectorizedDoublets = false;
+#endif
+
+  // the candidate outer hits of an inner hit, copied from the hits to be tested together against the cuts
+  constexpr int doubletTileSize = 32;
+  struct DoubletTile {
+    uint32_t hit[doubletTileSize];
+    float z[doubletTileSize];
+    float r[doubletTileSize];
+    int32_t iphi[doubletTileSize];
+    int32_t sizeY[doubletTileSize];
+    int32_t detector[doubletTileSize];
+    uint8_t ok[doubletTileSize];
+  };
+
+  // the cuts of the doublets of an inner hit, the same for all its candidates
+  struct DoubletCuts {
+    float z;  // of the inner hit
+    float r;
+    int32_t iphi;
+    int32_t sizeY;
+    float maxdr;
+    int32_t iphicut;
+    int32_t maxDY;  // on the difference of size
+    bool doZ0Cut;
+    bool doPtCut;
+    bool sizeCut;  // on the difference of size in the barrel
+    bool predCut;  // on the size predicted from the direction in the endcap
+  };
+
+  // all the cuts are evaluated for the first n candidates of the tile in a loop without branches, with the same
+  // operations as the scalar loop of doubletsFromHit, and ok is set for those that pass; the division of the size
+  // prediction is only done if predCut is set
+  template <bool predCut>
+  inline void testDoubletTile(DoubletTile& __restrict__ tile, int n, DoubletCuts const cuts) {
+    constexpr float z0cut = 12.f;      // cm
+    constexpr float hardPtCut = 0.5f;  // GeV
+    constexpr float minRadius = hardPtCut * 87.78f;
+    constexpr float minRadius2T4 = 4.f * minRadius * minRadius;
+    constexpr float maxPred = 1.e6f;  // protects the conversion to int, far above any cluster size
+    auto const mez = cuts.z;
+    auto const mer = cuts.r;
+    auto const mep = cuts.iphi;
+    auto const mes = cuts.sizeY;
+    auto const maxdr = cuts.maxdr;
+    auto const iphicut = cuts.iphicut;
+    auto const dy = cuts.maxDY;
+    bool const doZ0Cut = cuts.doZ0Cut;
+    bool const doPtCut = cuts.doPtCut;
+    bool const sizeCut = cuts.sizeCut;
+    for (int k = 0; k < n; ++k) {
+      auto zo = tile.z[k];
+      auto ro = tile.r[k];
+      auto dr = ro - mer;
+      bool z0Fail = (dr > maxdr) | (dr < 0) | (std::abs((mez * ro - mer * zo)) > z0cut * dr);
+      int idphi = std::min(std::abs(int(int16_t(tile.iphi[k] - mep))), std::abs(int(int16_t(mep - tile.iphi[k]))));
+      bool phiFail = idphi > iphicut;
+      auto so = tile.sizeY[k];
+      bool sizeFail = (so > 0) & (std::abs(so - mes) > dy);
+      bool predFail = false;
+      if constexpr (predCut) {
+        auto pred = std::min(maxPred, std::abs((mez - zo) / (mer - ro)) * dzdrFact + 0.5f);
+        predFail = std::abs(mes - int(pred)) > maxDYPred;
+      }
+      auto dphi = short2phi(int16_t(idphi));
+      bool ptFail = dphi * dphi * (minRadius2T4 - mer * ro) > (ro - mer) * (ro - mer);
+      bool fail = (tile.detector[k] > 2000) | (doZ0Cut & z0Fail) | phiFail | (sizeCut & sizeFail) | predFail |
+                  (doPtCut & ptFail);
+      tile.ok[k] = not fail;
+    }
+  }
+
+  // the doublets of the inner hit i with the outer layer of the layer pair pairLayerId: add(oi) is called for each
+  // outer hit oi that passes all the cuts, in the order of the phi bins, and returns false when no more doublets can
+  // be added. If vectorized, the candidates are tested by tiles of doubletTileSize in a loop without branches, with
+  // the same results.
+  template <bool vectorized = vectorizedDoublets, typename Add>
+  inline void doubletsFromHit(uint8_t const* __restrict__ layerPairs,
+                              uint32_t pairLayerId,
+                              uint32_t i,
+                              TrackingRecHit2DSOAView const& __restrict__ hh,
+                              int16_t const* __restrict__ phicuts,
+                              float const* __restrict__ minz,
+                              float const* __restrict__ maxz,
+                              float const* __restrict__ maxr,
+                              bool ideal_cond,
+                              bool doClusterCut,
+                              bool doZ0Cut,
+                              bool doPtCut,
+                              Add&& add) {
+    bool isOuterLadder = ideal_cond;
+
+    using Hist = TrackingRecHit2DSOAView::Hist;
+
+    auto const& __restrict__ hist = hh.phiBinner();
+    uint32_t const* __restrict__ offsets = hh.hitsLayerStart();
+
+    uint32_t first = 0;
+    auto stride = 1;
+
+    uint8_t inner = layerPairs[2 * pairLayerId];
+    uint8_t outer = layerPairs[2 * pairLayerId + 1];
+    assert(outer > inner);
+
+    auto hoff = Hist::histOff(outer);
+
+    assert(i >= offsets[inner]);
+    assert(i < offsets[inner + 1]);
+
+    auto mi = hh.detectorIndex(i);
+    if (mi > 2000)
+      return;  // invalid
+
+    /* maybe clever, not effective when zoCut is on
+    auto bpos = (mi%8)/4;  // if barrel is 1 for z>0
+    auto fpos = (outer>3) & (outer<7);
+    if ( ((inner<3) & (outer>3)) && bpos!=fpos) continue;
+    */
+
+    auto mez = hh.zGlobal(i);
+
+    if (mez < minz[pairLayerId] || mez > maxz[pairLayerId])
+      return;
+
+    int16_t mes = -1;  // make compiler happy
+    if (doClusterCut) {
+      // if ideal treat inner ladder as outer
+      if (inner == 0)
+        assert(mi < 96);
+      isOuterLadder = ideal_cond ? true : 0 == (mi / 8) % 2;  // only for B1/B2/B3 B4 is opposite, FPIX:noclue...
+
+      // in any case we always test mes>0 ...
+      mes = inner > 0 || isOuterLadder ? hh.clusterSizeY(i) : -1;
+
+      if (inner == 0 && outer > 3)  // B1 and F1
+        if (mes > 0 && mes < minYsizeB1)
+          return;  // only long cluster  (5*8)
+      if (inner == 1 && outer > 3)  // B2 and F1
+        if (mes > 0 && mes < minYsizeB2)
+          return;
+    }
+    auto mep = hh.iphi(i);
+    auto mer = hh.rGlobal(i);
+
+    // all cuts: true if fails
+    constexpr float z0cut = 12.f;      // cm
+    constexpr float hardPtCut = 0.5f;  // GeV
+    constexpr float minRadius =
+        hardPtCut * 87.78f;  // cm (1 GeV track has 1 GeV/c / (e * 3.8T) ~ 87 cm radius in a 3.8T field)
+    constexpr float minRadius2T4 = 4.f * minRadius * minRadius;
+    auto ptcut = [&](int j, int16_t idphi) {
+      auto r2t4 = minRadius2T4;
+      auto ri = mer;
+      auto ro = hh.rGlobal(j);
+      auto dphi = short2phi(idphi);
+      return dphi * dphi * (r2t4 - ri * ro) > (ro - ri) * (ro - ri);
+    };
+    auto z0cutoff = [&](int j) {
+      auto zo = hh.zGlobal(j);
+      auto ro = hh.rGlobal(j);
+      auto dr = ro - mer;
+      return dr > maxr[pairLayerId] || dr < 0 || std::abs((mez * ro - mer * zo)) > z0cut * dr;
+    };
+
+    auto zsizeCut = [&](int j) {
+      auto onlyBarrel = outer < 4;
+      auto so = hh.clusterSizeY(j);
+      auto dy = inner == 0 ? maxDYsize12 : maxDYsize;
+      // in the barrel cut on difference in size
+      // in the endcap on the prediction on the first layer (actually in the barrel only: happen to be safe for endcap as well)
+      // FIXME move pred cut to z0cutoff to optmize loading of and computaiton ...
+      auto zo = hh.zGlobal(j);
+      auto ro = hh.rGlobal(j);
+      return onlyBarrel ? mes > 0 && so > 0 && std::abs(so - mes) > dy
+                        : (inner < 4) && mes > 0 &&
+                              std::abs(mes - int(std::abs((mez - zo) / (mer - ro)) * dzdrFact + 0.5f)) > maxDYPred;
+    };
+
+    auto iphicut = phicuts[pairLayerId];
+
+    auto kl = Hist::bin(int16_t(mep - iphicut));
+    auto kh = Hist::bin(int16_t(mep + iphicut));
+    auto incr = [](auto& k) { return k = (k + 1) % Hist::nbins(); };
+    // bool piWrap = std::abs(kh-kl) > Hist::nbins()/2;
+
+    auto khh = kh;
+    incr(khh);
+    if constexpr (vectorized) {
+      DoubletTile tile;
+      DoubletCuts const cuts{mez,
+                             mer,
+                             mep,
+                             mes,
+                             maxr[pairLayerId],
+                             iphicut,
+                             inner == 0 ? maxDYsize12 : maxDYsize,
+                             doZ0Cut,
+                             doPtCut,
+                             doClusterCut && outer < 4 && mes > 0,
+                             doClusterCut && outer >= 4 && inner < 4 && mes > 0};
+      auto testTile = [&](int n) {
+        if (cuts.predCut)
+          testDoubletTile<true>(tile, n, cuts);
+        else
+          testDoubletTile<false>(tile, n, cuts);
+        for (int k = 0; k < n; ++k) {
+          if (tile.ok[k] and not add(tile.hit[k]))
+            return false;
+        }
+        return true;
+      };
+
+      int n = 0;
+      for (auto kk = kl; kk != khh; incr(kk)) {
+        for (auto const* __restrict__ p = hist.begin(kk + hoff); p < hist.end(kk + hoff); ++p) {
+          auto oi = *p;
+          assert(oi >= offsets[outer]);
+          assert(oi < offsets[outer + 1]);
+          tile.hit[n] = oi;
+          tile.z[n] = hh.zGlobal(oi);
+          tile.r[n] = hh.rGlobal(oi);
+          tile.iphi[n] = hh.iphi(oi);
+          tile.sizeY[n] = hh.clusterSizeY(oi);
+          tile.detector[n] = hh.detectorIndex(oi);
+          if (++n == doubletTileSize) {
+            if (not testTile(n))
+              return;
+            n = 0;
+          }
+        }
+      }
+      testTile(n);
+      return;
+    }
+
+    for (auto kk = kl; kk != khh; incr(kk)) {
+      auto const* __restrict__ p = hist.begin(kk + hoff);
+      auto const* __restrict__ e = hist.end(kk + hoff);
+      p += first;
+      for (; p < e; p += stride) {
+        auto oi = *(p);
+        assert(oi >= offsets[outer]);
+        assert(oi < offsets[outer + 1]);
+        auto mo = hh.detectorIndex(oi);
+        if (mo > 2000)
+          continue;  //    invalid
+
+        if (doZ0Cut && z0cutoff(oi))
+          continue;
+
+        auto mop = hh.iphi(oi);
+        uint16_t idphi = std::min(std::abs(int16_t(mop - mep)), std::abs(int16_t(mep - mop)));
+        if (idphi > iphicut)
+          continue;
+
+        if (doClusterCut && zsizeCut(oi))
+          continue;
+        if (doPtCut && ptcut(oi, idphi))
+          continue;
+
+        if (not add(oi))
+          break;
+      }
+    }
+  }
+
+  // the cells ending on each hit, in the order of the cells: the cells are counted, and then filled backwards, because
+  // fillDirect fills each hit from the end of its list
+  inline void fillOuterHitOfCell(GPUCACell const* __restrict__ cells,
+                                 uint32_t nCells,
+                                 GPUCACell::OuterHitOfCell* __restrict__ isOuterHitOfCell) {
+    assert(nCells <= GPUCACell::OuterHitOfCell::capacity());
+    for (uint32_t i = 0; i < nCells; ++i)
+      isOuterHitOfCell->countDirect(cells[i].get_outer_hit_id());
+    isOuterHitOfCell->finalize();
+    for (auto i = nCells; i > 0; --i)
+      isOuterHitOfCell->fillDirect(cells[i - 1].get_outer_hit_id(), i - 1);
+  }
+
   void doubletsFromHisto(uint8_t const* __restrict__ layerPairs,
                          uint32_t nPairs,
                          GPUCACell* cells,
@@ -39,30 +336,121 @@ namespace gpuPixelDoublets {
                          bool doZ0Cut,
                          bool doPtCut,
                          uint32_t maxNumOfDoublets) {
-    // ysize cuts (z in the barrel)  times 8
-    // these are used if doClusterCut is true
-    constexpr int minYsizeB1 = 36;
-    constexpr int minYsizeB2 = 28;
-    constexpr int maxDYsize12 = 28;
-    constexpr int maxDYsize = 20;
-    constexpr int maxDYPred = 20;
-    constexpr float dzdrFact = 8 * 0.0285 / 0.015;  // from dz/dr to "DY"
-
-    bool isOuterLadder = ideal_cond;
-
-    using Hist = TrackingRecHit2DSOAView::Hist;
-
-    auto const& __restrict__ hist = hh.phiBinner();
     uint32_t const* __restrict__ offsets = hh.hitsLayerStart();
     assert(offsets);
 
-    auto layerSize = [=](uint8_t li) { return offsets[li + 1] - offsets[li]; };
-
     // nPairsMax to be optimized later (originally was 64).
     // If it should be much bigger, consider using a block-wide parallel prefix scan,
     // e.g. see  https://nvlabs.github.io/cub/classcub_1_1_warp_scan.html
     const int nPairsMax = CAConstants::maxNumberOfLayerPairs();
     assert(nPairs <= nPairsMax);
+
+#ifdef SERIAL_ENABLE_INTRA_EVENT_PARALLELISM
+    // the inner hits of each layer pair are split in chunks, in the order in which the sequential loop visits them;
+    // the doublets of each chunk are found in parallel, then numbered with a prefix sum over the chunks, so that the
+    // cells and isOuterHitOfCell are the same as those of the sequential loop
+    constexpr uint32_t hitsPerChunk = 128;
+    struct Chunk {
+      uint32_t pairLayerId;
+      uint32_t begin;
+      uint32_t end;
+      uint32_t firstCell;  // index of the first doublet of the chunk in cells
+      std::vector<std::pair<GPUCACell::hindex_type, GPUCACell::hindex_type>> doublets;
+    };
+    std::vector<Chunk> chunks;
+    for (uint32_t pairLayerId = 0; pairLayerId < nPairs; ++pairLayerId) {
+      uint8_t inner = layerPairs[2 * pairLayerId];
+      for (auto begin = offsets[inner]; begin < offsets[inner + 1]; begin += hitsPerChunk) {
+        chunks.push_back({pairLayerId, begin, std::min(begin + hitsPerChunk, offsets[inner + 1]), 0, {}});
+      }
+    }
+
+    // the chunks are processed in waves, in the order of the sequential loop, so that the search stops, as the
+    // sequential loop does, once the limit on the number of doublets is reached; the doublets beyond it are dropped
+    constexpr size_t chunksPerWave = 64;
+    auto nTotal = *nCells;
+    size_t nChunks = 0;
+    while (nChunks < chunks.size() and nTotal < maxNumOfDoublets) {
+      auto const waveEnd = std::min(nChunks + chunksPerWave, chunks.size());
+      size_t const budget = maxNumOfDoublets - nTotal;  // the most doublets that any chunk of the wave can keep
+      tbb::parallel_for(tbb::blocked_range<size_t>(nChunks, waveEnd), [&](tbb::blocked_range<size_t> const& range) {
+        for (auto ic = range.begin(); ic < range.end(); ++ic) {
+          auto& chunk = chunks[ic];
+          for (auto i = chunk.begin; i < chunk.end and chunk.doublets.size() < budget; ++i) {
+            doubletsFromHit(layerPairs,
+                            chunk.pairLayerId,
+                            i,
+                            hh,
+                            phicuts,
+                            minz,
+                            maxz,
+                            maxr,
+                            ideal_cond,
+                            doClusterCut,
+                            doZ0Cut,
+                            doPtCut,
+                            [&](uint32_t oi) {
+                              if (chunk.doublets.size() >= budget)
+                                return false;
+                              chunk.doublets.emplace_back(i, oi);
+                              return true;
+                            });
+          }
+        }
+      });
+
+      for (; nChunks < waveEnd; ++nChunks) {
+        auto& chunk = chunks[nChunks];
+        chunk.firstCell = nTotal;
+        auto n = std::min<uint32_t>(chunk.doublets.size(), std::max(nTotal, maxNumOfDoublets) - nTotal);
+        chunk.doublets.resize(n);
+        nTotal += n;
+      }
+    }
+    chunks.resize(nChunks);
+    *nCells = nTotal;
+
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, chunks.size()), [&](tbb::blocked_range<size_t> const& range) {
+      for (auto ic = range.begin(); ic < range.end(); ++ic) {
+        auto const& chunk = chunks[ic];
+        for (uint32_t k = 0; k < chunk.doublets.size(); ++k) {
+          auto ind = chunk.firstCell + k;
+          // int layerPairId, int doubletId, int innerHitId, int outerHitId)
+          cells[ind].init(*cellNeighbors,
+                          *cellTracks,
+                          hh,
+                          chunk.pairLayerId,
+                          ind,
+                          chunk.doublets[k].first,
+                          chunk.doublets[k].second);
+        }
+      }
+    });
+
+    // the outer hits of the doublets of different layers are distinct: the cells are counted in parallel, and each
+    // outer layer then fills its part of isOuterHitOfCell from its doublets, backwards as in fillOuterHitOfCell
+    tbb::parallel_for(tbb::blocked_range<size_t>(0, chunks.size()), [&](tbb::blocked_range<size_t> const& range) {
+      for (auto ic = range.begin(); ic < range.end(); ++ic) {
+        for (auto const& doublet : chunks[ic].doublets)
+          isOuterHitOfCell->countDirect(doublet.second);
+      }
+    });
+    isOuterHitOfCell->finalize();
+    tbb::parallel_for(tbb::blocked_range<uint32_t>(0, CAConstants::maxNumberOfLayers()),
+                      [&](tbb::blocked_range<uint32_t> const& range) {
+                        for (auto layer = range.begin(); layer < range.end(); ++layer) {
+                          for (auto chunk = chunks.rbegin(); chunk != chunks.rend(); ++chunk) {
+                            if (layerPairs[2 * chunk->pairLayerId + 1] != layer)
+                              continue;
+                            for (auto k = chunk->doublets.size(); k > 0; --k) {
+                              isOuterHitOfCell->fillDirect(chunk->doublets[k - 1].second, chunk->firstCell + k - 1);
+                            }
+                          }
+                        }
+                      });
+#else
+    auto layerSize = [=](uint8_t li) { return offsets[li + 1] - offsets[li]; };
+
     uint32_t innerLayerCumulativeSize[nPairsMax];
     uint32_t ntot;
 
@@ -74,8 +462,6 @@ namespace gpuPixelDoublets {
 
     // x runs faster
     auto idy = 0;
-    uint32_t first = 0;
-    auto stride = 1;
 
     uint32_t pairLayerId = 0;  // cannot go backward
     for (uint32_t j = idy; j < ntot; j += 1) {
@@ -88,153 +474,40 @@ namespace gpuPixelDoublets {
       assert(0 == pairLayerId || j >= innerLayerCumulativeSize[pairLayerId - 1]);
 
       uint8_t inner = layerPairs[2 * pairLayerId];
-      uint8_t outer = layerPairs[2 * pairLayerId + 1];
-      assert(outer > inner);
-
-      auto hoff = Hist::histOff(outer);
 
       auto i = (0 == pairLayerId) ? j : j - innerLayerCumulativeSize[pairLayerId - 1];
       i += offsets[inner];
 
       // printf("Hit in Layer %d %d %d %d\n", i, inner, pairLayerId, j);
 
-      assert(i >= offsets[inner]);
-      assert(i < offsets[inner + 1]);
-
       // found hit corresponding to our cuda thread, now do the job
-      auto mi = hh.detectorIndex(i);
-      if (mi > 2000)
-        continue;  // invalid
-
-      /* maybe clever, not effective when zoCut is on
-      auto bpos = (mi%8)/4;  // if barrel is 1 for z>0
-      auto fpos = (outer>3) & (outer<7);
-      if ( ((inner<3) & (outer>3)) && bpos!=fpos) continue;
-      */
-
-      auto mez = hh.zGlobal(i);
-
-      if (mez < minz[pairLayerId] || mez > maxz[pairLayerId])
-        continue;
-
-      int16_t mes = -1;  // make compiler happy
-      if (doClusterCut) {
-        // if ideal treat inner ladder as outer
-        if (inner == 0)
-          assert(mi < 96);
-        isOuterLadder = ideal_cond ? true : 0 == (mi / 8) % 2;  // only for B1/B2/B3 B4 is opposite, FPIX:noclue...
-
-        // in any case we always test mes>0 ...
-        mes = inner > 0 || isOuterLadder ? hh.clusterSizeY(i) : -1;
-
-        if (inner == 0 && outer > 3)  // B1 and F1
-          if (mes > 0 && mes < minYsizeB1)
-            continue;                 // only long cluster  (5*8)
-        if (inner == 1 && outer > 3)  // B2 and F1
-          if (mes > 0 && mes < minYsizeB2)
-            continue;
-      }
-      auto mep = hh.iphi(i);
-      auto mer = hh.rGlobal(i);
-
-      // all cuts: true if fails
-      constexpr float z0cut = 12.f;      // cm
-      constexpr float hardPtCut = 0.5f;  // GeV
-      constexpr float minRadius =
-          hardPtCut * 87.78f;  // cm (1 GeV track has 1 GeV/c / (e * 3.8T) ~ 87 cm radius in a 3.8T field)
-      constexpr float minRadius2T4 = 4.f * minRadius * minRadius;
-      auto ptcut = [&](int j, int16_t idphi) {
-        auto r2t4 = minRadius2T4;
-        auto ri = mer;
-        auto ro = hh.rGlobal(j);
-        auto dphi = short2phi(idphi);
-        return dphi * dphi * (r2t4 - ri * ro) > (ro - ri) * (ro - ri);
-      };
-      auto z0cutoff = [&](int j) {
-        auto zo = hh.zGlobal(j);
-        auto ro = hh.rGlobal(j);
-        auto dr = ro - mer;
-        return dr > maxr[pairLayerId] || dr < 0 || std::abs((mez * ro - mer * zo)) > z0cut * dr;
-      };
-
-      auto zsizeCut = [&](int j) {
-        auto onlyBarrel = outer < 4;
-        auto so = hh.clusterSizeY(j);
-        auto dy = inner == 0 ? maxDYsize12 : maxDYsize;
-        // in the barrel cut on difference in size
-        // in the endcap on the prediction on the first layer (actually in the barrel only: happen to be safe for endcap as well)
-        // FIXME move pred cut to z0cutoff to optmize loading of and computaiton ...
-        auto zo = hh.zGlobal(j);
-        auto ro = hh.rGlobal(j);
-        return onlyBarrel ? mes > 0 && so > 0 && std::abs(so - mes) > dy
-                          : (inner < 4) && mes > 0 &&
-                                std::abs(mes - int(std::abs((mez - zo) / (mer - ro)) * dzdrFact + 0.5f)) > maxDYPred;
-      };
-
-      auto iphicut = phicuts[pairLayerId];
-
-      auto kl = Hist::bin(int16_t(mep - iphicut));
-      auto kh = Hist::bin(int16_t(mep + iphicut));
-      auto incr = [](auto& k) { return k = (k + 1) % Hist::nbins(); };
-      // bool piWrap = std::abs(kh-kl) > Hist::nbins()/2;
-
-#ifdef GPU_DEBUG
-      int tot = 0;
-      int nmin = 0;
-      int tooMany = 0;
-#endif
+      doubletsFromHit(
+          layerPairs,
+          pairLayerId,
+          i,
+          hh,
+          phicuts,
+          minz,
+          maxz,
+          maxr,
+          ideal_cond,
+          doClusterCut,
+          doZ0Cut,
+          doPtCut,
+          [&](uint32_t oi) {
+            auto ind = atomicAdd(nCells, 1);
+            if (ind >= maxNumOfDoublets) {
+              atomicSub(nCells, 1);
+              return false;
+            }  // move to SimpleVector??
+            // int layerPairId, int doubletId, int innerHitId, int outerHitId)
+            cells[ind].init(*cellNeighbors, *cellTracks, hh, pairLayerId, ind, i, oi);
+            return true;
+          });
+    }  // loop in block...
 
-      auto khh = kh;
-      incr(khh);
-      for (auto kk = kl; kk != khh; incr(kk)) {
-#ifdef GPU_DEBUG
-        if (kk != kl && kk != kh)
-          nmin += hist.size(kk + hoff);
+    fillOuterHitOfCell(cells, *nCells, isOuterHitOfCell);
 #endif
-        auto const* __restrict__ p = hist.begin(kk + hoff);
-        auto const* __restrict__ e = hist.end(kk + hoff);
-        p += first;
-        for (; p < e; p += stride) {
-          auto oi = *(p);
-          assert(oi >= offsets[outer]);
-          assert(oi < offsets[outer + 1]);
-          auto mo = hh.detectorIndex(oi);
-          if (mo > 2000)
-            continue;  //    invalid
-
-          if (doZ0Cut && z0cutoff(oi))
-            continue;
-
-          auto mop = hh.iphi(oi);
-          uint16_t idphi = std::min(std::abs(int16_t(mop - mep)), std::abs(int16_t(mep - mop)));
-          if (idphi > iphicut)
-            continue;
-
-          if (doClusterCut && zsizeCut(oi))
-            continue;
-          if (doPtCut && ptcut(oi, idphi))
-            continue;
-
-          auto ind = atomicAdd(nCells, 1);
-          if (ind >= maxNumOfDoublets) {
-            atomicSub(nCells, 1);
-            break;
-          }  // move to SimpleVector??
-          // int layerPairId, int doubletId, int innerHitId, int outerHitId)
-          cells[ind].init(*cellNeighbors, *cellTracks, hh, pairLayerId, ind, i, oi);
-          isOuterHitOfCell[oi].push_back(ind);
-#ifdef GPU_DEBUG
-          if (isOuterHitOfCell[oi].full())
-            ++tooMany;
-          ++tot;
-#endif
-        }
-      }
-#ifdef GPU_DEBUG
-      if (tooMany > 0)
-        printf("OuterHitOfCell full for %d in layer %d/%d, %d,%d %d\n", i, inner, outer, nmin, tot, tooMany);
-#endif
-    }  // loop in block...
   }
 
 }  // namespace gpuPixelDoublets
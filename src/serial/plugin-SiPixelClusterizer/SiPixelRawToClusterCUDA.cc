@@ -6,8 +6,8 @@
 #include "CondFormats/SiPixelFedIds.h"
 #include "DataFormats/PixelErrors.h"
 #include "DataFormats/FEDNumbering.h"
-#include "DataFormats/FEDRawData.h"
-#include "DataFormats/FEDRawDataCollection.h"
+#include "DataFormats/FEDRawDataCollectionView.h"
+#include "DataFormats/FEDRawDataView.h"
 #include "Framework/EventSetup.h"
 #include "Framework/Event.h"
 #include "Framework/PluginFactory.h"
@@ -16,6 +16,7 @@
 #include "ErrorChecker.h"
 #include "SiPixelRawToClusterGPUKernel.h"
 
+#include <iostream>
 #include <memory>
 #include <string>
 #include <vector>
@@ -27,9 +28,10 @@ public:
 
 private:
   void produce(edm::Event& iEvent, const edm::EventSetup& iSetup) override;
+  void endJob() override;
 
 
-  edm::EDGetTokenT<FEDRawDataCollection> rawGetToken_;
+  edm::EDGetTokenT<FEDRawDataCollectionView> rawGetToken_;
   edm::EDPutTokenT<SiPixelDigisSoA> digiPutToken_;
   edm::EDPutTokenT<SiPixelDigiErrorsSoA> digiErrorPutToken_;
   edm::EDPutTokenT<SiPixelClustersSoA> clusterPutToken_;
@@ -41,10 +43,13 @@ private:
   const bool isRun2_;
   const bool includeErrors_;
   const bool useQuality_;
+
+  uint64_t nBadPixels_ = 0;
+  uint64_t nEvents_ = 0;
 };
 
 SiPixelRawToClusterCUDA::SiPixelRawToClusterCUDA(edm::ProductRegistry& reg)
-    : rawGetToken_(reg.consumes<FEDRawDataCollection>()),
+    : rawGetToken_(reg.consumes<FEDRawDataCollectionView>()),
       digiPutToken_(reg.produces<SiPixelDigisSoA>()),
       clusterPutToken_(reg.produces<SiPixelClustersSoA>()),
       isRun2_(true),
@@ -65,17 +70,19 @@ void SiPixelRawToClusterCUDA::produce(edm::Event& iEvent, const edm::EventSetup&
   }
   // get the GPU product already here so that the async transfer can begin
   const auto* gpuMap = hgpuMap.getCPUProduct();
-  const unsigned char* gpuModulesToUnpack = hgpuMap.getModToUnpAll();
+  const auto* rocFrames = hgpuMap.getROCFrames();
 
   auto const& hgains = iSetup.get<SiPixelGainCalibrationForHLTGPU>();
   // get the GPU product already here so that the async transfer can begin
   const auto* gpuGains = hgains.getCPUProduct();
+  const auto* gainTable = hgains.getCPUTable();
 
   auto const& fedIds_ = iSetup.get<SiPixelFedIds>().fedIds();
 
   const auto& buffers = iEvent.get(rawGetToken_);
 
   errors_.clear();
+  wordFedAppender_->clear();
 
   // GPU specific: Data extraction for RawToDigi GPU
   unsigned int wordCounterGPU = 0;
@@ -95,7 +102,7 @@ void SiPixelRawToClusterCUDA::produce(edm::Event& iEvent, const edm::EventSetup&
     fedCounter++;
 
     // get event data for this fed
-    const FEDRawData& rawData = buffers.FEDData(fedId);
+    const FEDRawDataView rawData = buffers.FEDData(fedId);
 
     // GPU specific
     int nWords = rawData.size() / sizeof(uint64_t);
@@ -139,8 +146,9 @@ void SiPixelRawToClusterCUDA::produce(edm::Event& iEvent, const edm::EventSetup&
 
   gpuAlgo_.makeClusters(isRun2_,
                         gpuMap,
-                        gpuModulesToUnpack,
+                        rocFrames,
                         gpuGains,
+                        gainTable,
                         *wordFedAppender_,
                         std::move(errors_),
                         wordCounterGPU,
@@ -149,6 +157,9 @@ void SiPixelRawToClusterCUDA::produce(edm::Event& iEvent, const edm::EventSetup&
                         includeErrors_,
                         false);  // debug
 
+  nBadPixels_ += gpuAlgo_.nBadPixels();
+  ++nEvents_;
+
   auto tmp = gpuAlgo_.getResults();
   iEvent.emplace(digiPutToken_, std::move(tmp.first));
   iEvent.emplace(clusterPutToken_, std::move(tmp.second));
@@ -157,5 +168,17 @@ void SiPixelRawToClusterCUDA::produce(edm::Event& iEvent, const edm::EventSetup&
   }
 }
 
+void SiPixelRawToClusterCUDA::endJob() {
+  if (nBadPixels_ > 0) {
+    std::cout << "SiPixelRawToClusterCUDA: " << nBadPixels_ << " pixels in dead or noisy columns were masked in "
+              << nEvents_ << " events" << std::endl;
+  }
+  if (nEvents_ > 0) {
+    auto const& pool = gpuAlgo_.bufferPool();
+    std::cout << "SiPixelRawToClusterCUDA: the digis, errors and clusters used " << pool.bytesRequested() / nEvents_
+              << " bytes per event, of which " << pool.bytesAllocated() / nEvents_ << " newly allocated" << std::endl;
+  }
+}
+
 // define as framework plugin
 DEFINE_FWK_MODULE(SiPixelRawToClusterCUDA);
@@ -7,6 +7,8 @@
 **/
 
 // C++ includes
+#include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <chrono>
 #include <cstdio>
@@ -15,7 +17,14 @@
 #include <fstream>
 #include <iomanip>
 #include <iostream>
+#include <stdexcept>
 #include <string>
+#include <vector>
+
+#ifdef SERIAL_ENABLE_INTRA_EVENT_PARALLELISM
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+#endif
 
 // CMSSW includes
 #include "CUDACore/cudaCompat.h"
@@ -27,23 +36,28 @@
 #include "gpuCalibPixel.h"
 #include "gpuClusterChargeCut.h"
 #include "gpuClustering.h"
+#ifdef SERIAL_ENABLE_UNION_FIND_CLUSTERING
+#include "cpuClustering.h"
+#endif
+
+// the fused pass relies on the vectorised calibration of the digis in any range
+#if not defined(SERIAL_DISABLE_FUSED_RAWTODIGI) and not defined(SERIAL_DISABLE_VECTORIZED_CALIBRATION)
+#define SERIAL_FUSED_RAWTODIGI
+#endif
 
 namespace pixelgpudetails {
 
   // number of words for all the FEDs
   constexpr uint32_t MAX_FED_WORDS = pixelgpudetails::MAX_FED * pixelgpudetails::MAX_WORD;
 
-  SiPixelRawToClusterGPUKernel::WordFedAppender::WordFedAppender() {
-    word_ = std::make_unique<unsigned int[]>(MAX_FED_WORDS);
-    fedId_ = std::make_unique<unsigned char[]>(MAX_FED_WORDS);
-  }
+  SiPixelRawToClusterGPUKernel::WordFedAppender::WordFedAppender() { feds_.reserve(pixelgpudetails::MAX_FED); }
 
   void SiPixelRawToClusterGPUKernel::WordFedAppender::initializeWordFed(int fedId,
                                                                         unsigned int wordCounterGPU,
                                                                         const uint32_t *src,
                                                                         unsigned int length) {
-    std::memcpy(word_.get() + wordCounterGPU, src, sizeof(uint32_t) * length);
-    std::memset(fedId_.get() + wordCounterGPU / 2, fedId - 1200, length / 2);
+    assert(feds_.empty() or feds_.back().begin + feds_.back().length == wordCounterGPU);
+    feds_.push_back(FedWords{src, wordCounterGPU, length, static_cast<uint8_t>(fedId - 1200)});
   }
 
   ////////////////////
@@ -54,8 +68,6 @@ namespace pixelgpudetails {
 
   uint32_t getADC(uint32_t ww) { return ((ww >> pixelgpudetails::ADC_shift) & pixelgpudetails::ADC_mask); }
 
-  bool isBarrel(uint32_t rawId) { return (1 == ((rawId >> 25) & 0x7)); }
-
   pixelgpudetails::DetIdGPU getRawId(const SiPixelFedCablingMapGPU *cablingMap,
                                      uint8_t fed,
                                      uint32_t link,
@@ -68,71 +80,12 @@ namespace pixelgpudetails {
 
   //reference http://cmsdoxygen.web.cern.ch/cmsdoxygen/CMSSW_9_2_0/doc/html/dd/d31/FrameConversion_8cc_source.html
   //http://cmslxr.fnal.gov/source/CondFormats/SiPixelObjects/src/PixelROC.cc?v=CMSSW_9_2_0#0071
-  // Convert local pixel to pixelgpudetails::global pixel
-  pixelgpudetails::Pixel frameConversion(
-      bool bpix, int side, uint32_t layer, uint32_t rocIdInDetUnit, pixelgpudetails::Pixel local) {
-    int slopeRow = 0, slopeCol = 0;
-    int rowOffset = 0, colOffset = 0;
-
-    if (bpix) {
-      if (side == -1 && layer != 1) {  // -Z side: 4 non-flipped modules oriented like 'dddd', except Layer 1
-        if (rocIdInDetUnit < 8) {
-          slopeRow = 1;
-          slopeCol = -1;
-          rowOffset = 0;
-          colOffset = (8 - rocIdInDetUnit) * pixelgpudetails::numColsInRoc - 1;
-        } else {
-          slopeRow = -1;
-          slopeCol = 1;
-          rowOffset = 2 * pixelgpudetails::numRowsInRoc - 1;
-          colOffset = (rocIdInDetUnit - 8) * pixelgpudetails::numColsInRoc;
-        }       // if roc
-      } else {  // +Z side: 4 non-flipped modules oriented like 'pppp', but all 8 in layer1
-        if (rocIdInDetUnit < 8) {
-          slopeRow = -1;
-          slopeCol = 1;
-          rowOffset = 2 * pixelgpudetails::numRowsInRoc - 1;
-          colOffset = rocIdInDetUnit * pixelgpudetails::numColsInRoc;
-        } else {
-          slopeRow = 1;
-          slopeCol = -1;
-          rowOffset = 0;
-          colOffset = (16 - rocIdInDetUnit) * pixelgpudetails::numColsInRoc - 1;
-        }
-      }
-
-    } else {             // fpix
-      if (side == -1) {  // pannel 1
-        if (rocIdInDetUnit < 8) {
-          slopeRow = 1;
-          slopeCol = -1;
-          rowOffset = 0;
-          colOffset = (8 - rocIdInDetUnit) * pixelgpudetails::numColsInRoc - 1;
-        } else {
-          slopeRow = -1;
-          slopeCol = 1;
-          rowOffset = 2 * pixelgpudetails::numRowsInRoc - 1;
-          colOffset = (rocIdInDetUnit - 8) * pixelgpudetails::numColsInRoc;
-        }
-      } else {  // pannel 2
-        if (rocIdInDetUnit < 8) {
-          slopeRow = 1;
-          slopeCol = -1;
-          rowOffset = 0;
-          colOffset = (8 - rocIdInDetUnit) * pixelgpudetails::numColsInRoc - 1;
-        } else {
-          slopeRow = -1;
-          slopeCol = 1;
-          rowOffset = 2 * pixelgpudetails::numRowsInRoc - 1;
-          colOffset = (rocIdInDetUnit - 8) * pixelgpudetails::numColsInRoc;
-        }
-
-      }  // side
-    }
-
-    uint32_t gRow = rowOffset + slopeRow * local.row;
-    uint32_t gCol = colOffset + slopeCol * local.col;
-    //printf("Inside frameConversion row: %u, column: %u\n", gRow, gCol);
+  // Convert local pixel to pixelgpudetails::global pixel, with the orientation and offset of the ROC precomputed in
+  // SiPixelFedCablingMapGPUWrapper
+  pixelgpudetails::Pixel frameConversion(SiPixelROCFrameGPU const &frame, pixelgpudetails::Pixel local) {
+    bool flipped = frame.flags & pixelgpudetails::ROC_FLIPPED;
+    uint32_t gRow = flipped ? 2 * pixelgpudetails::numRowsInRoc - 1 - local.row : local.row;
+    uint32_t gCol = flipped ? frame.colOffset + local.col : frame.colOffset - local.col;
     pixelgpudetails::Pixel global = {gRow, gCol};
     return global;
   }
@@ -338,12 +291,107 @@ namespace pixelgpudetails {
     return rID;
   }
 
+#ifndef SERIAL_DISABLE_VECTORIZED_RAWTODIGI
+  // number of words decoded together by decodeBlock()
+  constexpr uint32_t decodeBlockSize = 16;
+
+  // Decodes decodeBlockSize words like RawToDigi_kernel, with loops without branches that the compiler vectorises,
+  // using gathers for the ROC records; the clones for AVX2 and AVX-512 are selected at run time.
+  // The words that are not data words of a valid ROC, or that would produce an error, are left to the scalar
+  // code: the corresponding bits are set in the returned mask.
+  __attribute__((target_clones("avx512f", "avx2", "default"))) uint32_t decodeBlock(
+      const SiPixelROCFramesGPU *__restrict__ rocFrames,
+      uint8_t fedId,
+      const uint32_t *__restrict__ word,
+      uint16_t *__restrict__ xx,
+      uint16_t *__restrict__ yy,
+      uint16_t *__restrict__ adc,
+      uint32_t *__restrict__ pdigi,
+      uint32_t *__restrict__ rawIdArr,
+      uint16_t *__restrict__ moduleId,
+      bool useQualityInfo,
+      bool includeErrors) {
+    // the helper functions are not inlined in the clones for a different target, so they are spelled out here
+    uint32_t index[decodeBlockSize];
+    for (uint32_t i = 0; i < decodeBlockSize; ++i) {
+      uint32_t ww = word[i];
+      uint32_t link = (ww >> LINK_shift) & LINK_mask;
+      uint32_t roc = (ww >> ROC_shift) & ROC_mask;
+      bool valid = (ww != 0) & (link >= 1) & (link <= MAX_LINK) & (roc < maxROCIndex);
+      // the invalid words read the first record, and do not use it
+      index[i] = valid ? fedId * MAX_LINK * MAX_ROC + (link - 1) * MAX_ROC + roc : 0;
+    }
+
+    uint32_t rawIds[decodeBlockSize];
+    uint32_t modules[decodeBlockSize];
+    uint32_t colOffsets[decodeBlockSize];
+    uint32_t flags[decodeBlockSize];
+    for (uint32_t i = 0; i < decodeBlockSize; ++i) {
+      rawIds[i] = rocFrames->roc[index[i]].rawId;
+      modules[i] = rocFrames->roc[index[i]].moduleId;
+      colOffsets[i] = rocFrames->roc[index[i]].colOffset;
+      flags[i] = rocFrames->roc[index[i]].flags;
+    }
+
+    uint32_t const skipFlags = ROC_NOT_UNPACKED | (useQualityInfo ? ROC_BAD : 0);
+    uint32_t const checkPixels = includeErrors ? 1 : 0;
+    uint32_t slow[decodeBlockSize];
+    for (uint32_t i = 0; i < decodeBlockSize; ++i) {
+      uint32_t ww = word[i];
+      uint32_t link = (ww >> LINK_shift) & LINK_mask;
+      uint32_t roc = (ww >> ROC_shift) & ROC_mask;
+      bool valid = (ww != 0) & (link >= 1) & (link <= MAX_LINK) & (roc < maxROCIndex);
+      bool skip = (flags[i] & skipFlags) != 0;
+      bool layer1 = (flags[i] & ROC_LAYER1) != 0;
+      bool flipped = (flags[i] & ROC_FLIPPED) != 0;
+
+      uint32_t dcol = (ww >> DCOL_shift) & DCOL_mask;
+      uint32_t pxid = (ww >> PXID_shift) & PXID_mask;
+      uint32_t row = layer1 ? (ww >> ROW_shift) & ROW_mask : numRowsInRoc - pxid / 2;
+      uint32_t col = layer1 ? (ww >> COL_shift) & COL_mask : dcol * 2 + pxid % 2;
+      uint32_t badPixel = layer1 ? uint32_t((row >= numRowsInRoc) | (col >= numColsInRoc))
+                                 : uint32_t((dcol >= 26) | (pxid < 2) | (pxid >= 162));
+
+      uint32_t gRow = flipped ? 2 * numRowsInRoc - 1 - row : row;
+      uint32_t gCol = flipped ? colOffsets[i] + col : colOffsets[i] - col;
+      uint32_t charge = (ww >> ADC_shift) & ADC_mask;
+
+      // the words with ww == 0 and the skipped ROCs keep the default values
+      bool digi = valid & not skip;
+      xx[i] = digi ? gRow : 0;
+      yy[i] = digi ? gCol : 0;
+      adc[i] = digi ? charge : 0;
+      // as in pack(), the charge is always within the range of the packed format
+      pdigi[i] = digi ? (gRow << packing().row_shift) | (gCol << packing().column_shift) |
+                            (charge << packing().adc_shift)
+                      : 0;
+      rawIdArr[i] = digi ? rawIds[i] : 0;
+      moduleId[i] = digi ? modules[i] : 9999;
+
+      // decode again the invalid words, except the empty ones, and the pixels of the ROCs not skipped that would
+      // produce an error
+      slow[i] = valid ? uint32_t(not skip) & checkPixels & badPixel : uint32_t(ww != 0);
+    }
+
+    uint32_t mask = 0;
+    for (uint32_t i = 0; i < decodeBlockSize; ++i) {
+      mask |= slow[i] << i;
+    }
+    return mask;
+  }
+#endif
+
+  // number of words of a FED decoded before passing them to the callback of RawToDigi_kernel
+  constexpr uint32_t decodeStripeSize = 256;
+
   // Kernel to perform Raw to Digi conversion
+  // afterStripe(ifed, first, last) is called for each range of at most decodeStripeSize digis [first, last) as soon as
+  // they are decoded, in the order of the digis of each FED
+  template <typename F>
   void RawToDigi_kernel(const SiPixelFedCablingMapGPU *cablingMap,
-                        const unsigned char *modToUnp,
-                        const uint32_t wordCounter,
-                        const uint32_t *word,
-                        const uint8_t *fedIds,
+                        const SiPixelROCFramesGPU *rocFrames,
+                        const SiPixelRawToClusterGPUKernel::WordFedAppender::FedWords *feds,
+                        const uint32_t nFeds,
                         uint16_t *xx,
                         uint16_t *yy,
                         uint16_t *adc,
@@ -353,111 +401,146 @@ namespace pixelgpudetails {
                         cms::cuda::SimpleVector<PixelErrorCompact> *err,
                         bool useQualityInfo,
                         bool includeErrors,
-                        bool debug) {
-    int32_t first = 0;
-    for (int32_t iloop = first, nend = wordCounter; iloop < nend; iloop += 1) {
-      auto gIndex = iloop;
-      xx[gIndex] = 0;
-      yy[gIndex] = 0;
-      adc[gIndex] = 0;
-      bool skipROC = false;
-
-      uint8_t fedId = fedIds[gIndex / 2];  // +1200;
-
-      // initialize (too many coninue below)
-      pdigi[gIndex] = 0;
-      rawIdArr[gIndex] = 0;
-      moduleId[gIndex] = 9999;
-
-      uint32_t ww = word[gIndex];  // Array containing 32 bit raw data
-      if (ww == 0) {
-        // 0 is an indicator of a noise/dead channel, skip these pixels during clusterization
-        continue;
-      }
-
-      uint32_t link = getLink(ww);  // Extract link
-      uint32_t roc = getRoc(ww);    // Extract Roc in link
-      pixelgpudetails::DetIdGPU detId = getRawId(cablingMap, fedId, link, roc);
-
-      uint8_t errorType = checkROC(ww, fedId, link, cablingMap, debug);
-      skipROC = (roc < pixelgpudetails::maxROCIndex) ? false : (errorType != 0);
-      if (includeErrors and skipROC) {
-        uint32_t rID = getErrRawID(fedId, ww, errorType, cablingMap, debug);
-        err->push_back(PixelErrorCompact{rID, ww, errorType, fedId});
-        continue;
-      }
+                        bool debug,
+                        F &&afterStripe) {
+    // the FEDs cover contiguously the range of digi indices [0, wordCounter)
+    // the errors of the FED are appended to fedErrors
+    auto unpackFed = [&](uint32_t ifed, auto *fedErrors) {
+      uint8_t fedId = feds[ifed].fedId;  // +1200;
+      const uint32_t *word = feds[ifed].word;
+      auto decodeWord = [&](uint32_t iloop) {
+        auto gIndex = feds[ifed].begin + iloop;
+        xx[gIndex] = 0;
+        yy[gIndex] = 0;
+        adc[gIndex] = 0;
+        bool skipROC = false;
+
+        // initialize (too many return below)
+        pdigi[gIndex] = 0;
+        rawIdArr[gIndex] = 0;
+        moduleId[gIndex] = 9999;
+
+        uint32_t ww = word[iloop];  // Array containing 32 bit raw data
+        if (ww == 0) {
+          // 0 is an indicator of a noise/dead channel, skip these pixels during clusterization
+          return;
+        }
 
-      uint32_t rawId = detId.RawId;
-      uint32_t rocIdInDetUnit = detId.rocInDet;
-      bool barrel = isBarrel(rawId);
+        uint32_t link = getLink(ww);  // Extract link
+        uint32_t roc = getRoc(ww);    // Extract Roc in link
 
-      uint32_t index = fedId * MAX_LINK * MAX_ROC + (link - 1) * MAX_ROC + roc;
-      if (useQualityInfo) {
-        skipROC = cablingMap->badRocs[index];
-        if (skipROC)
-          continue;
-      }
-      skipROC = modToUnp[index];
-      if (skipROC)
-        continue;
-
-      uint32_t layer = 0;                   //, ladder =0;
-      int side = 0, panel = 0, module = 0;  //disk = 0, blade = 0
-
-      if (barrel) {
-        layer = (rawId >> pixelgpudetails::layerStartBit) & pixelgpudetails::layerMask;
-        module = (rawId >> pixelgpudetails::moduleStartBit) & pixelgpudetails::moduleMask;
-        side = (module < 5) ? -1 : 1;
-      } else {
-        // endcap ids
-        layer = 0;
-        panel = (rawId >> pixelgpudetails::panelStartBit) & pixelgpudetails::panelMask;
-        //disk  = (rawId >> diskStartBit_) & diskMask_;
-        side = (panel == 1) ? -1 : 1;
-        //blade = (rawId >> bladeStartBit_) & bladeMask_;
-      }
+        uint8_t errorType = checkROC(ww, fedId, link, cablingMap, debug);
+        skipROC = (roc < pixelgpudetails::maxROCIndex) ? false : (errorType != 0);
+        if (includeErrors and skipROC) {
+          uint32_t rID = getErrRawID(fedId, ww, errorType, cablingMap, debug);
+          fedErrors->push_back(PixelErrorCompact{rID, ww, errorType, fedId});
+          return;
+        }
 
-      // ***special case of layer to 1 be handled here
-      pixelgpudetails::Pixel localPix;
-      if (layer == 1) {
-        uint32_t col = (ww >> pixelgpudetails::COL_shift) & pixelgpudetails::COL_mask;
-        uint32_t row = (ww >> pixelgpudetails::ROW_shift) & pixelgpudetails::ROW_mask;
-        localPix.row = row;
-        localPix.col = col;
-        if (includeErrors) {
-          if (not rocRowColIsValid(row, col)) {
-            uint8_t error = conversionError(fedId, 3, debug);  //use the device function and fill the arrays
-            err->push_back(PixelErrorCompact{rawId, ww, error, fedId});
+        // everything else about the ROC comes from a single record
+        uint32_t index = fedId * MAX_LINK * MAX_ROC + (link - 1) * MAX_ROC + roc;
+        SiPixelROCFrameGPU const frame = rocFrames->roc[index];
+        uint32_t rawId = frame.rawId;
+        if (useQualityInfo and (frame.flags & pixelgpudetails::ROC_BAD))
+          return;
+        if (frame.flags & pixelgpudetails::ROC_NOT_UNPACKED)
+          return;
+
+        // ***special case of layer to 1 be handled here
+        pixelgpudetails::Pixel localPix;
+        if (frame.flags & pixelgpudetails::ROC_LAYER1) {
+          uint32_t col = (ww >> pixelgpudetails::COL_shift) & pixelgpudetails::COL_mask;
+          uint32_t row = (ww >> pixelgpudetails::ROW_shift) & pixelgpudetails::ROW_mask;
+          localPix.row = row;
+          localPix.col = col;
+          if (includeErrors) {
+            if (not rocRowColIsValid(row, col)) {
+              uint8_t error = conversionError(fedId, 3, debug);  //use the device function and fill the arrays
+              fedErrors->push_back(PixelErrorCompact{rawId, ww, error, fedId});
+              if (debug)
+                printf("BPIX1  Error status: %i\n", error);
+              return;
+            }
+          }
+        } else {
+          // ***conversion rules for dcol and pxid
+          uint32_t dcol = (ww >> pixelgpudetails::DCOL_shift) & pixelgpudetails::DCOL_mask;
+          uint32_t pxid = (ww >> pixelgpudetails::PXID_shift) & pixelgpudetails::PXID_mask;
+          uint32_t row = pixelgpudetails::numRowsInRoc - pxid / 2;
+          uint32_t col = dcol * 2 + pxid % 2;
+          localPix.row = row;
+          localPix.col = col;
+          if (includeErrors and not dcolIsValid(dcol, pxid)) {
+            uint8_t error = conversionError(fedId, 3, debug);
+            fedErrors->push_back(PixelErrorCompact{rawId, ww, error, fedId});
             if (debug)
-              printf("BPIX1  Error status: %i\n", error);
-            continue;
+              printf("Error status: %i %d %d %d %d\n", error, dcol, pxid, fedId, roc);
+            return;
           }
         }
-      } else {
-        // ***conversion rules for dcol and pxid
-        uint32_t dcol = (ww >> pixelgpudetails::DCOL_shift) & pixelgpudetails::DCOL_mask;
-        uint32_t pxid = (ww >> pixelgpudetails::PXID_shift) & pixelgpudetails::PXID_mask;
-        uint32_t row = pixelgpudetails::numRowsInRoc - pxid / 2;
-        uint32_t col = dcol * 2 + pxid % 2;
-        localPix.row = row;
-        localPix.col = col;
-        if (includeErrors and not dcolIsValid(dcol, pxid)) {
-          uint8_t error = conversionError(fedId, 3, debug);
-          err->push_back(PixelErrorCompact{rawId, ww, error, fedId});
-          if (debug)
-            printf("Error status: %i %d %d %d %d\n", error, dcol, pxid, fedId, roc);
-          continue;
+
+        pixelgpudetails::Pixel globalPix = frameConversion(frame, localPix);
+        xx[gIndex] = globalPix.row;  // origin shifting by 1 0-159
+        yy[gIndex] = globalPix.col;  // origin shifting by 1 0-415
+        adc[gIndex] = getADC(ww);
+        pdigi[gIndex] = pixelgpudetails::pack(globalPix.row, globalPix.col, adc[gIndex]);
+        moduleId[gIndex] = frame.moduleId;
+        rawIdArr[gIndex] = rawId;
+      };
+
+      uint32_t nend = feds[ifed].length;
+      for (uint32_t stripe = 0; stripe < nend; stripe += decodeStripeSize) {
+        uint32_t iloop = stripe;
+        uint32_t stripeEnd = std::min(nend, stripe + decodeStripeSize);
+#ifndef SERIAL_DISABLE_VECTORIZED_RAWTODIGI
+        // decode the stripe in blocks, then decode again in order the words the blocks left to the scalar code
+        if (not debug) {
+          for (; iloop + decodeBlockSize <= stripeEnd; iloop += decodeBlockSize) {
+            auto gIndex = feds[ifed].begin + iloop;
+            uint32_t slow = decodeBlock(rocFrames,
+                                        fedId,
+                                        word + iloop,
+                                        xx + gIndex,
+                                        yy + gIndex,
+                                        adc + gIndex,
+                                        pdigi + gIndex,
+                                        rawIdArr + gIndex,
+                                        moduleId + gIndex,
+                                        useQualityInfo,
+                                        includeErrors);
+            for (; slow != 0; slow &= slow - 1) {
+              decodeWord(iloop + __builtin_ctz(slow));
+            }
+          }
+        }
+#endif
+        for (; iloop < stripeEnd; iloop += 1) {
+          decodeWord(iloop);
         }
+        afterStripe(ifed, feds[ifed].begin + stripe, feds[ifed].begin + stripeEnd);
       }
+    };
 
-      pixelgpudetails::Pixel globalPix = frameConversion(barrel, side, layer, rocIdInDetUnit, localPix);
-      xx[gIndex] = globalPix.row;  // origin shifting by 1 0-159
-      yy[gIndex] = globalPix.col;  // origin shifting by 1 0-415
-      adc[gIndex] = getADC(ww);
-      pdigi[gIndex] = pixelgpudetails::pack(globalPix.row, globalPix.col, adc[gIndex]);
-      moduleId[gIndex] = detId.moduleId;
-      rawIdArr[gIndex] = rawId;
-    }  // end of loop (gIndex < end)
+#ifdef SERIAL_ENABLE_INTRA_EVENT_PARALLELISM
+    // the FEDs are unpacked in parallel, and their errors are merged in the order of the FEDs
+    std::vector<std::vector<PixelErrorCompact>> errors(nFeds);
+    tbb::parallel_for(tbb::blocked_range<uint32_t>(0, nFeds), [&](tbb::blocked_range<uint32_t> const &range) {
+      for (uint32_t ifed = range.begin(); ifed < range.end(); ++ifed) {
+        unpackFed(ifed, &errors[ifed]);
+      }
+    });
+    if (includeErrors) {
+      for (auto const &fedErrors : errors) {
+        for (auto const &error : fedErrors) {
+          err->push_back(error);
+        }
+      }
+    }
+#else
+    for (uint32_t ifed = 0; ifed < nFeds; ++ifed) {
+      unpackFed(ifed, err);
+    }
+#endif
 
   }  // end of Raw to Digi kernel
 
@@ -508,8 +591,9 @@ namespace pixelgpudetails {
   // Interface to outside
   void SiPixelRawToClusterGPUKernel::makeClusters(bool isRun2,
                                                   const SiPixelFedCablingMapGPU *cablingMap,
-                                                  const unsigned char *modToUnp,
+                                                  const SiPixelROCFramesGPU *rocFrames,
                                                   const SiPixelGainForHLTonGPU *gains,
+                                                  const SiPixelGainTableForHLT *gainTable,
                                                   const WordFedAppender &wordFed,
                                                   PixelFormatterErrors &&errors,
                                                   const uint32_t wordCounter,
@@ -520,22 +604,120 @@ namespace pixelgpudetails {
 #ifdef GPU_DEBUG
     std::cout << "decoding " << wordCounter << " digis. Max is " << pixelgpudetails::MAX_FED_WORDS << std::endl;
 #endif
+    if (wordCounter > pixelgpudetails::MAX_FED_WORDS) {
+      throw std::runtime_error("The event has " + std::to_string(wordCounter) + " raw data words, more than the " +
+                               std::to_string(pixelgpudetails::MAX_FED_WORDS) + " that can be unpacked");
+    }
 
-    digis_d = SiPixelDigisSoA(pixelgpudetails::MAX_FED_WORDS);
+    // the digis and the errors are allocated for the words of this event, and all the buffers are left uninitialised:
+    // the pool rounds their size up to the next power of 2, and reuses the buffers of the previous events
+    digis_d = SiPixelDigisSoA(wordCounter, bufferPool_);
     if (includeErrors) {
-      digiErrors_d = SiPixelDigiErrorsSoA(pixelgpudetails::MAX_FED_WORDS, std::move(errors));
+      digiErrors_d = SiPixelDigiErrorsSoA(wordCounter, std::move(errors), bufferPool_);
+    }
+    clusters_d = SiPixelClustersSoA(gpuClustering::MaxNumModules, bufferPool_);
+
+#ifdef SERIAL_FUSED_RAWTODIGI
+    // decode, calibrate and find the module boundaries in a single pass over the digis, while each stripe of digis
+    // is still in the cache
+    clusters_d.clusModuleStart()[0] = clusters_d.moduleStart()[0] = 0;
+    for (uint32_t i = 0; i < gpuClustering::MaxNumModules; i++) {
+      clusters_d.clusInModule()[i] = 0;
+    }
+
+    if (wordCounter)  // protect in case of empty event....
+    {
+      assert(0 == wordCounter % 2);
+      uint16_t *id = digis_d.moduleInd();
+      int32_t *clusterId = digis_d.clus();
+      uint32_t *moduleStart = clusters_d.moduleStart();
+
+      // the pixels where the module changes with respect to the previous valid pixel, as countModules() finds them
+      auto findModuleStarts = [&](uint32_t first, uint32_t last, uint16_t &lastId, auto &&addStart) {
+        for (uint32_t i = first; i < last; i++) {
+          clusterId[i] = i;
+          if (id[i] != gpuClustering::InvId and id[i] != lastId) {
+            addStart(i);
+            lastId = id[i];
+          }
+        }
+      };
+
+#ifdef SERIAL_ENABLE_INTRA_EVENT_PARALLELISM
+      // the FEDs are unpacked in parallel: the module boundaries are found within each FED, and merged in the order
+      // of the FEDs, dropping the first boundary of a FED if it continues the module of the previous ones
+      struct FedModules {
+        std::vector<uint32_t> starts;
+        uint16_t lastId = gpuClustering::InvId;
+      };
+      std::vector<FedModules> fedModules(wordFed.nFeds());
+      std::atomic<uint32_t> nBadPixels = 0;
+      auto afterStripe = [&](uint32_t ifed, uint32_t first, uint32_t last) {
+        nBadPixels.fetch_add(gpuCalibPixel::calibrateDigis(
+                                 isRun2, id, digis_d.c_xx(), digis_d.c_yy(), digis_d.adc(), gainTable, first, last),
+                             std::memory_order_relaxed);
+        auto &fed = fedModules[ifed];
+        findModuleStarts(first, last, fed.lastId, [&](uint32_t i) { fed.starts.push_back(i); });
+      };
+#else
+      uint32_t nBadPixels = 0;
+      uint16_t lastId = gpuClustering::InvId;
+      auto afterStripe = [&](uint32_t, uint32_t first, uint32_t last) {
+        nBadPixels += gpuCalibPixel::calibrateDigis(
+            isRun2, id, digis_d.c_xx(), digis_d.c_yy(), digis_d.adc(), gainTable, first, last);
+        findModuleStarts(first, last, lastId, [&](uint32_t i) {
+          auto loc = atomicInc(moduleStart, gpuClustering::MaxNumModules);
+          moduleStart[loc + 1] = i;
+        });
+      };
+#endif
+
+      RawToDigi_kernel(cablingMap,
+                       rocFrames,
+                       wordFed.feds(),
+                       wordFed.nFeds(),
+                       digis_d.xx(),
+                       digis_d.yy(),
+                       digis_d.adc(),
+                       digis_d.pdigi(),
+                       digis_d.rawIdArr(),
+                       id,
+                       digiErrors_d.error(),  // returns nullptr if default-constructed
+                       useQualityInfo,
+                       includeErrors,
+                       debug,
+                       afterStripe);
+
+#ifdef SERIAL_ENABLE_INTRA_EVENT_PARALLELISM
+      uint16_t lastId = gpuClustering::InvId;
+      for (auto const &fed : fedModules) {
+        for (auto i : fed.starts) {
+          if (id[i] == lastId)
+            continue;
+          auto loc = atomicInc(moduleStart, gpuClustering::MaxNumModules);
+          moduleStart[loc + 1] = i;
+          lastId = id[i];
+        }
+      }
+#endif
+      nBadPixels_ = nBadPixels;
+    } else {
+      nBadPixels_ = 0;
     }
-    clusters_d = SiPixelClustersSoA(gpuClustering::MaxNumModules);
+    // End of Raw2Digi, calibration and module boundaries
 
+    {
+      // clusterizer ...
+      using namespace gpuClustering;
+#else
     if (wordCounter)  // protect in case of empty event....
     {
       assert(0 == wordCounter % 2);
       // Launch rawToDigi kernel
       RawToDigi_kernel(cablingMap,
-                       modToUnp,
-                       wordCounter,
-                       wordFed.word(),
-                       wordFed.fedId(),
+                       rocFrames,
+                       wordFed.feds(),
+                       wordFed.nFeds(),
                        digis_d.xx(),
                        digis_d.yy(),
                        digis_d.adc(),
@@ -545,29 +727,54 @@ namespace pixelgpudetails {
                        digiErrors_d.error(),  // returns nullptr if default-constructed
                        useQualityInfo,
                        includeErrors,
-                       debug);
+                       debug,
+                       [](uint32_t, uint32_t, uint32_t) {});
     }
     // End of Raw2Digi and passing data for clustering
 
     {
       // clusterizer ...
       using namespace gpuClustering;
-      gpuCalibPixel::calibDigis(isRun2,
-                                digis_d.moduleInd(),
-                                digis_d.c_xx(),
-                                digis_d.c_yy(),
-                                digis_d.adc(),
-                                gains,
-                                wordCounter,
-                                clusters_d.moduleStart(),
-                                clusters_d.clusInModule(),
-                                clusters_d.clusModuleStart());
+#ifdef SERIAL_DISABLE_VECTORIZED_CALIBRATION
+      nBadPixels_ = gpuCalibPixel::calibDigis(isRun2,
+                                              digis_d.moduleInd(),
+                                              digis_d.c_xx(),
+                                              digis_d.c_yy(),
+                                              digis_d.adc(),
+                                              gains,
+                                              wordCounter,
+                                              clusters_d.moduleStart(),
+                                              clusters_d.clusInModule(),
+                                              clusters_d.clusModuleStart());
+#else
+      nBadPixels_ = gpuCalibPixel::calibDigisVectorized(isRun2,
+                                                        digis_d.moduleInd(),
+                                                        digis_d.c_xx(),
+                                                        digis_d.c_yy(),
+                                                        digis_d.adc(),
+                                                        gainTable,
+                                                        wordCounter,
+                                                        clusters_d.moduleStart(),
+                                                        clusters_d.clusInModule(),
+                                                        clusters_d.clusModuleStart());
+#endif
 
       countModules(digis_d.c_moduleInd(), clusters_d.moduleStart(), digis_d.clus(), wordCounter);
+#endif
 
       // read the number of modules into a data member, used by getProduct())
       digis_d.setNModulesDigis(clusters_d.moduleStart()[0], wordCounter);
 
+#ifdef SERIAL_ENABLE_UNION_FIND_CLUSTERING
+      findClusUnionFind(digis_d.c_moduleInd(),
+                        digis_d.c_xx(),
+                        digis_d.c_yy(),
+                        clusters_d.c_moduleStart(),
+                        clusters_d.clusInModule(),
+                        clusters_d.moduleId(),
+                        digis_d.clus(),
+                        wordCounter);
+#else
       findClus(digis_d.c_moduleInd(),
                digis_d.c_xx(),
                digis_d.c_yy(),
@@ -576,6 +783,7 @@ namespace pixelgpudetails {
                clusters_d.moduleId(),
                digis_d.clus(),
                wordCounter);
+#endif
 
       // apply charge cut
       clusterChargeCut(digis_d.moduleInd(),
@@ -3,8 +3,10 @@
 
 #include <algorithm>
 #include <memory>
+#include <vector>
 
 #include "CUDACore/cudaCompat.h"
+#include "CUDACore/HostBufferPool.h"
 #include "CUDADataFormats/SiPixelDigisSoA.h"
 #include "CUDADataFormats/SiPixelDigiErrorsSoA.h"
 #include "CUDADataFormats/SiPixelClustersSoA.h"
@@ -12,7 +14,9 @@
 #include "DataFormats/PixelErrors.h"
 
 struct SiPixelFedCablingMapGPU;
+struct SiPixelROCFramesGPU;
 class SiPixelGainForHLTonGPU;
+struct SiPixelGainTableForHLT;
 
 namespace pixelgpudetails {
 
@@ -143,19 +147,28 @@ namespace pixelgpudetails {
 
   class SiPixelRawToClusterGPUKernel {
   public:
+    // On CPU the words are not copied: the appender only records where
+    // the words of each FED are, so the raw data must outlive makeClusters()
     class WordFedAppender {
     public:
+      struct FedWords {
+        const uint32_t* word;  // first word of the FED payload
+        uint32_t begin;        // index of the first word in the digi arrays
+        uint32_t length;       // number of words
+        uint8_t fedId;         // fedId - 1200
+      };
+
       WordFedAppender();
       ~WordFedAppender() = default;
 
+      void clear() { feds_.clear(); }
       void initializeWordFed(int fedId, unsigned int wordCounterGPU, const uint32_t* src, unsigned int length);
 
-      const unsigned int* word() const { return word_.get(); }
-      const unsigned char* fedId() const { return fedId_.get(); }
+      const FedWords* feds() const { return feds_.data(); }
+      uint32_t nFeds() const { return feds_.size(); }
 
     private:
-      std::unique_ptr<unsigned int[]> word_;
-      std::unique_ptr<unsigned char[]> fedId_;
+      std::vector<FedWords> feds_;
     };
 
     SiPixelRawToClusterGPUKernel() = default;
@@ -168,8 +181,9 @@ namespace pixelgpudetails {
 
     void makeClusters(bool isRun2,
                       const SiPixelFedCablingMapGPU* cablingMap,
-                      const unsigned char* modToUnp,
+                      const SiPixelROCFramesGPU* rocFrames,
                       const SiPixelGainForHLTonGPU* gains,
+                      const SiPixelGainTableForHLT* gainTable,
                       const WordFedAppender& wordFed,
                       PixelFormatterErrors&& errors,
                       const uint32_t wordCounter,
@@ -184,11 +198,21 @@ namespace pixelgpudetails {
 
     SiPixelDigiErrorsSoA&& getErrors() { return std::move(digiErrors_d); }
 
+    // number of pixels in dead or noisy columns in the last event
+    uint32_t nBadPixels() const { return nBadPixels_; }
+
+    // memory used by the buffers of the products since the beginning of the job
+    cms::cuda::HostBufferPool const& bufferPool() const { return bufferPool_; }
+
   private:
+    // recycles the buffers of the products of the previous events; declared first, as it must outlive them
+    cms::cuda::HostBufferPool bufferPool_;
+
     // Data to be put in the event
     SiPixelDigisSoA digis_d;
     SiPixelClustersSoA clusters_d;
     SiPixelDigiErrorsSoA digiErrors_d;
+    uint32_t nBadPixels_ = 0;
   };
 
   // see RecoLocalTracker/SiPixelClusterizer
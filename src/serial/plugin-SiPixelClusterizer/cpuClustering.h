@@ -0,0 +1,130 @@
+#ifndef RecoLocalTracker_SiPixelClusterizer_plugins_cpuClustering_h
+#define RecoLocalTracker_SiPixelClusterizer_plugins_cpuClustering_h
+
+#include <cstdint>
+#include <vector>
+
+#ifdef SERIAL_ENABLE_INTRA_EVENT_PARALLELISM
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+#endif
+
+#include "Geometry/phase1PixelTopology.h"
+#include "CUDACore/cuda_assert.h"
+
+#include "gpuClusteringConstants.h"
+
+namespace gpuClustering {
+
+  // Same interface and output as findClus, but labels the connected
+  // components of each module in a single pass over its pixels with a
+  // union-find, instead of the iterative label propagation over a
+  // histogram of the pixels tuned for the GPU.
+  //
+  // Each pixel is placed in a per-thread map of the module (with a border
+  // of one row and column, to avoid the bounds checks), and merged with
+  // the pixels already placed in the same position or in the 8 around it.
+  // The union keeps the smallest pixel index as the root of each cluster,
+  // so that the clusters are numbered in the order of their first pixel,
+  // as in findClus. There is no limit on the number of pixels per module.
+  void findClusUnionFind(uint16_t const* __restrict__ id,           // module id of each pixel
+                         uint16_t const* __restrict__ x,            // local coordinates of each pixel
+                         uint16_t const* __restrict__ y,            //
+                         uint32_t const* __restrict__ moduleStart,  // index of the first pixel of each module
+                         uint32_t* __restrict__ nClustersInModule,  // output: number of clusters found in each module
+                         uint32_t* __restrict__ moduleId,           // output: module id of each module
+                         int32_t* __restrict__ clusterId,           // output: cluster id of each pixel
+                         int numElements) {
+    constexpr int rows = phase1PixelTopology::numRowsInModule + 2;
+    constexpr int cols = phase1PixelTopology::numColsInModule + 2;
+
+    // clusterId is used as the parent of each pixel, always pointing to a smaller or equal index
+    auto find = [clusterId](int32_t i) {
+      while (clusterId[i] != i) {
+        // path halving
+        clusterId[i] = clusterId[clusterId[i]];
+        i = clusterId[i];
+      }
+      return i;
+    };
+    auto unite = [&](int32_t i, int32_t j) {
+      i = find(i);
+      j = find(j);
+      if (i < j)
+        clusterId[j] = i;
+      else if (j < i)
+        clusterId[i] = j;
+    };
+
+    auto clusterizeModule = [&](uint32_t module) {
+      // index of the first pixel placed at each position of the module, or -1
+      thread_local std::vector<int32_t> map(rows * cols, -1);
+
+      auto firstPixel = moduleStart[1 + module];
+      auto thisModuleId = id[firstPixel];
+      assert(thisModuleId < MaxNumModules);
+
+      // the first pixel not belonging to this module (or invalid)
+      int msize = moduleEnd(moduleStart, module, numElements);
+
+      for (int i = firstPixel; i < msize; i++) {
+        if (id[i] == InvId)  // skip invalid pixels
+          continue;
+        assert(x[i] < phase1PixelTopology::numRowsInModule);
+        assert(y[i] < phase1PixelTopology::numColsInModule);
+        clusterId[i] = i;
+        auto cell = (x[i] + 1) * cols + y[i] + 1;
+        for (auto neighbour : {cell - cols - 1,
+                               cell - cols,
+                               cell - cols + 1,
+                               cell - 1,
+                               cell + 1,
+                               cell + cols - 1,
+                               cell + cols,
+                               cell + cols + 1}) {
+          if (map[neighbour] >= 0)
+            unite(i, map[neighbour]);
+        }
+        // a pixel can appear more than once with different charge in the same event
+        if (map[cell] >= 0)
+          unite(i, map[cell]);
+        else
+          map[cell] = i;
+      }
+
+      // number the clusters in the order of their first pixel; the parent of
+      // each pixel precedes it, so it has already been given its final id
+      uint32_t foundClusters = 0;
+      for (int i = firstPixel; i < msize; i++) {
+        if (id[i] == InvId) {  // skip invalid pixels
+          clusterId[i] = -9999;
+          continue;
+        }
+        map[(x[i] + 1) * cols + y[i] + 1] = -1;
+        auto parent = clusterId[i];
+        clusterId[i] = parent == i ? foundClusters++ : clusterId[parent];
+      }
+
+      nClustersInModule[thisModuleId] = foundClusters;
+      moduleId[module] = thisModuleId;
+    };
+
+    uint32_t firstModule = 0;
+    auto endModule = moduleStart[0];
+#ifdef SERIAL_ENABLE_INTRA_EVENT_PARALLELISM
+    tbb::parallel_for(tbb::blocked_range<uint32_t>(firstModule, endModule),
+                      [&](tbb::blocked_range<uint32_t> const& range) {
+                        for (auto module = range.begin(); module < range.end(); module += 1) {
+                          clusterizeModule(module);
+                        }
+                      });
+#else
+    for (auto module = firstModule; module < endModule; module += 1) {
+      clusterizeModule(module);
+    }
+#endif
+  }
+
+}  // namespace gpuClustering
+
+#endif  // RecoLocalTracker_SiPixelClusterizer_plugins_cpuClustering_h
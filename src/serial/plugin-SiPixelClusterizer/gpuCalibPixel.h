@@ -1,8 +1,14 @@
 #ifndef RecoLocalTracker_SiPixelClusterizer_plugins_gpuCalibPixel_h
 #define RecoLocalTracker_SiPixelClusterizer_plugins_gpuCalibPixel_h
 
+#include <algorithm>
+#include <atomic>
 #include <cstdint>
-#include <cstdio>
+
+#ifdef SERIAL_ENABLE_INTRA_EVENT_PARALLELISM
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+#endif
 
 #include "CondFormats/SiPixelGainForHLTonGPU.h"
 #include "CUDACore/cuda_assert.h"
@@ -19,7 +25,8 @@ namespace gpuCalibPixel {
   constexpr float VCaltoElectronOffset = -60;      // L2-4: -60 +- 130
   constexpr float VCaltoElectronOffset_L1 = -670;  // L1:   -670 +- 220
 
-   void calibDigis(bool isRun2,
+  // returns the number of pixels in dead or noisy columns, that are marked as invalid
+  uint32_t calibDigis(bool isRun2,
                              uint16_t* id,
                              uint16_t const* __restrict__ x,
                              uint16_t const* __restrict__ y,
@@ -39,9 +46,10 @@ namespace gpuCalibPixel {
       nClustersInModule[i] = 0;
     }
 
-    for (int i = first; i < numElements; i++) {
+    std::atomic<uint32_t> nBadPixels = 0;
+    auto calibrate = [&](int i) {
       if (InvId == id[i])
-        continue;
+        return;
 
       float conversionFactor = (isRun2) ? (id[i] < 96 ? VCaltoElectronGain_L1 : VCaltoElectronGain) : 1.f;
       float offset = (isRun2) ? (id[i] < 96 ? VCaltoElectronOffset_L1 : VCaltoElectronOffset) : 0;
@@ -57,12 +65,112 @@ namespace gpuCalibPixel {
       if (isDeadColumn | isNoisyColumn) {
         id[i] = InvId;
         adc[i] = 0;
-        printf("bad pixel at %d in %d\n", i, id[i]);
+        nBadPixels.fetch_add(1, std::memory_order_relaxed);
       } else {
         float vcal = adc[i] * gain - pedestal * gain;
         adc[i] = std::max(100, int(vcal * conversionFactor + offset));
       }
+    };
+
+#ifdef SERIAL_ENABLE_INTRA_EVENT_PARALLELISM
+    tbb::parallel_for(tbb::blocked_range<int>(first, numElements), [&](tbb::blocked_range<int> const& range) {
+      for (int i = range.begin(); i < range.end(); i++) {
+        calibrate(i);
+      }
+    });
+#else
+    for (int i = first; i < numElements; i++) {
+      calibrate(i);
+    }
+#endif
+    return nBadPixels;
+  }
+
+  // Same as the calibration in calibDigis, for the digis in [first, last), with the calibration prepared in advance in
+  // SiPixelGainTableForHLT: the loop has no branches, and is vectorised with gathers from the table. The contraction to
+  // fused multiply-adds is disabled, to round exactly as calibDigis.
+  __attribute__((target_clones("avx512f", "avx2", "default"), optimize("fp-contract=off"))) uint32_t calibrateDigis(
+      bool isRun2,
+      uint16_t* __restrict__ id,
+      uint16_t const* __restrict__ x,
+      uint16_t const* __restrict__ y,
+      uint16_t* __restrict__ adc,
+      SiPixelGainTableForHLT const* __restrict__ table,
+      int first,
+      int last) {
+    uint32_t const* __restrict__ firstBlock = table->firstBlock;
+    uint32_t const* __restrict__ blocksPerColumn = table->blocksPerColumn;
+    uint32_t const rowBlockMultiplier = table->rowBlockMultiplier;
+    uint32_t const* __restrict__ blockPairs = table->blockPairs;
+    float const* __restrict__ pedestals = table->pedestal;
+    float const* __restrict__ gains = table->gain;
+    uint32_t const* __restrict__ badPedestal = table->badPedestal;
+
+    // the selections on isRun2 are hoisted out of the loop, to be left with selections of values
+    float const conversionFactorL1 = isRun2 ? VCaltoElectronGain_L1 : 1.f;
+    float const conversionFactorOther = isRun2 ? VCaltoElectronGain : 1.f;
+    float const offsetL1 = isRun2 ? VCaltoElectronOffset_L1 : 0.f;
+    float const offsetOther = isRun2 ? VCaltoElectronOffset : 0.f;
+
+    uint32_t nBadPixels = 0;
+    for (int i = first; i < last; i++) {
+      uint32_t module = id[i];
+      uint32_t valid = module != InvId;
+      uint32_t m = module * valid;  // any module for the invalid digis, their results are discarded
+      uint32_t block = firstBlock[m] + y[i] * blocksPerColumn[m] + ((x[i] * rowBlockMultiplier) >> 16);
+      uint32_t codes = blockPairs[block / 2] >> (block % 2 * 16);
+      uint32_t gainCode = codes & 0xFF;
+      uint32_t pedCode = (codes >> 8) & 0xFF;
+      uint32_t bad = valid & (badPedestal[pedCode / 32] >> (pedCode % 32));
+      float pedestal = pedestals[pedCode];
+      float gain = gains[gainCode];
+
+      float conversionFactor = m < 96 ? conversionFactorL1 : conversionFactorOther;
+      float offset = m < 96 ? offsetL1 : offsetOther;
+      float vcal = adc[i] * gain - pedestal * gain;
+      int calibrated = std::max(100, int(vcal * conversionFactor + offset));
+
+      // the valid digis in a bad column become invalid with no charge, and the invalid ones are left unchanged;
+      // written as arithmetic on 0 or 1, as the selections would be turned into branches
+      uint32_t good = valid & (1 - bad);
+      id[i] = module + bad * (InvId - module);
+      adc[i] = (1 - valid) * adc[i] + good * uint32_t(calibrated);
+      nBadPixels += bad;
     }
+    return nBadPixels;
+  }
+
+  // Same as calibDigis, with the calibration prepared in advance
+  uint32_t calibDigisVectorized(bool isRun2,
+                                uint16_t* id,
+                                uint16_t const* __restrict__ x,
+                                uint16_t const* __restrict__ y,
+                                uint16_t* adc,
+                                SiPixelGainTableForHLT const* __restrict__ table,
+                                int numElements,
+                                uint32_t* __restrict__ moduleStart,        // just to zero first
+                                uint32_t* __restrict__ nClustersInModule,  // just to zero them
+                                uint32_t* __restrict__ clusModuleStart     // just to zero first
+  ) {
+    int first = 0;
+
+    // zero for next kernels...
+    if (0 == first)
+      clusModuleStart[0] = moduleStart[0] = 0;
+    for (int i = first; i < static_cast<int>(gpuClustering::MaxNumModules); i++) {
+      nClustersInModule[i] = 0;
+    }
+
+#ifdef SERIAL_ENABLE_INTRA_EVENT_PARALLELISM
+    std::atomic<uint32_t> nBadPixels = 0;
+    tbb::parallel_for(tbb::blocked_range<int>(first, numElements), [&](tbb::blocked_range<int> const& range) {
+      nBadPixels.fetch_add(calibrateDigis(isRun2, id, x, y, adc, table, range.begin(), range.end()),
+                           std::memory_order_relaxed);
+    });
+    return nBadPixels;
+#else
+    return calibrateDigis(isRun2, id, x, y, adc, table, first, numElements);
+#endif
   }
 }  // namespace gpuCalibPixel
 
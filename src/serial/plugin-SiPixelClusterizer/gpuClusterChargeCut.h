@@ -4,6 +4,11 @@
 #include <cstdint>
 #include <cstdio>
 
+#ifdef SERIAL_ENABLE_INTRA_EVENT_PARALLELISM
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+#endif
+
 #include "CUDACore/cuda_assert.h"
 #include "CUDACore/prefixScan.h"
 
@@ -18,13 +23,12 @@ namespace gpuClustering {
                         uint32_t const* __restrict__ moduleId,     // module id of each module
                         int32_t* __restrict__ clusterId,           // modified: cluster id of each pixel
                         uint32_t numElements) {
-    int32_t charge[MaxNumClustersPerModules];
-    uint8_t ok[MaxNumClustersPerModules];
-    uint16_t newclusId[MaxNumClustersPerModules];
+    // the modules are independent of each other
+    auto cutModule = [&](uint32_t module) {
+      int32_t charge[MaxNumClustersPerModules];
+      uint8_t ok[MaxNumClustersPerModules];
+      uint16_t newclusId[MaxNumClustersPerModules];
 
-    uint32_t firstModule = 0;
-    auto endModule = moduleStart[0];
-    for (auto module = firstModule; module < endModule; module += 1) {
       auto firstPixel = moduleStart[1 + module];
       auto thisModuleId = id[firstPixel];
       assert(thisModuleId < MaxNumModules);
@@ -32,7 +36,7 @@ namespace gpuClustering {
 
       auto nclus = nClustersInModule[thisModuleId];
       if (nclus == 0)
-        continue;
+        return;
 
       if (nclus > MaxNumClustersPerModules)
         printf("Warning too many clusters in module %d in block %d: %d > %d\n",
@@ -42,14 +46,13 @@ namespace gpuClustering {
                MaxNumClustersPerModules);
 
       auto first = firstPixel;
+      auto last = moduleEnd(moduleStart, module, numElements);
 
       if (nclus > MaxNumClustersPerModules) {
         // remove excess  FIXME find a way to cut charge first....
-        for (auto i = first; i < numElements; i++) {
+        for (auto i = first; i < last; i++) {
           if (id[i] == InvId)
             continue;  // not valid
-          if (id[i] != thisModuleId)
-            break;  // end of module
           if (clusterId[i] >= MaxNumClustersPerModules) {
             id[i] = InvId;
             clusterId[i] = InvId;
@@ -68,11 +71,9 @@ namespace gpuClustering {
         charge[i] = 0;
       }
 
-      for (auto i = first; i < numElements; i++) {
+      for (auto i = first; i < last; i++) {
         if (id[i] == InvId)
           continue;  // not valid
-        if (id[i] != thisModuleId)
-          break;  // end of module
         atomicAdd(&charge[clusterId[i]], adc[i]);
       }
 
@@ -88,7 +89,7 @@ namespace gpuClustering {
       assert(nclus >= newclusId[nclus - 1]);
 
       if (nclus == newclusId[nclus - 1])
-        continue;
+        return;
 
       nClustersInModule[thisModuleId] = newclusId[nclus - 1];
 
@@ -99,18 +100,31 @@ namespace gpuClustering {
       }
 
       // reassign id
-      for (auto i = first; i < numElements; i++) {
+      for (auto i = first; i < last; i++) {
         if (id[i] == InvId)
           continue;  // not valid
-        if (id[i] != thisModuleId)
-          break;  // end of module
         clusterId[i] = newclusId[clusterId[i]] - 1;
         if (clusterId[i] == InvId)
           id[i] = InvId;
       }
 
       //done
+    };
+
+    uint32_t firstModule = 0;
+    auto endModule = moduleStart[0];
+#ifdef SERIAL_ENABLE_INTRA_EVENT_PARALLELISM
+    tbb::parallel_for(tbb::blocked_range<uint32_t>(firstModule, endModule),
+                      [&](tbb::blocked_range<uint32_t> const& range) {
+                        for (auto module = range.begin(); module < range.end(); module += 1) {
+                          cutModule(module);
+                        }
+                      });
+#else
+    for (auto module = firstModule; module < endModule; module += 1) {
+      cutModule(module);
     }  // loop on modules
+#endif
   }
 
 }  // namespace gpuClustering
@@ -4,6 +4,14 @@
 #include <cstdint>
 #include <cstdio>
 
+#ifdef SERIAL_ENABLE_INTRA_EVENT_PARALLELISM
+#include <vector>
+
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+#include <tbb/parallel_reduce.h>
+#endif
+
 #include "Geometry/phase1PixelTopology.h"
 #include "CUDACore/HistoContainer.h"
 #include "CUDACore/cuda_assert.h"
@@ -20,20 +28,47 @@ namespace gpuClustering {
                     uint32_t* __restrict__ moduleStart,
                     int32_t* __restrict__ clusterId,
                     int numElements) {
-    int first = 0;
-    for (int i = first; i < numElements; i++) {
-      clusterId[i] = i;
+    auto isBoundary = [&](int i) {
       if (InvId == id[i])
-        continue;
+        return false;
       auto j = i - 1;
       while (j >= 0 and id[j] == InvId)
         --j;
-      if (j < 0 or id[j] != id[i]) {
+      return j < 0 or id[j] != id[i];
+    };
+
+    int first = 0;
+#ifdef SERIAL_ENABLE_INTRA_EVENT_PARALLELISM
+    // find the boundaries in parallel, and fill moduleStart in the order of the pixels as the serial loop does
+    auto boundaries = tbb::parallel_reduce(
+        tbb::blocked_range<int>(first, numElements),
+        std::vector<int>(),
+        [&](tbb::blocked_range<int> const& range, std::vector<int> found) {
+          for (int i = range.begin(); i < range.end(); i++) {
+            clusterId[i] = i;
+            if (isBoundary(i))
+              found.push_back(i);
+          }
+          return found;
+        },
+        [](std::vector<int> left, std::vector<int> const& right) {
+          left.insert(left.end(), right.begin(), right.end());
+          return left;
+        });
+    for (auto i : boundaries) {
+      auto loc = atomicInc(moduleStart, MaxNumModules);
+      moduleStart[loc + 1] = i;
+    }
+#else
+    for (int i = first; i < numElements; i++) {
+      clusterId[i] = i;
+      if (isBoundary(i)) {
         // boundary...
         auto loc = atomicInc(moduleStart, MaxNumModules);
         moduleStart[loc + 1] = i;
       }
     }
+#endif
   }
 
   //  __launch_bounds__(256,4)
@@ -45,11 +80,10 @@ namespace gpuClustering {
                 uint32_t* __restrict__ moduleId,           // output: module id of each module
                 int32_t* __restrict__ clusterId,           // output: cluster id of each pixel
                 int numElements) {
-    int msize;
+    // the modules are independent of each other
+    auto clusterizeModule = [&](uint32_t module) {
+      int msize;
 
-    uint32_t firstModule = 0;
-    auto endModule = moduleStart[0];
-    for (auto module = firstModule; module < endModule; module += 1) {
       auto firstPixel = moduleStart[1 + module];
       auto thisModuleId = id[firstPixel];
       assert(thisModuleId < MaxNumModules);
@@ -61,18 +95,8 @@ namespace gpuClustering {
 
       auto first = firstPixel;
 
-      // find the index of the first pixel not belonging to this module (or invalid)
-      msize = numElements;
-
-      // skip threads not associated to an existing pixel
-      for (int i = first; i < numElements; i++) {
-        if (id[i] == InvId)  // skip invalid pixels
-          continue;
-        if (id[i] != thisModuleId) {  // find the first pixel in a different module
-          atomicMin(&msize, i);
-          break;
-        }
-      }
+      // the index of the first pixel not belonging to this module (or invalid)
+      msize = moduleEnd(moduleStart, module, numElements);
 
       //init hist  (ymax=416 < 512 : 9bits)
       constexpr uint32_t maxPixInModule = 4000;
@@ -268,8 +292,22 @@ namespace gpuClustering {
       if (thisModuleId % 100 == 1)
         printf("%d clusters in module %d\n", foundClusters, thisModuleId);
 #endif
+    };
 
+    uint32_t firstModule = 0;
+    auto endModule = moduleStart[0];
+#ifdef SERIAL_ENABLE_INTRA_EVENT_PARALLELISM
+    tbb::parallel_for(tbb::blocked_range<uint32_t>(firstModule, endModule),
+                      [&](tbb::blocked_range<uint32_t> const& range) {
+                        for (auto module = range.begin(); module < range.end(); module += 1) {
+                          clusterizeModule(module);
+                        }
+                      });
+#else
+    for (auto module = firstModule; module < endModule; module += 1) {
+      clusterizeModule(module);
     }  // module loop
+#endif
   }
 
 }  // namespace gpuClustering
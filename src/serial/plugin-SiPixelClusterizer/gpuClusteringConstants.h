@@ -1,6 +1,19 @@
 #ifndef RecoLocalTracker_SiPixelClusterizer_plugins_gpuClusteringConstants_h
 #define RecoLocalTracker_SiPixelClusterizer_plugins_gpuClusteringConstants_h
 
+#include <cstdint>
+
 #include "CUDADataFormats/gpuClusteringConstants.h"
 
+namespace gpuClustering {
+
+  // On the CPU the modules are found in the order of their pixels, so each module ends where the next one starts,
+  // and the last one at the end of the digis: the pixels in [moduleStart[1 + module], moduleEnd(...)) either belong
+  // to the module or are invalid.
+  inline uint32_t moduleEnd(uint32_t const* moduleStart, uint32_t module, uint32_t numElements) {
+    return module + 1 < moduleStart[0] ? moduleStart[2 + module] : numElements;
+  }
+
+}  // namespace gpuClustering
+
 #endif  // RecoLocalTracker_SiPixelClusterizer_plugins_gpuClusteringConstants_h
@@ -5,60 +5,224 @@
 #include <cstdio>
 #include <limits>
 
+#ifdef SERIAL_ENABLE_INTRA_EVENT_PARALLELISM
+#include <tbb/blocked_range.h>
+#include <tbb/parallel_for.h>
+#endif
+
 #include "DataFormats/BeamSpotPOD.h"
+#include "CUDADataFormats/SiPixelClustersSoA.h"
+#include "CUDADataFormats/SiPixelDigisSoA.h"
 #include "CUDADataFormats/TrackingRecHit2DHeterogeneous.h"
+#include "CUDADataFormats/gpuClusteringConstants.h"
 #include "DataFormats/approx_atan2.h"
 #include "CUDACore/cuda_assert.h"
 #include "CondFormats/pixelCPEforGPU.h"
 
 namespace gpuPixelRecHits {
 
-  void getHits(pixelCPEforGPU::ParamsOnGPU const* __restrict__ cpeParams,
-               BeamSpotPOD const* __restrict__ bs,
-               SiPixelDigisSoA::DeviceConstView const* __restrict__ pdigis,
-               int numElements,
-               SiPixelClustersSoA::DeviceConstView const* __restrict__ pclusters,
-               TrackingRecHit2DSOAView* phits) {
+  using ClusParams = pixelCPEforGPU::ClusParams;
+
+  // the statistics of a cluster that the CPE needs, accumulated from its digis
+  struct ClusterAccumulator {
+    uint16_t minRow;
+    uint16_t maxRow;
+    uint16_t minCol;
+    uint16_t maxCol;
+    int32_t charge;
+    int32_t Q_f_X;  // charge in the first and last row and column
+    int32_t Q_l_X;
+    int32_t Q_f_Y;
+    int32_t Q_l_Y;
+  };
+
+  // pixmx is not available in the binary dumps
+  //auto pixmx = cpeParams->detParams(me).pixmx;
+  constexpr uint16_t pixmx = std::numeric_limits<uint16_t>::max();
+
+  // the statistics of all the nclus clusters of module me, whose digis start at first, in a single pass over them:
+  // the charge in the first and last row and column is restarted each time the minimum or maximum moves
+  inline void accumulateClusters(SiPixelDigisSoA::DeviceConstView const& digis,
+                                 int first,
+                                 int numElements,
+                                 uint16_t me,
+                                 int nclus,
+                                 ClusterAccumulator* __restrict__ clusters) {
+    for (int ic = 0; ic < nclus; ic++) {
+      clusters[ic] = {std::numeric_limits<uint16_t>::max(), 0, std::numeric_limits<uint16_t>::max(), 0, 0, 0, 0, 0, 0};
+    }
+    for (int i = first; i < numElements; i++) {
+      auto id = digis.moduleInd(i);
+      if (id == gpuClustering::InvId)
+        continue;  // not valid
+      if (id != me)
+        break;  // end of module
+      auto cl = digis.clus(i);
+      assert(cl >= 0);
+      assert(cl < nclus);
+      auto x = digis.xx(i);
+      auto y = digis.yy(i);
+      int32_t ch = std::min(digis.adc(i), pixmx);
+      auto& c = clusters[cl];
+      c.charge += ch;
+      if (x < c.minRow) {
+        c.minRow = x;
+        c.Q_f_X = 0;
+      }
+      if (x == c.minRow)
+        c.Q_f_X += ch;
+      if (x > c.maxRow) {
+        c.maxRow = x;
+        c.Q_l_X = 0;
+      }
+      if (x == c.maxRow)
+        c.Q_l_X += ch;
+      if (y < c.minCol) {
+        c.minCol = y;
+        c.Q_f_Y = 0;
+      }
+      if (y == c.minCol)
+        c.Q_f_Y += ch;
+      if (y > c.maxCol) {
+        c.maxCol = y;
+        c.Q_l_Y = 0;
+      }
+      if (y == c.maxCol)
+        c.Q_l_Y += ch;
+    }
+  }
+
+  // the statistics of the nClusInIter clusters starting from startClus, copied to clusParams for the CPE
+  inline void fillClusParams(ClusterAccumulator const* __restrict__ clusters,
+                             int startClus,
+                             int nClusInIter,
+                             ClusParams& __restrict__ clusParams) {
+    for (int ic = 0; ic < nClusInIter; ic++) {
+      auto const& c = clusters[startClus + ic];
+      clusParams.minRow[ic] = c.minRow;
+      clusParams.maxRow[ic] = c.maxRow;
+      clusParams.minCol[ic] = c.minCol;
+      clusParams.maxCol[ic] = c.maxCol;
+      clusParams.charge[ic] = c.charge;
+      clusParams.Q_f_X[ic] = c.Q_f_X;
+      clusParams.Q_l_X[ic] = c.Q_l_X;
+      clusParams.Q_f_Y[ic] = c.Q_f_Y;
+      clusParams.Q_l_Y[ic] = c.Q_l_Y;
+    }
+  }
+
+  // the statistics of the nClusInIter clusters starting from startClus of module me, in two passes over all the digis
+  // of the module, as on the GPU
+  inline void accumulateClusParams(SiPixelDigisSoA::DeviceConstView const& digis,
+                                   int first,
+                                   int numElements,
+                                   uint16_t me,
+                                   int startClus,
+                                   int nClusInIter,
+                                   ClusParams& clusParams) {
+    constexpr uint16_t InvId = gpuClustering::InvId;
+    constexpr int32_t MaxHitsInIter = pixelCPEforGPU::MaxHitsInIter;
+    int lastClus = startClus + nClusInIter;
+
+    // init
+    for (int ic = 0; ic < nClusInIter; ic++) {
+      clusParams.minRow[ic] = std::numeric_limits<uint32_t>::max();
+      clusParams.maxRow[ic] = 0;
+      clusParams.minCol[ic] = std::numeric_limits<uint32_t>::max();
+      clusParams.maxCol[ic] = 0;
+      clusParams.charge[ic] = 0;
+      clusParams.Q_f_X[ic] = 0;
+      clusParams.Q_l_X[ic] = 0;
+      clusParams.Q_f_Y[ic] = 0;
+      clusParams.Q_l_Y[ic] = 0;
+    }
+
+    // one thead per "digi"
+
+    for (int i = first; i < numElements; i++) {
+      auto id = digis.moduleInd(i);
+      if (id == InvId)
+        continue;  // not valid
+      if (id != me)
+        break;  // end of module
+      auto cl = digis.clus(i);
+      if (cl < startClus || cl >= lastClus)
+        continue;
+      auto x = digis.xx(i);
+      auto y = digis.yy(i);
+      cl -= startClus;
+      assert(cl >= 0);
+      assert(cl < MaxHitsInIter);
+      atomicMin(&clusParams.minRow[cl], x);
+      atomicMax(&clusParams.maxRow[cl], x);
+      atomicMin(&clusParams.minCol[cl], y);
+      atomicMax(&clusParams.maxCol[cl], y);
+    }
+
+    for (int i = first; i < numElements; i++) {
+      auto id = digis.moduleInd(i);
+      if (id == InvId)
+        continue;  // not valid
+      if (id != me)
+        break;  // end of module
+      auto cl = digis.clus(i);
+      if (cl < startClus || cl >= lastClus)
+        continue;
+      cl -= startClus;
+      assert(cl >= 0);
+      assert(cl < MaxHitsInIter);
+      auto x = digis.xx(i);
+      auto y = digis.yy(i);
+      auto ch = std::min(digis.adc(i), pixmx);
+      atomicAdd(&clusParams.charge[cl], ch);
+      if (clusParams.minRow[cl] == x)
+        atomicAdd(&clusParams.Q_f_X[cl], ch);
+      if (clusParams.maxRow[cl] == x)
+        atomicAdd(&clusParams.Q_l_X[cl], ch);
+      if (clusParams.minCol[cl] == y)
+        atomicAdd(&clusParams.Q_f_Y[cl], ch);
+      if (clusParams.maxCol[cl] == y)
+        atomicAdd(&clusParams.Q_l_Y[cl], ch);
+    }
+  }
+
+  // position and errors of the first n clusters in clusParams, all from the same module: the CPE has no branches, so
+  // that the loop over the clusters can be vectorised
+  inline void clusterPositions(pixelCPEforGPU::CommonParams const& __restrict__ comParams,
+                               pixelCPEforGPU::DetParams const& __restrict__ detParams,
+                               ClusParams& __restrict__ clusParams,
+                               int n) {
+    for (int ic = 0; ic < n; ic++) {
+      pixelCPEforGPU::position(comParams, detParams, clusParams, ic);
+      pixelCPEforGPU::errorFromDB(comParams, detParams, clusParams, ic);
+    }
+  }
+
+  // the hits of the modules in [firstModule, endModule), with clusParams as scratch space; the modules are independent
+  inline void getHitsInModules(pixelCPEforGPU::ParamsOnGPU const* __restrict__ cpeParams,
+                               BeamSpotPOD const* __restrict__ bs,
+                               SiPixelDigisSoA::DeviceConstView const* __restrict__ pdigis,
+                               int numElements,
+                               SiPixelClustersSoA::DeviceConstView const* __restrict__ pclusters,
+                               TrackingRecHit2DSOAView* phits,
+                               ClusParams& clusParams,
+                               uint32_t firstModule,
+                               uint32_t endModule) {
     // FIXME
     // the compiler seems NOT to optimize loads from views (even in a simple test case)
     // The whole gimnastic here of copying or not is a pure heuristic exercise that seems to produce the fastest code with the above signature
     // not using views (passing a gazzilion of array pointers) seems to produce the fastest code (but it is harder to mantain)
 
-    assert(phits);
-    assert(cpeParams);
-
     auto& hits = *phits;
 
     auto const digis = *pdigis;  // the copy is intentional!
     auto const& clusters = *pclusters;
 
-    // copy average geometry corrected by beamspot . FIXME (move it somewhere else???)
-
-    auto& agc = hits.averageGeometry();
-    auto const& ag = cpeParams->averageGeometry();
-    for (int il = 0, nl = TrackingRecHit2DSOAView::AverageGeometry::numberOfLaddersInBarrel; il < nl; il++) {
-      agc.ladderZ[il] = ag.ladderZ[il] - bs->z;
-      agc.ladderX[il] = ag.ladderX[il] - bs->x;
-      agc.ladderY[il] = ag.ladderY[il] - bs->y;
-      agc.ladderR[il] = sqrt(agc.ladderX[il] * agc.ladderX[il] + agc.ladderY[il] * agc.ladderY[il]);
-      agc.ladderMinZ[il] = ag.ladderMinZ[il] - bs->z;
-      agc.ladderMaxZ[il] = ag.ladderMaxZ[il] - bs->z;
-    }
-    agc.endCapZ[0] = ag.endCapZ[0] - bs->z;
-    agc.endCapZ[1] = ag.endCapZ[1] - bs->z;
-    //         printf("endcapZ %f %f\n",agc.endCapZ[0],agc.endCapZ[1]);
-
-    // to be moved in common namespace...
-    constexpr uint16_t InvId = 9999;  // must be > MaxNumModules
     constexpr int32_t MaxHitsInIter = pixelCPEforGPU::MaxHitsInIter;
+#ifndef SERIAL_DISABLE_FUSED_CLUSTER_PARAMS
+    ClusterAccumulator moduleClusters[gpuClustering::MaxNumClustersPerModules];
+#endif
 
-    using ClusParams = pixelCPEforGPU::ClusParams;
-
-    // as usual one block per module
-    ClusParams clusParams;
-
-    uint32_t firstModule = 0;
-    auto endModule = clusters.moduleStart(0);
     for (auto module = firstModule; module < endModule; module += 1) {
       auto me = clusters.moduleId(module);
       int nclus = clusters.clusInModule(me);
@@ -68,7 +232,7 @@ namespace gpuPixelRecHits {
 
 #ifdef GPU_DEBUG
       auto k = clusters.moduleStart(1 + module);
-      while (digis.moduleInd(k) == InvId)
+      while (digis.moduleInd(k) == gpuClustering::InvId)
         ++k;
       assert(digis.moduleInd(k) == me);
 #endif
@@ -78,6 +242,11 @@ namespace gpuPixelRecHits {
         printf("hitbuilder: %d clusters in module %d. will write at %d\n", nclus, me, clusters.clusModuleStart(me));
 #endif
 
+#ifndef SERIAL_DISABLE_FUSED_CLUSTER_PARAMS
+      // all the clusters of the module at once, the chunks only limit the scratch space of the CPE
+      accumulateClusters(digis, clusters.moduleStart(1 + module), numElements, me, nclus, moduleClusters);
+#endif
+
       for (int startClus = 0, endClus = nclus; startClus < endClus; startClus += MaxHitsInIter) {
         auto first = clusters.moduleStart(1 + module);
 
@@ -89,74 +258,18 @@ namespace gpuPixelRecHits {
 
         assert(nclus > MaxHitsInIter || (0 == startClus && nClusInIter == nclus && lastClus == nclus));
 
-        // init
-        for (int ic = 0; ic < nClusInIter; ic++) {
-          clusParams.minRow[ic] = std::numeric_limits<uint32_t>::max();
-          clusParams.maxRow[ic] = 0;
-          clusParams.minCol[ic] = std::numeric_limits<uint32_t>::max();
-          clusParams.maxCol[ic] = 0;
-          clusParams.charge[ic] = 0;
-          clusParams.Q_f_X[ic] = 0;
-          clusParams.Q_l_X[ic] = 0;
-          clusParams.Q_f_Y[ic] = 0;
-          clusParams.Q_l_Y[ic] = 0;
-        }
-
-        // one thead per "digi"
-
-        for (int i = first; i < numElements; i++) {
-          auto id = digis.moduleInd(i);
-          if (id == InvId)
-            continue;  // not valid
-          if (id != me)
-            break;  // end of module
-          auto cl = digis.clus(i);
-          if (cl < startClus || cl >= lastClus)
-            continue;
-          auto x = digis.xx(i);
-          auto y = digis.yy(i);
-          cl -= startClus;
-          assert(cl >= 0);
-          assert(cl < MaxHitsInIter);
-          atomicMin(&clusParams.minRow[cl], x);
-          atomicMax(&clusParams.maxRow[cl], x);
-          atomicMin(&clusParams.minCol[cl], y);
-          atomicMax(&clusParams.maxCol[cl], y);
-        }
-
-        // pixmx is not available in the binary dumps
-        //auto pixmx = cpeParams->detParams(me).pixmx;
-        auto pixmx = std::numeric_limits<uint16_t>::max();
-        for (int i = first; i < numElements; i++) {
-          auto id = digis.moduleInd(i);
-          if (id == InvId)
-            continue;  // not valid
-          if (id != me)
-            break;  // end of module
-          auto cl = digis.clus(i);
-          if (cl < startClus || cl >= lastClus)
-            continue;
-          cl -= startClus;
-          assert(cl >= 0);
-          assert(cl < MaxHitsInIter);
-          auto x = digis.xx(i);
-          auto y = digis.yy(i);
-          auto ch = std::min(digis.adc(i), pixmx);
-          atomicAdd(&clusParams.charge[cl], ch);
-          if (clusParams.minRow[cl] == x)
-            atomicAdd(&clusParams.Q_f_X[cl], ch);
-          if (clusParams.maxRow[cl] == x)
-            atomicAdd(&clusParams.Q_l_X[cl], ch);
-          if (clusParams.minCol[cl] == y)
-            atomicAdd(&clusParams.Q_f_Y[cl], ch);
-          if (clusParams.maxCol[cl] == y)
-            atomicAdd(&clusParams.Q_l_Y[cl], ch);
-        }
+#ifndef SERIAL_DISABLE_FUSED_CLUSTER_PARAMS
+        fillClusParams(moduleClusters, startClus, nClusInIter, clusParams);
+#else
+        accumulateClusParams(digis, first, numElements, me, startClus, nClusInIter, clusParams);
+#endif
 
         // next one cluster per thread...
 
         first = clusters.clusModuleStart(me) + startClus;
 
+        clusterPositions(cpeParams->commonParams(), cpeParams->detParams(me), clusParams, nClusInIter);
+
         for (int ic = 0; ic < nClusInIter; ic++) {
           auto h = first + ic;  // output index in global memory
 
@@ -166,9 +279,6 @@ namespace gpuPixelRecHits {
           assert(h < hits.nHits());
           assert(h < clusters.clusModuleStart(me + 1));
 
-          pixelCPEforGPU::position(cpeParams->commonParams(), cpeParams->detParams(me), clusParams, ic);
-          pixelCPEforGPU::errorFromDB(cpeParams->commonParams(), cpeParams->detParams(me), clusParams, ic);
-
           // store it
 
           hits.charge(h) = clusParams.charge[ic];
@@ -206,6 +316,50 @@ namespace gpuPixelRecHits {
     }    // loop over modules
   }
 
+  void getHits(pixelCPEforGPU::ParamsOnGPU const* __restrict__ cpeParams,
+               BeamSpotPOD const* __restrict__ bs,
+               SiPixelDigisSoA::DeviceConstView const* __restrict__ pdigis,
+               int numElements,
+               SiPixelClustersSoA::DeviceConstView const* __restrict__ pclusters,
+               TrackingRecHit2DSOAView* phits) {
+    assert(phits);
+    assert(cpeParams);
+
+    auto& hits = *phits;
+
+    // copy average geometry corrected by beamspot . FIXME (move it somewhere else???)
+
+    auto& agc = hits.averageGeometry();
+    auto const& ag = cpeParams->averageGeometry();
+    for (int il = 0, nl = TrackingRecHit2DSOAView::AverageGeometry::numberOfLaddersInBarrel; il < nl; il++) {
+      agc.ladderZ[il] = ag.ladderZ[il] - bs->z;
+      agc.ladderX[il] = ag.ladderX[il] - bs->x;
+      agc.ladderY[il] = ag.ladderY[il] - bs->y;
+      agc.ladderR[il] = sqrt(agc.ladderX[il] * agc.ladderX[il] + agc.ladderY[il] * agc.ladderY[il]);
+      agc.ladderMinZ[il] = ag.ladderMinZ[il] - bs->z;
+      agc.ladderMaxZ[il] = ag.ladderMaxZ[il] - bs->z;
+    }
+    agc.endCapZ[0] = ag.endCapZ[0] - bs->z;
+    agc.endCapZ[1] = ag.endCapZ[1] - bs->z;
+    //         printf("endcapZ %f %f\n",agc.endCapZ[0],agc.endCapZ[1]);
+
+    // as usual one block per module
+    uint32_t firstModule = 0;
+    auto endModule = pclusters->moduleStart(0);
+#ifdef SERIAL_ENABLE_INTRA_EVENT_PARALLELISM
+    // each task has its own scratch space
+    tbb::parallel_for(tbb::blocked_range<uint32_t>(firstModule, endModule),
+                      [&](tbb::blocked_range<uint32_t> const& range) {
+                        ClusParams clusParams;
+                        getHitsInModules(
+                            cpeParams, bs, pdigis, numElements, pclusters, phits, clusParams, range.begin(), range.end());
+                      });
+#else
+    ClusParams clusParams;
+    getHitsInModules(cpeParams, bs, pdigis, numElements, pclusters, phits, clusParams, firstModule, endModule);
+#endif
+  }
+
 }  // namespace gpuPixelRecHits
 
 #endif  // RecoLocalTracker_SiPixelRecHits_plugins_gpuPixelRecHits_h
@@ -0,0 +1,93 @@
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#include "CUDACore/SoALayout.h"
+
+using namespace cms::soa;
+
+struct Point {
+  float x, y, z;
+};
+
+using TestLayout = Layout<Column<uint16_t>, Column<float>, Column<int8_t, 16>, Array<uint32_t, 11>, Array<Point>>;
+
+template <typename L>
+bool isAligned(L const& layout, void const* ptr, size_t alignment) {
+  return (reinterpret_cast<uintptr_t>(ptr) - reinterpret_cast<uintptr_t>(layout.data())) % alignment == 0 and
+         reinterpret_cast<uintptr_t>(ptr) % alignment == 0;
+}
+
+void fill(TestLayout& layout) {
+  auto view = layout.view();
+  for (uint32_t i = 0; i < view.size(); ++i) {
+    view.get<0>(i) = i;
+    view.get<1>(i) = 0.5f * i;
+    view.get<2>(i) = i % 128;
+  }
+  for (uint32_t i = 0; i < 11; ++i) {
+    layout.get<3>()[i] = 3 * i;
+  }
+  *layout.get<4>() = Point{1.f, 2.f, 3.f};
+}
+
+void check(TestLayout const& layout, uint32_t n) {
+  assert(layout.size() == n);
+  TestLayout::ConstView view = layout.view();
+  for (uint32_t i = 0; i < n; ++i) {
+    assert(view.get<0>(i) == i);
+    assert(view.get<1>(i) == 0.5f * i);
+    assert(view.get<2>(i) == int8_t(i % 128));
+  }
+  for (uint32_t i = 0; i < 11; ++i) {
+    assert(view.get<3>(i) == 3 * i);
+  }
+  assert(view.get<4>(0).z == 3.f);
+}
+
+void go(uint32_t n) {
+  // the buffer is deliberately misaligned
+  auto bufferSize = TestLayout::bufferSize(n);
+  auto buffer = std::make_unique<std::byte[]>(bufferSize + 1);
+  TestLayout layout(buffer.get() + 1, bufferSize, n);
+
+  assert(TestLayout::alignment == 64);
+  assert(layout.dataSize() % 64 == 0);
+  assert(layout.data() >= buffer.get() + 1);
+  assert(layout.data() + layout.dataSize() <= buffer.get() + 1 + bufferSize);
+  assert(isAligned(layout, layout.get<0>(), 64));
+  assert(isAligned(layout, layout.get<1>(), 64));
+  assert(isAligned(layout, layout.get<2>(), 16));
+  assert(isAligned(layout, layout.get<3>(), 64));
+  assert(isAligned(layout, layout.get<4>(), 64));
+
+  // the columns follow each other and do not overlap
+  assert(reinterpret_cast<std::byte*>(layout.get<0>()) == layout.data());
+  assert(reinterpret_cast<std::byte*>(layout.get<1>()) >= reinterpret_cast<std::byte*>(layout.get<0>() + n));
+  assert(reinterpret_cast<std::byte*>(layout.get<2>()) >= reinterpret_cast<std::byte*>(layout.get<1>() + n));
+  assert(reinterpret_cast<std::byte*>(layout.get<3>()) >= reinterpret_cast<std::byte*>(layout.get<2>() + n));
+  assert(reinterpret_cast<std::byte*>(layout.get<4>()) >= reinterpret_cast<std::byte*>(layout.get<3>() + 11));
+  assert(reinterpret_cast<std::byte*>(layout.get<4>() + 1) <= layout.data() + layout.dataSize());
+
+  fill(layout);
+  check(layout, n);
+
+  // the data can be relocated as bytes, and used through a new layout with the same number of entries
+  std::vector<std::byte> copy(TestLayout::bufferSize(n));
+  TestLayout relocated(copy.data(), copy.size(), n);
+  std::memcpy(relocated.data(), layout.data(), layout.dataSize());
+  check(relocated, n);
+
+  std::cout << "SoA layout for " << n << " elements: " << layout.dataSize() << " bytes" << std::endl;
+}
+
+int main() {
+  go(0);
+  go(1);
+  go(100);
+  go(12345);
+  return 0;
+}
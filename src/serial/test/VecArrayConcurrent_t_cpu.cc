@@ -0,0 +1,86 @@
+#include <algorithm>
+#include <cassert>
+#include <iostream>
+#include <memory>
+#include <thread>
+#include <vector>
+
+#include "CUDACore/SimpleVector.h"
+#include "CUDACore/VecArray.h"
+
+using namespace cms::cuda;
+
+constexpr int nThreads = 8;
+constexpr int nPerThread = 20000;
+
+// several threads push the same values into a VecArray too small for all of them
+void pushToVecArray() {
+  constexpr int maxSize = nThreads * nPerThread / 2;
+  auto array = std::make_unique<VecArray<int, maxSize>>();
+  array->reset();
+
+  std::vector<int> failed(nThreads, 0);
+  std::vector<std::thread> threads;
+  for (int t = 0; t < nThreads; ++t) {
+    threads.emplace_back([&, t]() {
+      for (int i = 0; i < nPerThread; ++i) {
+        if (array->push_back_concurrent(t * nPerThread + i) < 0)
+          ++failed[t];
+      }
+    });
+  }
+  for (auto& thread : threads)
+    thread.join();
+
+  assert(array->full());
+  int nFailed = 0;
+  for (auto f : failed)
+    nFailed += f;
+  assert(nFailed == nThreads * nPerThread - maxSize);
+
+  // every value stored once
+  std::vector<int> values(array->begin(), array->end());
+  std::sort(values.begin(), values.end());
+  assert(std::adjacent_find(values.begin(), values.end()) == values.end());
+  assert(values.front() >= 0 and values.back() < nThreads * nPerThread);
+  std::cout << "VecArray: " << array->size() << " elements stored, " << nFailed << " rejected" << std::endl;
+}
+
+// several threads extend the same SimpleVector by different sizes
+void extendSimpleVector() {
+  constexpr int capacity = nThreads * nPerThread;
+  std::vector<int> data(capacity, -1);
+  auto vector = make_SimpleVector(capacity, data.data());
+
+  std::vector<std::thread> threads;
+  for (int t = 0; t < nThreads; ++t) {
+    threads.emplace_back([&, t]() {
+      int size = 1 + t % 3;
+      for (int i = 0; i < nPerThread; ++i) {
+        auto first = vector.extend_concurrent(size);
+        if (first < 0)
+          continue;
+        for (int k = 0; k < size; ++k)
+          data[first + k] = t;
+      }
+    });
+  }
+  for (auto& thread : threads)
+    thread.join();
+
+  // the slots are given out without overlaps, and the vector never goes beyond its capacity
+  assert(vector.size() <= capacity);
+  assert(std::count(data.begin(), data.begin() + vector.size(), -1) == 0);
+  std::vector<int> filled(nThreads, 0);
+  for (int i = 0; i < vector.size(); ++i)
+    ++filled[data[i]];
+  for (int t = 0; t < nThreads; ++t)
+    assert(filled[t] % (1 + t % 3) == 0);
+  std::cout << "SimpleVector: " << vector.size() << " elements out of " << capacity << std::endl;
+}
+
+int main() {
+  pushToVecArray();
+  extendSimpleVector();
+  return 0;
+}
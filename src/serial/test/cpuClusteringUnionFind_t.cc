@@ -0,0 +1,2 @@
+#define USE_UNION_FIND
+#include "gpuClustering_t.h"
@@ -12,6 +12,9 @@
 // dirty, but works
 #include "plugin-SiPixelClusterizer/gpuClustering.h"
 #include "plugin-SiPixelClusterizer/gpuClusterChargeCut.h"
+#ifdef USE_UNION_FIND
+#include "plugin-SiPixelClusterizer/cpuClustering.h"
+#endif
 
 int main(void) {
   using namespace gpuClustering;
@@ -27,6 +30,11 @@ int main(void) {
   auto h_moduleStart = std::make_unique<uint32_t[]>(MaxNumModules + 1);
   auto h_clusInModule = std::make_unique<uint32_t[]>(MaxNumModules);
   auto h_moduleId = std::make_unique<uint32_t[]>(MaxNumModules);
+#ifdef USE_UNION_FIND
+  auto h_clusUF = std::make_unique<int[]>(numElements);
+  auto h_clusInModuleUF = std::make_unique<uint32_t[]>(MaxNumModules);
+  auto h_moduleIdUF = std::make_unique<uint32_t[]>(MaxNumModules);
+#endif
 
   // later random number
   int n = 0;
@@ -218,10 +226,31 @@ int main(void) {
     countModules(h_id.get(), h_moduleStart.get(), h_clus.get(), n);
     memset(h_clusInModule.get(), 0, MaxNumModules * sizeof(uint32_t));
 
+#ifdef USE_UNION_FIND
+    std::copy(h_clus.get(), h_clus.get() + n, h_clusUF.get());
+    memset(h_clusInModuleUF.get(), 0, MaxNumModules * sizeof(uint32_t));
+#endif
+
     findClus(
         h_id.get(), h_x.get(), h_y.get(), h_moduleStart.get(), h_clusInModule.get(), h_moduleId.get(), h_clus.get(), n);
 
     nModules = h_moduleStart[0];
+
+#ifdef USE_UNION_FIND
+    // the union-find clustering must give exactly the same output
+    findClusUnionFind(h_id.get(),
+                      h_x.get(),
+                      h_y.get(),
+                      h_moduleStart.get(),
+                      h_clusInModuleUF.get(),
+                      h_moduleIdUF.get(),
+                      h_clusUF.get(),
+                      n);
+    assert(std::equal(h_clus.get(), h_clus.get() + n, h_clusUF.get()));
+    assert(std::equal(h_clusInModule.get(), h_clusInModule.get() + MaxNumModules, h_clusInModuleUF.get()));
+    assert(std::equal(h_moduleId.get(), h_moduleId.get() + nModules, h_moduleIdUF.get()));
+    std::cout << "union-find clustering agrees with findClus" << std::endl;
+#endif
     auto nclus = h_clusInModule.get();
 
     std::cout << "before charge cut found " << std::accumulate(nclus, nclus + MaxNumModules, 0) << " clusters"
@@ -287,5 +316,58 @@ int main(void) {
       }
     // << " and " << seeds.size() << " seeds" << std::endl;
   }  /// end loop kkk
+
+#ifdef USE_UNION_FIND
+  {
+    // a module with more pixels than findClus can handle: a grid of 2x2 clusters, with every
+    // pixel also duplicated, in a shuffled order
+    n = 0;
+    ncl = 0;
+    int id = 1000;
+    for (int x = 0; x + 1 < 160; x += 3) {
+      for (int yy = 0; yy + 1 < 416; yy += 3) {
+        ++ncl;
+        for (int k = 0; k < 8; ++k) {
+          h_id[n] = id;
+          h_x[n] = x + (k & 1);
+          h_y[n] = yy + ((k >> 1) & 1);
+          ++n;
+        }
+      }
+    }
+    std::cout << "created " << n << " digis in " << ncl << " clusters in a single module" << std::endl;
+    for (int i = 0; i < n; ++i) {
+      auto j = (i * 7919) % n;  // n is not a multiple of 7919
+      std::swap(h_x[i], h_x[j]);
+      std::swap(h_y[i], h_y[j]);
+    }
+    h_moduleStart[0] = 0;
+    countModules(h_id.get(), h_moduleStart.get(), h_clusUF.get(), n);
+    memset(h_clusInModuleUF.get(), 0, MaxNumModules * sizeof(uint32_t));
+    findClusUnionFind(h_id.get(),
+                      h_x.get(),
+                      h_y.get(),
+                      h_moduleStart.get(),
+                      h_clusInModuleUF.get(),
+                      h_moduleIdUF.get(),
+                      h_clusUF.get(),
+                      n);
+    std::cout << "found " << h_clusInModuleUF[id] << " clusters" << std::endl;
+    assert(1 == h_moduleStart[0]);
+    assert(ncl == int(h_clusInModuleUF[id]));
+    // all the pixels of each 2x2 cell in the same cluster, numbered in the order of their first pixel
+    std::vector<int> cellCluster(ncl, -1);
+    int next = 0;
+    for (int i = 0; i < n; ++i) {
+      auto cell = (h_x[i] / 3) * 139 + h_y[i] / 3;
+      assert(h_clusUF[i] >= 0 and h_clusUF[i] < ncl);
+      if (cellCluster[cell] < 0) {
+        assert(h_clusUF[i] == next);
+        cellCluster[cell] = next++;
+      }
+      assert(h_clusUF[i] == cellCluster[cell]);
+    }
+  }
+#endif
   return 0;
 }
@@ -0,0 +1,356 @@
+// Benchmark of the layout of the CA cells
+//
+// Compares the memory used by the cells of the CA, and the time per
+// event to connect them and to search the ntuplets, between the array
+// of GPUCACell of the pipeline (kernel_connect and kernel_find_ntuplets)
+// and the structure of arrays of CACellsSoA, and checks that both find
+// the same ntuplets, with the same tracks for each cell. The hits are
+// those of synthetic helix tracks from the beam line, with the magnetic
+// field of CMS, on an approximate phase-1 geometry (4 barrel layers and
+// 3 disks on each side), and of random noise hits; the doublets are
+// found by getDoubletsFromHisto with the default cuts, without the cuts
+// on the size of the clusters. The fishbone is not run.
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "CUDACore/HistoContainer.h"
+#include "CUDADataFormats/TrackingRecHit2DHeterogeneous.h"
+#include "CUDADataFormats/gpuClusteringConstants.h"
+#include "DataFormats/approx_atan2.h"
+
+// like the unit tests, use the header-only algorithms directly
+#include "plugin-PixelTriplets/CACellsSoA.h"
+#include "plugin-PixelTriplets/CAHitNtupletGeneratorKernelsImpl.h"
+
+namespace {
+  void print_help(std::string const& name) {
+    std::cout << name << ": [--numberOfEvents N] [--tracksPerEvent N] [--noiseHitsPerEvent N] [--seed S]\n\n"
+              << "Options\n"
+              << " --numberOfEvents    Number of events to generate (default 20)\n"
+              << " --tracksPerEvent    Mean number of tracks per event (default 2000)\n"
+              << " --noiseHitsPerEvent Mean number of noise hits per event (default 2000)\n"
+              << " --seed              Seed of the random number generator (default 42)\n"
+              << std::endl;
+  }
+
+  // approximate phase-1 geometry, in cm
+  constexpr float barrelR[4] = {2.9f, 6.8f, 10.9f, 16.0f};
+  constexpr float barrelHalfLength = 26.7f;
+  constexpr int laddersInBarrel[4] = {12, 28, 44, 64};
+  constexpr float diskZ[3] = {32.f, 39.5f, 48.8f};
+  constexpr float diskMinR = 4.5f;
+  constexpr float diskMaxR = 16.1f;
+  constexpr int modulesInDisk = 112;
+  constexpr uint32_t layerStart[11] = {0, 96, 320, 672, 1184, 1296, 1408, 1520, 1632, 1744, 1856};
+  // radius of curvature, in cm, of a track of 1 GeV in the field of 3.8 T
+  constexpr float radiusPerGeV = 87.7f;
+
+  struct Hit {
+    float x, y, z, r;
+    int16_t iphi;
+    uint16_t detIndex;
+  };
+
+  void addHit(std::mt19937_64& rng, std::vector<Hit>& layer, int il, float r, float phi, float z) {
+    std::normal_distribution<float> rphiError(0.f, 0.0015f);
+    std::normal_distribution<float> zError(0.f, 0.003f);
+    phi += rphiError(rng) / r;
+    z += zError(rng);
+    phi = std::remainder(phi, 2.f * float(M_PI));
+    float f = (phi + float(M_PI)) / (2.f * float(M_PI));
+    uint32_t module;
+    if (il < 4) {
+      int ladder = std::min(int(f * laddersInBarrel[il]), laddersInBarrel[il] - 1);
+      int ring = std::clamp(int((z + barrelHalfLength) / (2.f * barrelHalfLength) * 8), 0, 7);
+      module = layerStart[il] + 8 * ladder + ring;
+    } else {
+      module = layerStart[il] + std::min(int(f * modulesInDisk), modulesInDisk - 1);
+    }
+    layer.push_back({r * std::cos(phi), r * std::sin(phi), z, r, phi2short(phi), uint16_t(module)});
+  }
+
+  // the hits of an event, ordered by layer
+  std::unique_ptr<TrackingRecHit2DCPU> generate(std::mt19937_64& rng, int tracksPerEvent, int noiseHitsPerEvent) {
+    std::vector<std::vector<Hit>> layers(10);
+
+    std::uniform_real_distribution<float> phi(-float(M_PI), float(M_PI));
+    std::uniform_real_distribution<float> eta(-2.5f, 2.5f);
+    std::uniform_real_distribution<float> invPt(0.1f, 2.f);
+    std::normal_distribution<float> z0(0.f, 3.5f);
+    std::bernoulli_distribution positive(0.5);
+    int n = std::poisson_distribution<int>(tracksPerEvent)(rng);
+    for (int i = 0; i < n; ++i) {
+      float radius = radiusPerGeV / invPt(rng);
+      float q = positive(rng) ? 1.f : -1.f;
+      float phi0 = phi(rng);
+      float cotTheta = std::sinh(eta(rng));
+      float zv = z0(rng);
+      // at the transverse distance r from the beam line, the track has turned by 2 asin(r / 2R)
+      for (int il = 0; il < 4; ++il) {
+        float r = barrelR[il];
+        if (r >= 2.f * radius)
+          break;
+        float half = std::asin(r / (2.f * radius));
+        float z = zv + 2.f * radius * half * cotTheta;
+        if (std::abs(z) < barrelHalfLength)
+          addHit(rng, layers[il], il, r, phi0 - q * half, z);
+      }
+      for (int id = 0; id < 3; ++id) {
+        float z = cotTheta > 0 ? diskZ[id] : -diskZ[id];
+        float half = (z - zv) / cotTheta / (2.f * radius);
+        if (half <= 0 or half > float(M_PI) / 2)
+          continue;
+        float r = 2.f * radius * std::sin(half);
+        if (r > diskMinR and r < diskMaxR)
+          addHit(rng, layers[(cotTheta > 0 ? 4 : 7) + id], (cotTheta > 0 ? 4 : 7) + id, r, phi0 - q * half, z);
+      }
+    }
+
+    std::uniform_int_distribution<int> layer(0, 9);
+    std::uniform_real_distribution<float> barrelZ(-barrelHalfLength, barrelHalfLength);
+    std::uniform_real_distribution<float> diskR(diskMinR, diskMaxR);
+    n = std::poisson_distribution<int>(noiseHitsPerEvent)(rng);
+    for (int i = 0; i < n; ++i) {
+      int il = layer(rng);
+      if (il < 4)
+        addHit(rng, layers[il], il, barrelR[il], phi(rng), barrelZ(rng));
+      else
+        addHit(rng, layers[il], il, diskR(rng), phi(rng), il < 7 ? diskZ[il - 4] : -diskZ[il - 7]);
+    }
+
+    // as the clusters, the hits of each layer are ordered by module
+    uint32_t nHits = 0;
+    for (auto& hits : layers) {
+      std::stable_sort(
+          hits.begin(), hits.end(), [](Hit const& a, Hit const& b) { return a.detIndex < b.detIndex; });
+      hits.resize(std::min<uint32_t>(hits.size(), pixelGPUConstants::maxNumberOfHits - nHits));
+      nHits += hits.size();
+    }
+    auto event = std::make_unique<TrackingRecHit2DCPU>(nHits, nullptr, nullptr, nullptr);
+    auto& hh = *event->view();
+    uint32_t i = 0;
+    for (int il = 0; il < 10; ++il) {
+      event->hitsLayerStart()[il] = i;
+      for (auto const& hit : layers[il]) {
+        hh.xGlobal(i) = hit.x;
+        hh.yGlobal(i) = hit.y;
+        hh.zGlobal(i) = hit.z;
+        hh.rGlobal(i) = hit.r;
+        hh.iphi(i) = hit.iphi;
+        hh.detectorIndex(i) = hit.detIndex;
+        hh.charge(i) = 0;
+        hh.clusterSizeX(i) = -1;
+        hh.clusterSizeY(i) = -1;
+        ++i;
+      }
+    }
+    event->hitsLayerStart()[10] = nHits;
+    cms::cuda::fillManyFromVector(event->phiBinner(), 10, event->iphi(), event->hitsLayerStart(), nHits);
+    return event;
+  }
+
+  // the default cuts of CAHitNtupletGeneratorOnGPU
+  constexpr unsigned int minHitsPerNtuplet = 3;
+  constexpr uint32_t maxNumberOfDoublets = 458752;
+  constexpr float ptmin = 0.899999976158;
+  constexpr float CAThetaCutBarrel = 0.00200000009499;
+  constexpr float CAThetaCutForward = 0.00300000002608;
+  constexpr float hardCurvCut = 0.0328407224959;
+  constexpr float dcaCutInnerTriplet = 0.15000000596;
+  constexpr float dcaCutOuterTriplet = 0.25;
+
+  bool sameNtuplets(HitContainer const& a, HitContainer const& b, uint32_t n) {
+    for (uint32_t it = 0; it < n; ++it) {
+      if (not std::equal(a.begin(it), a.end(it), b.begin(it), b.end(it)))
+        return false;
+    }
+    return true;
+  }
+}  // namespace
+
+int main(int argc, char** argv) {
+  // Parse command line arguments
+  std::vector<std::string> args(argv, argv + argc);
+  int numberOfEvents = 20;
+  int tracksPerEvent = 2000;
+  int noiseHitsPerEvent = 2000;
+  unsigned long seed = 42;
+  for (auto i = args.begin() + 1, e = args.end(); i != e; ++i) {
+    if (*i == "-h" or *i == "--help") {
+      print_help(args.front());
+      return EXIT_SUCCESS;
+    } else if (*i == "--numberOfEvents") {
+      ++i;
+      numberOfEvents = std::stoi(*i);
+    } else if (*i == "--tracksPerEvent") {
+      ++i;
+      tracksPerEvent = std::stoi(*i);
+    } else if (*i == "--noiseHitsPerEvent") {
+      ++i;
+      noiseHitsPerEvent = std::stoi(*i);
+    } else if (*i == "--seed") {
+      ++i;
+      seed = std::stoul(*i);
+    } else {
+      std::cout << "Invalid parameter " << *i << std::endl << std::endl;
+      print_help(args.front());
+      return EXIT_FAILURE;
+    }
+  }
+  if (numberOfEvents <= 0 or tracksPerEvent < 0 or noiseHitsPerEvent < 0) {
+    std::cout << "Invalid configuration" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  // the buffers of the array of GPUCACell, allocated once as in CAHitNtupletGeneratorKernels
+  constexpr auto maxNumOfActiveDoublets = CAConstants::maxNumOfActiveDoublets();
+  auto isOuterHitOfCell = std::make_unique<GPUCACell::OuterHitOfCell>();
+  auto cells = std::make_unique<GPUCACell[]>(maxNumberOfDoublets);
+  auto cellNeighborsContainer = std::make_unique<GPUCACell::CellNeighbors[]>(maxNumOfActiveDoublets);
+  auto cellTracksContainer = std::make_unique<GPUCACell::CellTracks[]>(maxNumOfActiveDoublets);
+  GPUCACell::CellNeighborsVector cellNeighbors;
+  GPUCACell::CellTracksVector cellTracks;
+  auto tuples = std::make_unique<HitContainer>();
+  auto quality = std::make_unique<Quality[]>(HitContainer::nbins());
+
+  CACellsSoA cellsSoA;
+  auto tuplesSoA = std::make_unique<HitContainer>();
+  auto qualitySoA = std::make_unique<Quality[]>(HitContainer::nbins());
+
+  std::mt19937_64 rng(seed);
+  std::chrono::steady_clock::duration connect{}, find{}, connectSoA{}, findSoA{};
+  double nHits = 0, nCells = 0, nTuples = 0;
+  double usedBytes = 0, cellBytesSoA = 0, listBytesSoA = 0;
+  int overflows = 0, mismatches = 0;
+  for (int event = 0; event < numberOfEvents; ++event) {
+    auto hits = generate(rng, tracksPerEvent, noiseHitsPerEvent);
+    auto const* hh = hits->view();
+    uint32_t nCellsEvent = 0;
+    gpuPixelDoublets::initDoublets(isOuterHitOfCell.get(),
+                                   &cellNeighbors,
+                                   cellNeighborsContainer.get(),
+                                   &cellTracks,
+                                   cellTracksContainer.get());
+    gpuPixelDoublets::getDoubletsFromHisto(cells.get(),
+                                           &nCellsEvent,
+                                           &cellNeighbors,
+                                           &cellTracks,
+                                           hh,
+                                           isOuterHitOfCell.get(),
+                                           gpuPixelDoublets::nPairs,
+                                           true,   // idealConditions
+                                           false,  // doClusterCut
+                                           true,   // doZ0Cut
+                                           true,   // doPtCut
+                                           maxNumberOfDoublets);
+    cellsSoA.fill(*hh, cells.get(), nCellsEvent);
+
+    cms::cuda::AtomicPairCounter apc, apc2;
+    cms::cuda::launchZero(tuples.get());
+    auto start = std::chrono::steady_clock::now();
+    kernel_connect(&apc,
+                   &apc2,
+                   hh,
+                   cells.get(),
+                   &nCellsEvent,
+                   &cellNeighbors,
+                   isOuterHitOfCell.get(),
+                   hardCurvCut,
+                   ptmin,
+                   CAThetaCutBarrel,
+                   CAThetaCutForward,
+                   dcaCutInnerTriplet,
+                   dcaCutOuterTriplet);
+    auto connected = std::chrono::steady_clock::now();
+    kernel_find_ntuplets(
+        hh, cells.get(), &nCellsEvent, &cellTracks, tuples.get(), &apc, quality.get(), minHitsPerNtuplet);
+    auto stop = std::chrono::steady_clock::now();
+    connect += connected - start;
+    find += stop - connected;
+
+    cms::cuda::AtomicPairCounter apcSoA;
+    apcSoA = 0;
+    cms::cuda::launchZero(tuplesSoA.get());
+    start = std::chrono::steady_clock::now();
+    cellsSoA.connect(*hh,
+                     isOuterHitOfCell.get(),
+                     hardCurvCut,
+                     ptmin,
+                     CAThetaCutBarrel,
+                     CAThetaCutForward,
+                     dcaCutInnerTriplet,
+                     dcaCutOuterTriplet);
+    connected = std::chrono::steady_clock::now();
+    cellsSoA.findNtuplets(*tuplesSoA, apcSoA, qualitySoA.get(), minHitsPerNtuplet);
+    stop = std::chrono::steady_clock::now();
+    connectSoA += connected - start;
+    findSoA += stop - connected;
+
+    nHits += hits->nHits();
+    nCells += nCellsEvent;
+    nTuples += apc.get().m;
+    usedBytes += nCellsEvent * sizeof(GPUCACell) + cellNeighbors.size() * sizeof(GPUCACell::CellNeighbors) +
+                 cellTracks.size() * sizeof(GPUCACell::CellTracks);
+    cellBytesSoA += cellsSoA.cellBytes();
+    listBytesSoA += cellsSoA.listBytes();
+
+    // the lists of the GPUCACell are limited, those of CACellsSoA are not
+    bool overflow = cellNeighbors.full() or cellTracks.full() or apc.get().m >= HitContainer::nbins();
+    for (uint32_t i = 0; i < nCellsEvent; ++i) {
+      overflow = overflow or cells[i].outerNeighbors().full() or cells[i].tracks().full();
+    }
+    if (overflow) {
+      ++overflows;
+      continue;
+    }
+    bool same = apc.get().m == apcSoA.get().m and sameNtuplets(*tuples, *tuplesSoA, apc.get().m);
+    for (uint32_t i = 0; same and i < nCellsEvent; ++i) {
+      auto const& cell = cells[i];
+      same = cell.theUsed == cellsSoA.used(i) and
+             std::equal(cell.outerNeighbors().begin(),
+                        cell.outerNeighbors().end(),
+                        cellsSoA.neighborsBegin(i),
+                        cellsSoA.neighborsEnd(i)) and
+             std::equal(cell.tracks().begin(), cell.tracks().end(), cellsSoA.tracksBegin(i), cellsSoA.tracksEnd(i));
+    }
+    if (not same)
+      ++mismatches;
+  }
+
+  auto ms = [numberOfEvents](std::chrono::steady_clock::duration d) {
+    return std::chrono::duration<double, std::milli>(d).count() / numberOfEvents;
+  };
+  auto mb = [](double bytes) { return bytes / (1024. * 1024.); };
+  double allocatedBytes =
+      double(maxNumberOfDoublets) * sizeof(GPUCACell) +
+      double(maxNumOfActiveDoublets) * (sizeof(GPUCACell::CellNeighbors) + sizeof(GPUCACell::CellTracks));
+  std::cout << "Connected the cells of " << numberOfEvents << " events with on average " << std::fixed
+            << std::setprecision(0) << nHits / numberOfEvents << " hits, " << nCells / numberOfEvents << " cells and "
+            << nTuples / numberOfEvents << " ntuplets" << std::endl;
+  std::cout << std::setprecision(2) << "GPUCACell:  " << sizeof(GPUCACell) << " bytes per cell, " << mb(allocatedBytes)
+            << " MB allocated, " << mb(usedBytes / numberOfEvents) << " MB used per event; connect " << ms(connect)
+            << " ms, find ntuplets " << ms(find) << " ms" << std::endl;
+  std::cout << "CACellsSoA: " << cellsSoA.cellBytes() / std::max(1U, cellsSoA.size()) << " bytes per cell, "
+            << mb(cellBytesSoA / numberOfEvents) << " MB for the cells and " << mb(listBytesSoA / numberOfEvents)
+            << " MB for the lists per event; connect " << ms(connectSoA) << " ms, find ntuplets " << ms(findSoA)
+            << " ms" << std::endl;
+  if (overflows > 0) {
+    std::cout << overflows << " events not compared, because of an overflow of the lists of the GPUCACell" << std::endl;
+  }
+  if (mismatches > 0) {
+    std::cout << "ERROR: " << mismatches << " events with different ntuplets" << std::endl;
+    return EXIT_FAILURE;
+  }
+  std::cout << "Both layouts found the same ntuplets" << std::endl;
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,203 @@
+// Benchmark of the accumulation of the cluster parameters for the CPE
+//
+// Compares, for a single module with a given number of clusters, the
+// time per module of gpuPixelRecHits::accumulateClusParams (two passes
+// over all the digis of the module for each chunk of MaxHitsInIter
+// clusters, as on the GPU) and of gpuPixelRecHits::accumulateClusters
+// (a single pass over the digis for all the clusters, followed by the
+// copy of each chunk with fillClusParams), and checks that both give
+// the same parameters. Each cluster is a short random walk of pixels
+// in the module, and the digis are shuffled, as they come in the order
+// of the readout rather than of the clusters.
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "CUDACore/HostBufferPool.h"
+#include "CUDADataFormats/SiPixelDigisSoA.h"
+#include "CUDADataFormats/gpuClusteringConstants.h"
+#include "Geometry/phase1PixelTopology.h"
+
+// like the unit tests, use the header-only algorithms directly
+#include "plugin-SiPixelRecHits/gpuPixelRecHits.h"
+
+namespace {
+  void print_help(std::string const& name) {
+    std::cout << name << ": [--repetitions N] [--clusterSize S] [--seed S] [clusters per module ...]\n\n"
+              << "Options\n"
+              << " --repetitions      Number of times each module is processed (default 2000)\n"
+              << " --clusterSize      Mean number of pixels per cluster (default 4)\n"
+              << " --seed             Seed of the random number generator (default 42)\n"
+              << " clusters per module Numbers of clusters in the module (default 1 10 50 160 400 1024)\n"
+              << std::endl;
+  }
+
+  constexpr uint16_t kModule = 1;
+
+  // the digis of a module with nclus clusters, in random order
+  struct Module {
+    std::vector<uint16_t> x;
+    std::vector<uint16_t> y;
+    std::vector<uint16_t> adc;
+    std::vector<int32_t> clus;
+  };
+
+  Module generate(std::mt19937_64& rng, int nclus, float clusterSize) {
+    using namespace phase1PixelTopology;
+    std::uniform_int_distribution<int> row(0, numRowsInModule - 1);
+    std::uniform_int_distribution<int> col(0, numColsInModule - 1);
+    std::geometric_distribution<int> size(1. / clusterSize);
+    std::uniform_int_distribution<int> direction(0, 2);
+    std::uniform_int_distribution<int> charge(1000, 20000);
+
+    std::vector<int> order;
+    Module module;
+    for (int cl = 0; cl < nclus; ++cl) {
+      int x = row(rng);
+      int y = col(rng);
+      for (int k = 1 + size(rng); k > 0 and x < numRowsInModule and y < numColsInModule; --k) {
+        order.push_back(order.size());
+        module.x.push_back(x);
+        module.y.push_back(y);
+        module.adc.push_back(charge(rng));
+        module.clus.push_back(cl);
+        auto d = direction(rng);
+        x += (d != 1);
+        y += (d != 0);
+      }
+    }
+    std::shuffle(order.begin(), order.end(), rng);
+    Module shuffled;
+    for (auto i : order) {
+      shuffled.x.push_back(module.x[i]);
+      shuffled.y.push_back(module.y[i]);
+      shuffled.adc.push_back(module.adc[i]);
+      shuffled.clus.push_back(module.clus[i]);
+    }
+    return shuffled;
+  }
+
+  bool sameParams(gpuPixelRecHits::ClusParams const& a, gpuPixelRecHits::ClusParams const& b, int n) {
+    for (int ic = 0; ic < n; ++ic) {
+      if (a.minRow[ic] != b.minRow[ic] or a.maxRow[ic] != b.maxRow[ic] or a.minCol[ic] != b.minCol[ic] or
+          a.maxCol[ic] != b.maxCol[ic] or a.charge[ic] != b.charge[ic] or a.Q_f_X[ic] != b.Q_f_X[ic] or
+          a.Q_l_X[ic] != b.Q_l_X[ic] or a.Q_f_Y[ic] != b.Q_f_Y[ic] or a.Q_l_Y[ic] != b.Q_l_Y[ic]) {
+        return false;
+      }
+    }
+    return true;
+  }
+}  // namespace
+
+int main(int argc, char** argv) {
+  // Parse command line arguments
+  std::vector<std::string> args(argv, argv + argc);
+  int repetitions = 2000;
+  float clusterSize = 4;
+  unsigned long seed = 42;
+  std::vector<int> occupancies;
+  for (auto i = args.begin() + 1, e = args.end(); i != e; ++i) {
+    if (*i == "-h" or *i == "--help") {
+      print_help(args.front());
+      return EXIT_SUCCESS;
+    } else if (*i == "--repetitions") {
+      ++i;
+      repetitions = std::stoi(*i);
+    } else if (*i == "--clusterSize") {
+      ++i;
+      clusterSize = std::stof(*i);
+    } else if (*i == "--seed") {
+      ++i;
+      seed = std::stoul(*i);
+    } else if (not i->empty() and std::isdigit((*i)[0])) {
+      occupancies.push_back(std::stoi(*i));
+    } else {
+      std::cout << "Invalid parameter " << *i << std::endl << std::endl;
+      print_help(args.front());
+      return EXIT_FAILURE;
+    }
+  }
+  if (occupancies.empty()) {
+    occupancies = {1, 10, 50, 160, 400, 1024};
+  }
+  if (repetitions <= 0 or clusterSize < 1 or
+      std::any_of(occupancies.begin(), occupancies.end(), [](int n) {
+        return n <= 0 or n > int(gpuClustering::MaxNumClustersPerModules);
+      })) {
+    std::cout << "Invalid configuration" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  constexpr int32_t MaxHitsInIter = pixelCPEforGPU::MaxHitsInIter;
+  std::mt19937_64 rng(seed);
+  cms::cuda::HostBufferPool pool;
+  gpuPixelRecHits::ClusParams clusParams;
+  gpuPixelRecHits::ClusParams fusedParams;
+  std::vector<gpuPixelRecHits::ClusterAccumulator> clusters(gpuClustering::MaxNumClustersPerModules);
+  int mismatches = 0;
+
+  std::cout << "clusters    digis   two passes per chunk   single pass   speedup" << std::endl;
+  for (int nclus : occupancies) {
+    auto module = generate(rng, nclus, clusterSize);
+    int n = module.x.size();
+    SiPixelDigisSoA digis(n, pool);
+    std::fill(digis.moduleInd(), digis.moduleInd() + n, kModule);
+    std::copy(module.x.begin(), module.x.end(), digis.xx());
+    std::copy(module.y.begin(), module.y.end(), digis.yy());
+    std::copy(module.adc.begin(), module.adc.end(), digis.adc());
+    std::copy(module.clus.begin(), module.clus.end(), digis.clus());
+    auto const& view = *digis.view();
+
+    // the time of the chunks only, as getHitsInModules would spend them before the CPE
+    std::chrono::steady_clock::duration time{};
+    std::chrono::steady_clock::duration timeFused{};
+    for (int r = 0; r < repetitions; ++r) {
+      auto start = std::chrono::steady_clock::now();
+      for (int startClus = 0; startClus < nclus; startClus += MaxHitsInIter) {
+        int nClusInIter = std::min(MaxHitsInIter, nclus - startClus);
+        gpuPixelRecHits::accumulateClusParams(view, 0, n, kModule, startClus, nClusInIter, clusParams);
+      }
+      auto stop = std::chrono::steady_clock::now();
+      gpuPixelRecHits::accumulateClusters(view, 0, n, kModule, nclus, clusters.data());
+      for (int startClus = 0; startClus < nclus; startClus += MaxHitsInIter) {
+        int nClusInIter = std::min(MaxHitsInIter, nclus - startClus);
+        gpuPixelRecHits::fillClusParams(clusters.data(), startClus, nClusInIter, fusedParams);
+      }
+      auto stopFused = std::chrono::steady_clock::now();
+      time += stop - start;
+      timeFused += stopFused - stop;
+    }
+
+    // compare each chunk
+    for (int startClus = 0; startClus < nclus; startClus += MaxHitsInIter) {
+      int nClusInIter = std::min(MaxHitsInIter, nclus - startClus);
+      gpuPixelRecHits::accumulateClusParams(view, 0, n, kModule, startClus, nClusInIter, clusParams);
+      gpuPixelRecHits::fillClusParams(clusters.data(), startClus, nClusInIter, fusedParams);
+      if (not sameParams(clusParams, fusedParams, nClusInIter)) {
+        ++mismatches;
+      }
+    }
+
+    auto us = [repetitions](std::chrono::steady_clock::duration d) {
+      return std::chrono::duration<double, std::micro>(d).count() / repetitions;
+    };
+    std::cout << std::fixed << std::setw(8) << nclus << std::setw(9) << n << std::setprecision(3) << std::setw(20)
+              << us(time) << " us" << std::setw(11) << us(timeFused) << " us" << std::setprecision(2) << std::setw(10)
+              << us(time) / us(timeFused) << std::endl;
+  }
+
+  if (mismatches > 0) {
+    std::cout << "ERROR: " << mismatches << " chunks with different parameters" << std::endl;
+    return EXIT_FAILURE;
+  }
+  std::cout << "Both versions accumulated the same parameters" << std::endl;
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,219 @@
+// Benchmark of the pixel clustering algorithms
+//
+// Compares the time per event of gpuClustering::findClus (the GPU
+// algorithm, ran sequentially) and of gpuClustering::findClusUnionFind
+// on synthetic events of configurable occupancy, and checks that both
+// give the same clusters. The pixels are distributed over the modules
+// with a higher density in the innermost barrel layer, as small
+// clusters from charged particles plus isolated noise pixels, and a
+// fraction of them are duplicated, as can happen in the raw data.
+//
+// The modules with more pixels than findClus can handle are counted,
+// and excluded from the comparison.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+// like the unit tests, use the header-only algorithms directly
+#include "plugin-SiPixelClusterizer/cpuClustering.h"
+#include "plugin-SiPixelClusterizer/gpuClustering.h"
+
+namespace {
+  void print_help(std::string const& name) {
+    std::cout << name << ": [--numberOfEvents N] [--pixelsPerEvent N] [--clusterSize S] [--seed S]\n\n"
+              << "Options\n"
+              << " --numberOfEvents   Number of events to generate (default 20)\n"
+              << " --pixelsPerEvent   Mean number of pixels per event (default 200000, about a pileup of 200)\n"
+              << " --clusterSize      Mean number of pixels per cluster (default 4)\n"
+              << " --seed             Seed of the random number generator (default 42)\n"
+              << std::endl;
+  }
+
+  constexpr uint32_t kMaxPixInModule = 4000;  // as in findClus
+
+  struct Digis {
+    std::vector<uint16_t> id;
+    std::vector<uint16_t> x;
+    std::vector<uint16_t> y;
+  };
+
+  Digis generate(std::mt19937_64& rng, int pixelsPerEvent, float clusterSize) {
+    using namespace phase1PixelTopology;
+    constexpr int nModules = gpuClustering::MaxNumModules;
+    constexpr int nBPix1 = 96;
+    // the innermost layer has about 4 times the density of the other modules
+    std::discrete_distribution<int> module({4. * nBPix1, double(nModules - nBPix1)});
+    std::uniform_int_distribution<int> inBPix1(0, nBPix1 - 1);
+    std::uniform_int_distribution<int> outside(nBPix1, nModules - 1);
+    std::uniform_int_distribution<int> row(0, numRowsInModule - 1);
+    std::uniform_int_distribution<int> col(0, numColsInModule - 1);
+    std::geometric_distribution<int> size(1. / clusterSize);
+    std::uniform_int_distribution<int> direction(0, 2);
+    std::bernoulli_distribution duplicate(0.02);
+    std::bernoulli_distribution invalid(0.001);
+
+    std::vector<std::vector<std::pair<uint16_t, uint16_t>>> pixels(nModules);
+    int n = std::poisson_distribution<int>(pixelsPerEvent)(rng);
+    for (int i = 0; i < n;) {
+      auto& m = pixels[module(rng) == 0 ? inBPix1(rng) : outside(rng)];
+      // a random walk from a random pixel, that never goes back to a pixel already visited
+      int x = row(rng);
+      int y = col(rng);
+      for (int k = 1 + size(rng); k > 0 and i < n and x < numRowsInModule and y < numColsInModule; --k, ++i) {
+        m.emplace_back(x, y);
+        if (duplicate(rng))
+          m.emplace_back(x, y);
+        auto d = direction(rng);
+        x += (d != 1);
+        y += (d != 0);
+      }
+    }
+
+    // the pixels of each module are contiguous, ordered as in the readout only within each column
+    Digis digis;
+    for (int m = 0; m < nModules; ++m) {
+      std::shuffle(pixels[m].begin(), pixels[m].end(), rng);
+      std::stable_sort(pixels[m].begin(), pixels[m].end(), [](auto const& a, auto const& b) {
+        return a.second / 2 < b.second / 2;
+      });
+      for (auto const& [x, y] : pixels[m]) {
+        digis.id.push_back(invalid(rng) ? gpuClustering::InvId : m);
+        digis.x.push_back(x);
+        digis.y.push_back(y);
+      }
+    }
+    return digis;
+  }
+}  // namespace
+
+int main(int argc, char** argv) {
+  // Parse command line arguments
+  std::vector<std::string> args(argv, argv + argc);
+  int numberOfEvents = 20;
+  int pixelsPerEvent = 200000;
+  float clusterSize = 4;
+  unsigned long seed = 42;
+  for (auto i = args.begin() + 1, e = args.end(); i != e; ++i) {
+    if (*i == "-h" or *i == "--help") {
+      print_help(args.front());
+      return EXIT_SUCCESS;
+    } else if (*i == "--numberOfEvents") {
+      ++i;
+      numberOfEvents = std::stoi(*i);
+    } else if (*i == "--pixelsPerEvent") {
+      ++i;
+      pixelsPerEvent = std::stoi(*i);
+    } else if (*i == "--clusterSize") {
+      ++i;
+      clusterSize = std::stof(*i);
+    } else if (*i == "--seed") {
+      ++i;
+      seed = std::stoul(*i);
+    } else {
+      std::cout << "Invalid parameter " << *i << std::endl << std::endl;
+      print_help(args.front());
+      return EXIT_FAILURE;
+    }
+  }
+  if (numberOfEvents <= 0 or pixelsPerEvent <= 0 or clusterSize < 1) {
+    std::cout << "Invalid configuration" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  using namespace gpuClustering;
+  std::mt19937_64 rng(seed);
+  auto moduleStart = std::make_unique<uint32_t[]>(MaxNumModules + 1);
+  auto clusInModule = std::make_unique<uint32_t[]>(MaxNumModules);
+  auto clusInModuleUF = std::make_unique<uint32_t[]>(MaxNumModules);
+  auto moduleId = std::make_unique<uint32_t[]>(MaxNumModules);
+  auto moduleIdUF = std::make_unique<uint32_t[]>(MaxNumModules);
+
+  std::chrono::steady_clock::duration time{};
+  std::chrono::steady_clock::duration timeUF{};
+  long totalPixels = 0;
+  long totalClusters = 0;
+  int largeModules = 0;
+  int mismatches = 0;
+  for (int event = 0; event < numberOfEvents; ++event) {
+    auto digis = generate(rng, pixelsPerEvent, clusterSize);
+    int n = digis.id.size();
+    totalPixels += n;
+    std::vector<int32_t> clus(n);
+    std::vector<int32_t> clusUF(n);
+
+    moduleStart[0] = 0;
+    std::memset(clusInModule.get(), 0, MaxNumModules * sizeof(uint32_t));
+    std::memset(clusInModuleUF.get(), 0, MaxNumModules * sizeof(uint32_t));
+    countModules(digis.id.data(), moduleStart.get(), clus.data(), n);
+    clusUF = clus;
+
+    auto start = std::chrono::steady_clock::now();
+    findClus(digis.id.data(),
+             digis.x.data(),
+             digis.y.data(),
+             moduleStart.get(),
+             clusInModule.get(),
+             moduleId.get(),
+             clus.data(),
+             n);
+    auto stop = std::chrono::steady_clock::now();
+    findClusUnionFind(digis.id.data(),
+                      digis.x.data(),
+                      digis.y.data(),
+                      moduleStart.get(),
+                      clusInModuleUF.get(),
+                      moduleIdUF.get(),
+                      clusUF.data(),
+                      n);
+    auto stopUF = std::chrono::steady_clock::now();
+    time += stop - start;
+    timeUF += stopUF - stop;
+
+    // compare the modules findClus could handle
+    uint32_t nModules = moduleStart[0];
+    for (uint32_t m = 0; m < nModules; ++m) {
+      uint32_t first = moduleStart[m + 1];
+      uint32_t last = first;
+      while (last < uint32_t(n) and (digis.id[last] == moduleIdUF[m] or digis.id[last] == InvId))
+        ++last;
+      totalClusters += clusInModuleUF[moduleIdUF[m]];
+      if (last - first > kMaxPixInModule) {
+        ++largeModules;
+        continue;
+      }
+      if (moduleId[m] != moduleIdUF[m] or clusInModule[moduleId[m]] != clusInModuleUF[moduleIdUF[m]] or
+          not std::equal(clus.begin() + first, clus.begin() + last, clusUF.begin() + first)) {
+        ++mismatches;
+      }
+    }
+  }
+
+  auto ms = [numberOfEvents](std::chrono::steady_clock::duration d) {
+    return std::chrono::duration<double, std::milli>(d).count() / numberOfEvents;
+  };
+  std::cout << "Clustered " << numberOfEvents << " events with on average " << totalPixels / numberOfEvents
+            << " pixels in " << totalClusters / numberOfEvents << " clusters" << std::endl;
+  std::cout << std::fixed << std::setprecision(3) << "findClus           " << std::setw(10) << ms(time)
+            << " ms per event\n"
+            << "findClusUnionFind  " << std::setw(10) << ms(timeUF) << " ms per event, speedup "
+            << std::setprecision(2) << ms(time) / ms(timeUF) << std::endl;
+  if (largeModules > 0) {
+    std::cout << largeModules << " modules with more than " << kMaxPixInModule
+              << " pixels are truncated by findClus, and not compared" << std::endl;
+  }
+  if (mismatches > 0) {
+    std::cout << "ERROR: " << mismatches << " modules with different clusters" << std::endl;
+    return EXIT_FAILURE;
+  }
+  std::cout << "Both algorithms found the same clusters" << std::endl;
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,250 @@
+// Benchmark of the selection of the CA doublets
+//
+// Compares, for each of the 19 layer pairs, the time per event of
+// gpuPixelDoublets::doubletsFromHit testing the candidate outer hits
+// one at a time (the scalar loop) and by tiles in a loop without
+// branches (the vectorized loop), and checks that both select the same
+// doublets in the same order. The hits are built by
+// gpuPixelRecHits::getHits, with the CPE parameters of the data
+// directory, from synthetic clusters distributed over the modules as in
+// benchmarkRecHits; the cuts are those of the default configuration.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "CUDACore/HistoContainer.h"
+#include "CUDACore/HostBufferPool.h"
+#include "CUDADataFormats/SiPixelClustersSoA.h"
+#include "CUDADataFormats/SiPixelDigisSoA.h"
+#include "CUDADataFormats/TrackingRecHit2DHeterogeneous.h"
+#include "CUDADataFormats/gpuClusteringConstants.h"
+#include "CondFormats/PixelCPEFast.h"
+#include "DataFormats/BeamSpotPOD.h"
+
+// like the unit tests, use the header-only algorithms directly
+#include "plugin-PixelTriplets/gpuPixelDoublets.h"
+#include "plugin-SiPixelRecHits/gpuPixelRecHits.h"
+
+namespace {
+  void print_help(std::string const& name) {
+    std::cout << name << ": [--numberOfEvents N] [--clustersPerEvent N] [--seed S] [--data PATH]\n\n"
+              << "Options\n"
+              << " --numberOfEvents   Number of events to generate (default 20)\n"
+              << " --clustersPerEvent Mean number of clusters per event (default 50000, about a pileup of 200)\n"
+              << " --seed             Seed of the random number generator (default 42)\n"
+              << " --data             Path to the 'data' directory with cpefast.bin (default 'data' in the directory "
+                 "of the executable)\n"
+              << std::endl;
+  }
+
+  constexpr uint32_t kMaxClusInModule = gpuClustering::maxHitsInModule();
+
+  // the digis and clusters of an event, as after the clustering, with clusters of 1 to 4 pixels
+  void generate(std::mt19937_64& rng, int clustersPerEvent, SiPixelDigisSoA& digis, SiPixelClustersSoA& clusters) {
+    using namespace phase1PixelTopology;
+    constexpr int nModules = gpuClustering::MaxNumModules;
+    constexpr int nBPix1 = 96;
+    // the innermost layer has about 4 times the density of the other modules
+    std::discrete_distribution<int> module({4. * nBPix1, double(numberOfModules - nBPix1)});
+    std::uniform_int_distribution<int> inBPix1(0, nBPix1 - 1);
+    std::uniform_int_distribution<int> outside(nBPix1, numberOfModules - 1);
+    std::uniform_int_distribution<int> row(0, numRowsInModule - 2);
+    std::uniform_int_distribution<int> col(0, numColsInModule - 2);
+    std::uniform_int_distribution<int> size(0, 3);
+    std::uniform_int_distribution<int> charge(1000, 20000);
+
+    std::vector<std::vector<std::pair<uint16_t, uint16_t>>> pixels(nModules);
+    std::vector<std::vector<int32_t>> clusterOfPixel(nModules);
+    std::vector<uint32_t> clusInModule(nModules, 0);
+    int n = std::poisson_distribution<int>(clustersPerEvent)(rng);
+    for (int i = 0; i < n; ++i) {
+      int m = module(rng) == 0 ? inBPix1(rng) : outside(rng);
+      if (clusInModule[m] == kMaxClusInModule)
+        continue;
+      int32_t cluster = clusInModule[m]++;
+      int x = row(rng);
+      int y = col(rng);
+      int s = size(rng);
+      for (int k = 0; k <= s; ++k) {
+        pixels[m].emplace_back(x + k % 2, y + k / 2);
+        clusterOfPixel[m].push_back(cluster);
+      }
+    }
+
+    uint32_t nDigis = 0;
+    uint32_t nModulesWithDigis = 0;
+    for (int m = 0; m < nModules; ++m) {
+      if (not pixels[m].empty()) {
+        clusters.moduleStart()[1 + nModulesWithDigis] = nDigis;
+        clusters.moduleId()[nModulesWithDigis] = m;
+        ++nModulesWithDigis;
+      }
+      for (size_t i = 0; i < pixels[m].size(); ++i, ++nDigis) {
+        digis.moduleInd()[nDigis] = m;
+        digis.xx()[nDigis] = pixels[m][i].first;
+        digis.yy()[nDigis] = pixels[m][i].second;
+        digis.adc()[nDigis] = charge(rng);
+        digis.clus()[nDigis] = clusterOfPixel[m][i];
+      }
+    }
+    clusters.moduleStart()[0] = nModulesWithDigis;
+    std::copy(clusInModule.begin(), clusInModule.end(), clusters.clusInModule());
+    clusters.clusModuleStart()[0] = 0;
+    for (int m = 0; m < nModules; ++m) {
+      clusters.clusModuleStart()[m + 1] = clusters.clusModuleStart()[m] + clusInModule[m];
+    }
+    digis.setNModulesDigis(nModulesWithDigis, nDigis);
+    clusters.setNClusters(clusters.clusModuleStart()[nModules]);
+  }
+
+  using Doublets = std::vector<std::pair<uint32_t, uint32_t>>;
+
+  template <bool vectorized>
+  void doubletsOfPair(TrackingRecHit2DSOAView const& hh, uint32_t pairLayerId, Doublets& doublets) {
+    using namespace gpuPixelDoublets;
+    auto const* offsets = hh.hitsLayerStart();
+    uint8_t inner = layerPairs[2 * pairLayerId];
+    for (auto i = offsets[inner]; i < offsets[inner + 1]; ++i) {
+      doubletsFromHit<vectorized>(layerPairs,
+                                  pairLayerId,
+                                  i,
+                                  hh,
+                                  phicuts,
+                                  minz,
+                                  maxz,
+                                  maxr,
+                                  true,  // idealConditions
+                                  true,  // doClusterCut
+                                  true,  // doZ0Cut
+                                  true,  // doPtCut
+                                  [&](uint32_t oi) {
+                                    doublets.emplace_back(i, oi);
+                                    return true;
+                                  });
+    }
+  }
+}  // namespace
+
+int main(int argc, char** argv) {
+  // Parse command line arguments
+  std::vector<std::string> args(argv, argv + argc);
+  int numberOfEvents = 20;
+  int clustersPerEvent = 50000;
+  unsigned long seed = 42;
+  std::filesystem::path datadir;
+  for (auto i = args.begin() + 1, e = args.end(); i != e; ++i) {
+    if (*i == "-h" or *i == "--help") {
+      print_help(args.front());
+      return EXIT_SUCCESS;
+    } else if (*i == "--numberOfEvents") {
+      ++i;
+      numberOfEvents = std::stoi(*i);
+    } else if (*i == "--clustersPerEvent") {
+      ++i;
+      clustersPerEvent = std::stoi(*i);
+    } else if (*i == "--seed") {
+      ++i;
+      seed = std::stoul(*i);
+    } else if (*i == "--data") {
+      ++i;
+      datadir = *i;
+    } else {
+      std::cout << "Invalid parameter " << *i << std::endl << std::endl;
+      print_help(args.front());
+      return EXIT_FAILURE;
+    }
+  }
+  if (numberOfEvents <= 0 or clustersPerEvent <= 0) {
+    std::cout << "Invalid configuration" << std::endl;
+    return EXIT_FAILURE;
+  }
+  if (datadir.empty()) {
+    datadir = std::filesystem::path(args[0]).parent_path() / "data";
+  }
+  if (not std::filesystem::exists(datadir / "cpefast.bin")) {
+    std::cout << "CPE parameters " << datadir / "cpefast.bin" << " do not exist" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  PixelCPEFast cpe((datadir / "cpefast.bin").string());
+  auto const* cpeParams = &cpe.getCPUProduct();
+  BeamSpotPOD bs{};
+  cms::cuda::HostBufferPool pool;
+
+  constexpr int nPairs = gpuPixelDoublets::nPairs;
+  std::mt19937_64 rng(seed);
+  std::vector<std::chrono::steady_clock::duration> time(nPairs);
+  std::vector<std::chrono::steady_clock::duration> timeVectorized(nPairs);
+  std::vector<long> nDoublets(nPairs, 0);
+  int mismatches = 0;
+  Doublets doublets;
+  Doublets doubletsVectorized;
+  for (int event = 0; event < numberOfEvents; ++event) {
+    // at most 4 pixels per cluster
+    SiPixelDigisSoA digis(4 * clustersPerEvent + 1000, pool);
+    SiPixelClustersSoA clusters(gpuClustering::MaxNumModules, pool);
+    generate(rng, clustersPerEvent, digis, clusters);
+    uint32_t nHits = clusters.nClusters();
+    TrackingRecHit2DCPU hits(nHits, cpeParams, clusters.clusModuleStart(), nullptr);
+    gpuPixelRecHits::getHits(cpeParams, &bs, digis.view(), digis.nDigis(), clusters.view(), hits.view());
+    for (int i = 0; i < 11; ++i) {
+      hits.hitsLayerStart()[i] = clusters.clusModuleStart()[cpeParams->layerGeometry().layerStart[i]];
+    }
+    cms::cuda::fillManyFromVector(hits.phiBinner(), 10, hits.iphi(), hits.hitsLayerStart(), nHits);
+    auto const& hh = *hits.view();
+
+    for (int pairLayerId = 0; pairLayerId < nPairs; ++pairLayerId) {
+      doublets.clear();
+      doubletsVectorized.clear();
+      auto start = std::chrono::steady_clock::now();
+      doubletsOfPair<false>(hh, pairLayerId, doublets);
+      auto stop = std::chrono::steady_clock::now();
+      doubletsOfPair<true>(hh, pairLayerId, doubletsVectorized);
+      auto stopVectorized = std::chrono::steady_clock::now();
+      time[pairLayerId] += stop - start;
+      timeVectorized[pairLayerId] += stopVectorized - stop;
+      nDoublets[pairLayerId] += doublets.size();
+      if (doublets != doubletsVectorized) {
+        ++mismatches;
+      }
+    }
+  }
+
+  auto us = [numberOfEvents](std::chrono::steady_clock::duration d) {
+    return std::chrono::duration<double, std::micro>(d).count() / numberOfEvents;
+  };
+  std::cout << "Selected the doublets of " << numberOfEvents << " events with on average " << clustersPerEvent
+            << " clusters" << std::endl;
+  std::cout << "pair  layers   doublets       scalar   vectorized   speedup" << std::endl;
+  std::chrono::steady_clock::duration total{};
+  std::chrono::steady_clock::duration totalVectorized{};
+  for (int pairLayerId = 0; pairLayerId < nPairs; ++pairLayerId) {
+    total += time[pairLayerId];
+    totalVectorized += timeVectorized[pairLayerId];
+    std::cout << std::fixed << std::setw(4) << pairLayerId << std::setw(5)
+              << int(gpuPixelDoublets::layerPairs[2 * pairLayerId]) << "-" << std::left << std::setw(2)
+              << int(gpuPixelDoublets::layerPairs[2 * pairLayerId + 1]) << std::right << std::setw(11)
+              << nDoublets[pairLayerId] / numberOfEvents << std::setprecision(1) << std::setw(10)
+              << us(time[pairLayerId]) << " us" << std::setw(10) << us(timeVectorized[pairLayerId]) << " us"
+              << std::setprecision(2) << std::setw(10) << us(time[pairLayerId]) / us(timeVectorized[pairLayerId])
+              << std::endl;
+  }
+  std::cout << std::setprecision(1) << "all pairs" << std::setw(34) << us(total) << " us" << std::setw(10)
+            << us(totalVectorized) << " us" << std::setprecision(2) << std::setw(10) << us(total) / us(totalVectorized)
+            << std::endl;
+  if (mismatches > 0) {
+    std::cout << "ERROR: " << mismatches << " layer pairs with different doublets" << std::endl;
+    return EXIT_FAILURE;
+  }
+  std::cout << "Both versions selected the same doublets" << std::endl;
+  return EXIT_SUCCESS;
+}
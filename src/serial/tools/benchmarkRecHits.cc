@@ -0,0 +1,275 @@
+// Benchmark of the pixel RecHit building
+//
+// Compares the time per event of gpuPixelRecHits::getHitsInModules
+// running sequentially over all the modules, as getHits does by
+// default, and split over the modules with tbb::parallel_for, as
+// getHits does with SERIAL_ENABLE_INTRA_EVENT_PARALLELISM, on synthetic
+// events of configurable occupancy, and checks that both give the same
+// hits. The CPE parameters are read from the cpefast.bin file of the
+// data directory. The clusters are distributed over the modules with a
+// higher density in the innermost barrel layer, as in
+// benchmarkClustering, and each cluster is a short random walk of
+// pixels in its module.
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <tbb/blocked_range.h>
+#include <tbb/global_control.h>
+#include <tbb/info.h>
+#include <tbb/parallel_for.h>
+
+#include "CUDACore/HostBufferPool.h"
+#include "CUDADataFormats/SiPixelClustersSoA.h"
+#include "CUDADataFormats/SiPixelDigisSoA.h"
+#include "CUDADataFormats/TrackingRecHit2DHeterogeneous.h"
+#include "CUDADataFormats/gpuClusteringConstants.h"
+#include "CondFormats/PixelCPEFast.h"
+#include "DataFormats/BeamSpotPOD.h"
+
+// like the unit tests, use the header-only algorithms directly
+#include "plugin-SiPixelRecHits/gpuPixelRecHits.h"
+
+namespace {
+  void print_help(std::string const& name) {
+    std::cout << name
+              << ": [--numberOfEvents N] [--clustersPerEvent N] [--clusterSize S] [--numberOfThreads T] [--seed S] "
+                 "[--data PATH]\n\n"
+              << "Options\n"
+              << " --numberOfEvents   Number of events to generate (default 20)\n"
+              << " --clustersPerEvent Mean number of clusters per event (default 50000, about a pileup of 200)\n"
+              << " --clusterSize      Mean number of pixels per cluster (default 4)\n"
+              << " --numberOfThreads  Number of threads of the parallel version (default: all the cores)\n"
+              << " --seed             Seed of the random number generator (default 42)\n"
+              << " --data             Path to the 'data' directory with cpefast.bin (default 'data' in the directory "
+                 "of the executable)\n"
+              << std::endl;
+  }
+
+  constexpr uint32_t kMaxClusInModule = gpuClustering::maxHitsInModule();
+
+  // the digis are laid out module after module, and numbered by cluster within each module, as after the clustering
+  struct Event {
+    std::vector<uint16_t> id;
+    std::vector<uint16_t> x;
+    std::vector<uint16_t> y;
+    std::vector<uint16_t> adc;
+    std::vector<int32_t> clus;
+    std::vector<uint32_t> clusInModule = std::vector<uint32_t>(gpuClustering::MaxNumModules, 0);
+  };
+
+  Event generate(std::mt19937_64& rng, int clustersPerEvent, float clusterSize) {
+    using namespace phase1PixelTopology;
+    constexpr int nModules = gpuClustering::MaxNumModules;
+    constexpr int nBPix1 = 96;
+    // the innermost layer has about 4 times the density of the other modules
+    std::discrete_distribution<int> module({4. * nBPix1, double(numberOfModules - nBPix1)});
+    std::uniform_int_distribution<int> inBPix1(0, nBPix1 - 1);
+    std::uniform_int_distribution<int> outside(nBPix1, numberOfModules - 1);
+    std::uniform_int_distribution<int> row(0, numRowsInModule - 1);
+    std::uniform_int_distribution<int> col(0, numColsInModule - 1);
+    std::geometric_distribution<int> size(1. / clusterSize);
+    std::uniform_int_distribution<int> direction(0, 2);
+    std::uniform_int_distribution<int> charge(1000, 20000);
+
+    Event event;
+    std::vector<std::vector<std::pair<uint16_t, uint16_t>>> pixels(nModules);
+    std::vector<std::vector<int32_t>> clusters(nModules);
+    int n = std::poisson_distribution<int>(clustersPerEvent)(rng);
+    for (int i = 0; i < n; ++i) {
+      int m = module(rng) == 0 ? inBPix1(rng) : outside(rng);
+      if (event.clusInModule[m] == kMaxClusInModule)
+        continue;
+      int32_t cluster = event.clusInModule[m]++;
+      int x = row(rng);
+      int y = col(rng);
+      for (int k = 1 + size(rng); k > 0 and x < numRowsInModule and y < numColsInModule; --k) {
+        pixels[m].emplace_back(x, y);
+        clusters[m].push_back(cluster);
+        auto d = direction(rng);
+        x += (d != 1);
+        y += (d != 0);
+      }
+    }
+
+    for (int m = 0; m < nModules; ++m) {
+      for (size_t i = 0; i < pixels[m].size(); ++i) {
+        event.id.push_back(m);
+        event.x.push_back(pixels[m][i].first);
+        event.y.push_back(pixels[m][i].second);
+        event.adc.push_back(charge(rng));
+        event.clus.push_back(clusters[m][i]);
+      }
+    }
+    return event;
+  }
+
+  // the digis and clusters products of the event, as filled by the clustering
+  void fill(Event const& event, SiPixelDigisSoA& digis, SiPixelClustersSoA& clusters) {
+    uint32_t n = event.id.size();
+    std::copy(event.id.begin(), event.id.end(), digis.moduleInd());
+    std::copy(event.x.begin(), event.x.end(), digis.xx());
+    std::copy(event.y.begin(), event.y.end(), digis.yy());
+    std::copy(event.adc.begin(), event.adc.end(), digis.adc());
+    std::copy(event.clus.begin(), event.clus.end(), digis.clus());
+
+    uint32_t nModules = 0;
+    for (uint32_t i = 0; i < n; ++i) {
+      if (i == 0 or event.id[i] != event.id[i - 1]) {
+        clusters.moduleStart()[1 + nModules] = i;
+        clusters.moduleId()[nModules] = event.id[i];
+        ++nModules;
+      }
+    }
+    clusters.moduleStart()[0] = nModules;
+    std::copy(event.clusInModule.begin(), event.clusInModule.end(), clusters.clusInModule());
+    clusters.clusModuleStart()[0] = 0;
+    for (uint32_t m = 0; m < gpuClustering::MaxNumModules; ++m) {
+      clusters.clusModuleStart()[m + 1] = clusters.clusModuleStart()[m] + event.clusInModule[m];
+    }
+    digis.setNModulesDigis(nModules, n);
+    clusters.setNClusters(clusters.clusModuleStart()[gpuClustering::MaxNumModules]);
+  }
+
+  bool sameHits(TrackingRecHit2DSOAView const& a, TrackingRecHit2DSOAView const& b, uint32_t nHits) {
+    for (uint32_t i = 0; i < nHits; ++i) {
+      if (a.xLocal(i) != b.xLocal(i) or a.yLocal(i) != b.yLocal(i) or a.xerrLocal(i) != b.xerrLocal(i) or
+          a.yerrLocal(i) != b.yerrLocal(i) or a.xGlobal(i) != b.xGlobal(i) or a.yGlobal(i) != b.yGlobal(i) or
+          a.zGlobal(i) != b.zGlobal(i) or a.rGlobal(i) != b.rGlobal(i) or a.iphi(i) != b.iphi(i) or
+          a.charge(i) != b.charge(i) or a.clusterSizeX(i) != b.clusterSizeX(i) or
+          a.clusterSizeY(i) != b.clusterSizeY(i) or a.detectorIndex(i) != b.detectorIndex(i)) {
+        return false;
+      }
+    }
+    return true;
+  }
+}  // namespace
+
+int main(int argc, char** argv) {
+  // Parse command line arguments
+  std::vector<std::string> args(argv, argv + argc);
+  int numberOfEvents = 20;
+  int clustersPerEvent = 50000;
+  float clusterSize = 4;
+  int numberOfThreads = tbb::info::default_concurrency();
+  unsigned long seed = 42;
+  std::filesystem::path datadir;
+  for (auto i = args.begin() + 1, e = args.end(); i != e; ++i) {
+    if (*i == "-h" or *i == "--help") {
+      print_help(args.front());
+      return EXIT_SUCCESS;
+    } else if (*i == "--numberOfEvents") {
+      ++i;
+      numberOfEvents = std::stoi(*i);
+    } else if (*i == "--clustersPerEvent") {
+      ++i;
+      clustersPerEvent = std::stoi(*i);
+    } else if (*i == "--clusterSize") {
+      ++i;
+      clusterSize = std::stof(*i);
+    } else if (*i == "--numberOfThreads") {
+      ++i;
+      numberOfThreads = std::stoi(*i);
+    } else if (*i == "--seed") {
+      ++i;
+      seed = std::stoul(*i);
+    } else if (*i == "--data") {
+      ++i;
+      datadir = *i;
+    } else {
+      std::cout << "Invalid parameter " << *i << std::endl << std::endl;
+      print_help(args.front());
+      return EXIT_FAILURE;
+    }
+  }
+  if (numberOfEvents <= 0 or clustersPerEvent <= 0 or clusterSize < 1 or numberOfThreads <= 0) {
+    std::cout << "Invalid configuration" << std::endl;
+    return EXIT_FAILURE;
+  }
+  if (datadir.empty()) {
+    datadir = std::filesystem::path(args[0]).parent_path() / "data";
+  }
+  if (not std::filesystem::exists(datadir / "cpefast.bin")) {
+    std::cout << "CPE parameters " << datadir / "cpefast.bin" << " do not exist" << std::endl;
+    return EXIT_FAILURE;
+  }
+
+  tbb::global_control control(tbb::global_control::max_allowed_parallelism, numberOfThreads);
+  PixelCPEFast cpe((datadir / "cpefast.bin").string());
+  auto const* cpeParams = &cpe.getCPUProduct();
+  BeamSpotPOD bs{};
+  cms::cuda::HostBufferPool pool;
+
+  std::mt19937_64 rng(seed);
+  std::chrono::steady_clock::duration time{};
+  std::chrono::steady_clock::duration timeParallel{};
+  long totalHits = 0;
+  int mismatches = 0;
+  for (int event = 0; event < numberOfEvents; ++event) {
+    auto generated = generate(rng, clustersPerEvent, clusterSize);
+    int n = generated.id.size();
+    SiPixelDigisSoA digis(n, pool);
+    SiPixelClustersSoA clusters(gpuClustering::MaxNumModules, pool);
+    fill(generated, digis, clusters);
+    uint32_t nHits = clusters.nClusters();
+    totalHits += nHits;
+
+    TrackingRecHit2DCPU hits(nHits, cpeParams, clusters.clusModuleStart(), nullptr);
+    TrackingRecHit2DCPU hitsParallel(nHits, cpeParams, clusters.clusModuleStart(), nullptr);
+    uint32_t endModule = clusters.moduleStart()[0];
+
+    auto start = std::chrono::steady_clock::now();
+    {
+      gpuPixelRecHits::ClusParams clusParams;
+      gpuPixelRecHits::getHitsInModules(
+          cpeParams, &bs, digis.view(), n, clusters.view(), hits.view(), clusParams, 0, endModule);
+    }
+    auto stop = std::chrono::steady_clock::now();
+    // as in getHits, each task has its own scratch space
+    tbb::parallel_for(tbb::blocked_range<uint32_t>(0, endModule), [&](tbb::blocked_range<uint32_t> const& range) {
+      gpuPixelRecHits::ClusParams clusParams;
+      gpuPixelRecHits::getHitsInModules(cpeParams,
+                                        &bs,
+                                        digis.view(),
+                                        n,
+                                        clusters.view(),
+                                        hitsParallel.view(),
+                                        clusParams,
+                                        range.begin(),
+                                        range.end());
+    });
+    auto stopParallel = std::chrono::steady_clock::now();
+    time += stop - start;
+    timeParallel += stopParallel - stop;
+
+    if (not sameHits(*hits.view(), *hitsParallel.view(), nHits)) {
+      ++mismatches;
+    }
+  }
+
+  auto ms = [numberOfEvents](std::chrono::steady_clock::duration d) {
+    return std::chrono::duration<double, std::milli>(d).count() / numberOfEvents;
+  };
+  std::cout << "Built the hits of " << numberOfEvents << " events with on average " << totalHits / numberOfEvents
+            << " clusters" << std::endl;
+  std::cout << std::fixed << std::setprecision(3) << "sequential         " << std::setw(10) << ms(time)
+            << " ms per event\n"
+            << "parallel_for       " << std::setw(10) << ms(timeParallel) << " ms per event with " << numberOfThreads
+            << " threads, speedup " << std::setprecision(2) << ms(time) / ms(timeParallel) << std::endl;
+  if (mismatches > 0) {
+    std::cout << "ERROR: " << mismatches << " events with different hits" << std::endl;
+    return EXIT_FAILURE;
+  }
+  std::cout << "Both versions built the same hits" << std::endl;
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,818 @@
+// Generator of synthetic input data for the serial program
+//
+// Writes a self-consistent set of input files (raw.bin, beamspot.bin,
+// fedIds.bin, cablingMap.bin, gain.bin, cpefast.bin) that can be used
+// instead of the data tarball, e.g. on machines without network
+// access, or to benchmark events larger than the ones of the sample.
+//
+// The detector is a simplified version of the Phase 1 pixel detector,
+// with the same module numbering (see Geometry/phase1PixelTopology.h):
+// 4 barrel layers of flat ladders of 8 modules, and 3+3 forward disks
+// of 112 modules in two rings. Charged particles from a configurable
+// number of pileup interactions are propagated as helices in a uniform
+// magnetic field, the charge they deposit in the modules they cross is
+// shared among the pixels along their path, and the pixels above
+// threshold are packed in FED buffers following the format expected by
+// SiPixelRawToClusterGPUKernel. Random noise pixels can be added on top.
+//
+// The files needed by --validation are not produced.
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "CondFormats/SiPixelFedCablingMapGPU.h"
+#include "CondFormats/SiPixelGainForHLTonGPU.h"
+#include "CondFormats/pixelCPEforGPU.h"
+#include "DataFormats/BeamSpotPOD.h"
+#include "DataFormats/FEDHeader.h"
+#include "DataFormats/FEDTrailer.h"
+#include "Geometry/phase1PixelTopology.h"
+
+namespace {
+  void print_help(std::string const& name) {
+    std::cout
+        << name
+        << ": [--data PATH] [--numberOfEvents N] [--pileup PU] [--tracksPerInteraction N] [--minPt PT] "
+           "[--noiseOccupancy F] [--seed S]\n\n"
+        << "Options\n"
+        << " --data                   Directory where to write the files (default 'data'), created if needed\n"
+        << " --numberOfEvents         Number of events to generate (default 100)\n"
+        << " --pileup                 Number of interactions per event (default 50)\n"
+        << " --tracksPerInteraction   Mean number of charged particles per interaction (default 60)\n"
+        << " --minPt                  Minimum transverse momentum of the particles in GeV (default 0.2)\n"
+        << " --noiseOccupancy         Fraction of the pixels of each module with a noise hit (default 1e-5)\n"
+        << " --seed                   Seed of the random number generator (default 42)\n"
+        << std::endl;
+  }
+
+  // Phase 1 pixel detector, simplified
+  constexpr float kThicknessB = 0.0285f;  // cm
+  constexpr float kThicknessE = 0.029f;   // cm
+  constexpr float kPitchX = 0.01f;        // cm
+  constexpr float kPitchY = 0.015f;       // cm
+  constexpr float kHalfWidth = 0.5f * kPitchX * (phase1PixelTopology::numRowsInModule + 2);
+  constexpr float kHalfLength = 0.5f * kPitchY * (phase1PixelTopology::numColsInModule + 16);
+  constexpr float kModuleSpacingZ = 6.7f;  // barrel modules along z, as assumed by the CA
+  constexpr int kModulesPerLadder = 8;
+
+  constexpr std::array<float, 4> kBarrelRadius = {{2.95f, 6.8f, 10.9f, 16.0f}};
+  constexpr std::array<int, 4> kBarrelLadders = {{12, 28, 44, 64}};
+  constexpr float kLadderStagger = 0.2f;  // even ladders are outer, odd ladders inner
+
+  constexpr std::array<float, 3> kDiskZ = {{31.6f, 39.0f, 48.4f}};
+  constexpr float kPanelDz = 0.4f;  // panel 1 is closer to the interaction point than panel 2
+  constexpr std::array<float, 2> kRingRadius = {{7.5f, 12.8f}};
+  constexpr std::array<int, 2> kRingBlades = {{22, 34}};
+
+  // 2 links of 8 ROCs per module, 48 links per FED
+  constexpr int kFirstFed = 1200;
+  constexpr int kModulesPerFed = pixelgpudetails::MAX_LINK / 2;
+  constexpr int kNumberOfFeds = (phase1PixelTopology::numberOfModules + kModulesPerFed - 1) / kModulesPerFed;
+  static_assert(kNumberOfFeds <= int(pixelgpudetails::MAX_FED));
+
+  // charge and calibration
+  constexpr float kBField = 3.8f;                  // T
+  constexpr float kChargePerThickness = 22000.f;   // electrons for a track crossing the sensor at normal incidence
+  constexpr float kPixelThreshold = 1000.f;        // electrons
+  constexpr float kDiffusion = 0.0007f;            // cm
+  constexpr float kVCaltoElectronGain = 47.f;      // as in gpuCalibPixel.h
+  constexpr float kVCaltoElectronGain_L1 = 50.f;
+  constexpr float kVCaltoElectronOffset = -60.f;
+  constexpr float kVCaltoElectronOffset_L1 = -670.f;
+  constexpr unsigned int kGainBins = 253;
+  constexpr float kMinPed = 0.f, kMaxPed = 100.f;
+  constexpr float kMinGain = 0.5f, kMaxGain = 5.f;
+
+  constexpr uint32_t kInvalid = 9999;
+
+  // raw data format, as in SiPixelRawToClusterGPUKernel.h
+  constexpr uint32_t kLayerStartBit = 20;
+  constexpr uint32_t kModuleStartBit = 2;
+  constexpr uint32_t kLayerMask = 0xF;
+  constexpr uint32_t kModuleMask = 0x3FF;
+  constexpr uint32_t kAdcShift = 0;
+  constexpr uint32_t kPxidShift = 8;
+  constexpr uint32_t kDcolShift = 16;
+  constexpr uint32_t kRocShift = 21;
+  constexpr uint32_t kLinkShift = 26;
+  constexpr uint32_t kRowShiftL1 = 8;  // layer 1
+  constexpr uint32_t kColShiftL1 = 15;
+  constexpr uint32_t kMaxWordsPerFed = 2000;
+
+  struct Pixel {
+    uint32_t row;
+    uint32_t col;
+  };
+
+  struct Module {
+    uint32_t rawId;
+    bool barrel;
+    uint16_t layer;  // barrel layer or forward disk, starting from 1
+    float thickness;
+    pixelCPEforGPU::Frame frame;
+  };
+
+  struct Vec3 {
+    float x, y, z;
+  };
+
+  Vec3 toLocal(Module const& m, Vec3 const& g) {
+    Vec3 l;
+    m.frame.toLocal(g.x, g.y, g.z, l.x, l.y, l.z);
+    return l;
+  }
+
+  Vec3 rotateToLocal(Module const& m, Vec3 const& g) {
+    Vec3 l;
+    m.frame.rotation().multiply(g.x, g.y, g.z, l.x, l.y, l.z);
+    return l;
+  }
+
+  uint32_t barrelRawId(uint32_t layer, uint32_t ladder, uint32_t module) {
+    return (1u << 28) | (1u << 25) | (layer << 20) | (ladder << 12) | (module << 2);
+  }
+
+  uint32_t endcapRawId(uint32_t side, uint32_t disk, uint32_t blade, uint32_t panel) {
+    return (1u << 28) | (2u << 25) | (side << 23) | (disk << 18) | (blade << 12) | (panel << 10) | (1u << 2);
+  }
+
+  // local x along the rows, local y along the columns, local z away from the interaction point
+  pixelCPEforGPU::Frame barrelFrame(float r, float phi, float z) {
+    float c = std::cos(phi), s = std::sin(phi);
+    return pixelCPEforGPU::Frame(r * c, r * s, z, pixelCPEforGPU::Rotation(-s, c, 0, 0, 0, 1, c, s, 0));
+  }
+
+  pixelCPEforGPU::Frame endcapFrame(float r, float phi, float z) {
+    float c = std::cos(phi), s = std::sin(phi);
+    if (z > 0) {
+      return pixelCPEforGPU::Frame(r * c, r * s, z, pixelCPEforGPU::Rotation(s, -c, 0, c, s, 0, 0, 0, 1));
+    }
+    return pixelCPEforGPU::Frame(r * c, r * s, z, pixelCPEforGPU::Rotation(-s, c, 0, c, s, 0, 0, 0, -1));
+  }
+
+  float ladderPhi(int layer, int ladder) { return 2.f * float(M_PI) * (ladder + 0.5f) / kBarrelLadders[layer]; }
+  float ladderRadius(int layer, int ladder) {
+    return kBarrelRadius[layer] + (ladder % 2 == 0 ? kLadderStagger : -kLadderStagger);
+  }
+  float bladePhi(int ring, int blade, int panel) {
+    return 2.f * float(M_PI) * (blade + 0.5f * panel) / kRingBlades[ring];
+  }
+
+  std::vector<Module> makeGeometry() {
+    std::vector<Module> modules(phase1PixelTopology::numberOfModules);
+    for (int layer = 0; layer < 4; ++layer) {
+      for (int ladder = 0; ladder < kBarrelLadders[layer]; ++ladder) {
+        for (int m = 0; m < kModulesPerLadder; ++m) {
+          auto& mod = modules[phase1PixelTopology::layerStart[layer] + ladder * kModulesPerLadder + m];
+          mod.rawId = barrelRawId(layer + 1, ladder + 1, m + 1);
+          mod.barrel = true;
+          mod.layer = layer + 1;
+          mod.thickness = kThicknessB;
+          mod.frame = barrelFrame(
+              ladderRadius(layer, ladder), ladderPhi(layer, ladder), (m + 0.5f - 0.5f * kModulesPerLadder) * kModuleSpacingZ);
+        }
+      }
+    }
+    for (int layer = 4; layer < 10; ++layer) {
+      bool posZ = layer < 7;
+      int disk = posZ ? layer - 4 : layer - 7;
+      int index = phase1PixelTopology::layerStart[layer];
+      for (int ring = 0, blade = 0; ring < 2; ++ring) {
+        for (int b = 0; b < kRingBlades[ring]; ++b, ++blade) {
+          for (int panel = 0; panel < 2; ++panel, ++index) {
+            float z = kDiskZ[disk] + (panel == 0 ? -kPanelDz : kPanelDz);
+            auto& mod = modules[index];
+            mod.rawId = endcapRawId(posZ ? 2 : 1, disk + 1, blade + 1, panel + 1);
+            mod.barrel = false;
+            mod.layer = disk + 1;
+            mod.thickness = kThicknessE;
+            mod.frame = endcapFrame(kRingRadius[ring], bladePhi(ring, b, panel), posZ ? z : -z);
+          }
+        }
+      }
+      assert(index == int(phase1PixelTopology::layerStart[layer + 1]));
+    }
+    return modules;
+  }
+
+  // inverse of phase1PixelTopology::localX() and localY(), in units of pitch
+  int rowFromLocal(float u) {
+    if (u < 0)
+      return -1;
+    int iu = int(u);
+    if (iu < 79)
+      return iu;
+    if (iu < 81)
+      return 79;
+    if (iu < 83)
+      return 80;
+    return iu - 2 < phase1PixelTopology::numRowsInModule ? iu - 2 : -1;
+  }
+
+  int colFromLocal(float v) {
+    if (v < 0)
+      return -1;
+    int roc = int(v / 54.f);
+    if (roc >= 8)
+      return -1;
+    float w = v - 54.f * roc;
+    int yInRoc = w < 2.f ? 0 : std::min(int(w) - 1, 51);
+    return 52 * roc + yInRoc;
+  }
+
+  // same as frameConversion() in SiPixelRawToClusterGPUKernel.cc
+  Pixel frameConversion(
+      bool bpix, int side, uint32_t layer, uint32_t rocIdInDetUnit, Pixel local) {
+    int slopeRow = 0, slopeCol = 0;
+    int rowOffset = 0, colOffset = 0;
+    if ((bpix and side == -1 and layer != 1) or not bpix) {
+      if (rocIdInDetUnit < 8) {
+        slopeRow = 1;
+        slopeCol = -1;
+        rowOffset = 0;
+        colOffset = (8 - rocIdInDetUnit) * phase1PixelTopology::numColsInRoc - 1;
+      } else {
+        slopeRow = -1;
+        slopeCol = 1;
+        rowOffset = 2 * phase1PixelTopology::numRowsInRoc - 1;
+        colOffset = (rocIdInDetUnit - 8) * phase1PixelTopology::numColsInRoc;
+      }
+    } else {
+      if (rocIdInDetUnit < 8) {
+        slopeRow = -1;
+        slopeCol = 1;
+        rowOffset = 2 * phase1PixelTopology::numRowsInRoc - 1;
+        colOffset = rocIdInDetUnit * phase1PixelTopology::numColsInRoc;
+      } else {
+        slopeRow = 1;
+        slopeCol = -1;
+        rowOffset = 0;
+        colOffset = (16 - rocIdInDetUnit) * phase1PixelTopology::numColsInRoc - 1;
+      }
+    }
+    return {rowOffset + slopeRow * local.row, colOffset + slopeCol * local.col};
+  }
+
+  // for each pixel of the module, the ROC and the pixel in the ROC
+  struct RocPixel {
+    uint8_t roc;
+    uint8_t row;
+    uint8_t col;
+  };
+  using InverseFrame = std::vector<RocPixel>;
+
+  InverseFrame makeInverseFrame(bool bpix, int side, uint32_t layer) {
+    InverseFrame inverse(phase1PixelTopology::numPixsInModule);
+    for (uint32_t roc = 0; roc < 16; ++roc) {
+      for (uint32_t row = 0; row < phase1PixelTopology::numRowsInRoc; ++row) {
+        for (uint32_t col = 0; col < phase1PixelTopology::numColsInRoc; ++col) {
+          auto global = frameConversion(bpix, side, layer, roc, {row, col});
+          assert(global.row < phase1PixelTopology::numRowsInModule);
+          assert(global.col < phase1PixelTopology::numColsInModule);
+          inverse[global.row * phase1PixelTopology::numColsInModule + global.col] =
+              RocPixel{uint8_t(roc), uint8_t(row), uint8_t(col)};
+        }
+      }
+    }
+    return inverse;
+  }
+
+  // the same decoding of the module position as in RawToDigi_kernel
+  InverseFrame const& inverseFrame(uint32_t rawId) {
+    static const InverseFrame barrelMinus = makeInverseFrame(true, -1, 2);
+    static const InverseFrame barrelPlus = makeInverseFrame(true, 1, 2);
+    static const InverseFrame forward = makeInverseFrame(false, 1, 0);
+    if (1 != ((rawId >> 25) & 0x7)) {
+      return forward;
+    }
+    uint32_t layer = (rawId >> kLayerStartBit) & kLayerMask;
+    uint32_t module = (rawId >> kModuleStartBit) & kModuleMask;
+    return (module < 5 and layer != 1) ? barrelMinus : barrelPlus;
+  }
+
+  uint32_t packWord(uint32_t link, uint32_t roc, RocPixel const& pix, bool layer1, uint32_t adc) {
+    uint32_t word = (link << kLinkShift) | (roc << kRocShift) |
+                    (adc << kAdcShift);
+    if (layer1) {
+      return word | (uint32_t(pix.col) << kColShiftL1) |
+             (uint32_t(pix.row) << kRowShiftL1);
+    }
+    uint32_t dcol = pix.col / 2;
+    uint32_t pxid = 2 * (phase1PixelTopology::numRowsInRoc - pix.row) + pix.col % 2;
+    return word | (dcol << kDcolShift) | (pxid << kPxidShift);
+  }
+
+  // calibration, stored per column and block of 80 rows as in SiPixelGainForHLTonGPU
+  struct Calibration {
+    std::unique_ptr<SiPixelGainForHLTonGPU> gain;
+    std::vector<SiPixelGainForHLTonGPU_DecodingStructure> data;
+
+    uint32_t adc(uint32_t module, int row, int col, float electrons) const {
+      auto const& s =
+          data[(gain->rangeAndCols[module].first.first + col * 4) / 2 + row / gain->numberOfRowsAveragedOver_];
+      float ped = gain->decodePed(s.ped);
+      float g = gain->decodeGain(s.gain);
+      bool l1 = module < phase1PixelTopology::layerStart[1];
+      float conversion = l1 ? kVCaltoElectronGain_L1 : kVCaltoElectronGain;
+      float offset = l1 ? kVCaltoElectronOffset_L1 : kVCaltoElectronOffset;
+      int adc = std::lround(ped + (electrons - offset) / (conversion * g));
+      return std::clamp(adc, 1, 255);
+    }
+  };
+
+  Calibration makeCalibration(std::mt19937_64& rng) {
+    Calibration calib;
+    calib.gain = std::make_unique<SiPixelGainForHLTonGPU>();
+    auto& gain = *calib.gain;
+    std::memset(static_cast<void*>(&gain), 0, sizeof(SiPixelGainForHLTonGPU));
+    gain.minPed_ = kMinPed;
+    gain.maxPed_ = kMaxPed;
+    gain.minGain_ = kMinGain;
+    gain.maxGain_ = kMaxGain;
+    gain.nBinsToUseForEncoding_ = kGainBins;
+    gain.pedPrecision = (kMaxPed - kMinPed) / kGainBins;
+    gain.gainPrecision = (kMaxGain - kMinGain) / kGainBins;
+    gain.numberOfRowsAveragedOver_ = 80;
+    gain.deadFlag_ = 255;
+    gain.noisyFlag_ = 254;
+
+    constexpr uint32_t blocks = phase1PixelTopology::numRowsInModule / 80;
+    constexpr uint32_t bytesPerModule = phase1PixelTopology::numColsInModule * blocks * 2;
+    std::normal_distribution<float> pedestal(20.f, 2.f);
+    std::normal_distribution<float> gainValue(3.f, 0.15f);
+    calib.data.resize(phase1PixelTopology::numberOfModules * bytesPerModule / 2);
+    for (uint32_t i = 0; i < phase1PixelTopology::numberOfModules; ++i) {
+      gain.rangeAndCols[i] = {{i * bytesPerModule, (i + 1) * bytesPerModule}, phase1PixelTopology::numColsInModule};
+    }
+    for (auto& s : calib.data) {
+      s.ped = std::clamp<int>(std::lround((pedestal(rng) - kMinPed) / gain.pedPrecision), 0, kGainBins);
+      s.gain = std::clamp<int>(std::lround((gainValue(rng) - kMinGain) / gain.gainPrecision), 0, kGainBins);
+    }
+    return calib;
+  }
+
+  struct Particle {
+    Vec3 vertex;
+    float pt, phi, cotTheta;
+    int charge;
+
+    float radius() const { return pt / (0.003f * kBField); }  // cm
+
+    // position and direction after a transverse path length s
+    Vec3 position(float s) const {
+      float r = radius() / charge;
+      float psi = phi - s / r;
+      return {vertex.x + r * (std::sin(phi) - std::sin(psi)),
+              vertex.y + r * (std::cos(psi) - std::cos(phi)),
+              vertex.z + s * cotTheta};
+    }
+    Vec3 direction(float s) const {
+      float psi = phi - s * charge / radius();
+      return {std::cos(psi), std::sin(psi), cotTheta};
+    }
+  };
+
+  struct Deposit {
+    uint32_t pixel;  // row * numColsInModule + col
+    float charge;
+  };
+
+  class EventGenerator {
+  public:
+    EventGenerator(std::vector<Module> const& modules, Calibration const& calib) : modules_(modules), calib_(calib) {}
+
+    // returns the number of simulated hits
+    int generate(std::mt19937_64& rng,
+                 BeamSpotPOD const& bs,
+                 int pileup,
+                 float tracksPerInteraction,
+                 float minPt,
+                 float noiseOccupancy) {
+      for (auto& d : deposits_)
+        d.clear();
+      int hits = 0;
+
+      std::normal_distribution<float> gauss;
+      std::uniform_real_distribution<float> uniform;
+      std::poisson_distribution<int> nTracks(tracksPerInteraction);
+      for (int i = 0; i < pileup; ++i) {
+        Vec3 vertex{bs.x + bs.beamWidthX * gauss(rng), bs.y + bs.beamWidthY * gauss(rng), bs.z + bs.sigmaZ * gauss(rng)};
+        for (int n = nTracks(rng); n > 0; --n) {
+          Particle p;
+          p.vertex = vertex;
+          // soft exponential spectrum, with a harder tail
+          p.pt = minPt + (uniform(rng) < 0.9f ? 0.4f : 2.f) * -std::log(1.f - uniform(rng));
+          p.phi = 2.f * float(M_PI) * uniform(rng);
+          p.cotTheta = std::sinh(2.5f * (2.f * uniform(rng) - 1.f));
+          p.charge = uniform(rng) < 0.5f ? -1 : 1;
+          hits += propagate(rng, p);
+        }
+      }
+
+      if (noiseOccupancy > 0) {
+        std::poisson_distribution<int> nNoise(noiseOccupancy * phase1PixelTopology::numPixsInModule);
+        std::uniform_int_distribution<uint32_t> pixel(0, phase1PixelTopology::numPixsInModule - 1);
+        std::uniform_real_distribution<float> charge(kPixelThreshold, 4 * kPixelThreshold);
+        for (auto& d : deposits_) {
+          for (int n = nNoise(rng); n > 0; --n) {
+            d.push_back(Deposit{pixel(rng), charge(rng)});
+          }
+        }
+      }
+      return hits;
+    }
+
+    // pack the pixels above threshold in the FED buffers, returns the number of digis
+    int pack(std::vector<std::vector<unsigned char>>& feds, uint32_t eventNumber) {
+      int digis = 0;
+      std::vector<uint32_t> words;
+      for (int fed = 0; fed < kNumberOfFeds; ++fed) {
+        words.clear();
+        for (int slot = 0; slot < kModulesPerFed; ++slot) {
+          uint32_t module = fed * kModulesPerFed + slot;
+          if (module >= phase1PixelTopology::numberOfModules)
+            break;
+          auto const begin = words.size();
+          auto& d = deposits_[module];
+          std::sort(d.begin(), d.end(), [](Deposit const& a, Deposit const& b) { return a.pixel < b.pixel; });
+          auto const& inverse = inverseFrame(modules_[module].rawId);
+          bool layer1 = module < phase1PixelTopology::layerStart[1];
+          for (size_t i = 0; i < d.size();) {
+            uint32_t pixel = d[i].pixel;
+            float charge = 0;
+            for (; i < d.size() and d[i].pixel == pixel; ++i)
+              charge += d[i].charge;
+            if (charge < kPixelThreshold)
+              continue;
+            int row = pixel / phase1PixelTopology::numColsInModule;
+            int col = pixel % phase1PixelTopology::numColsInModule;
+            auto const& rp = inverse[pixel];
+            uint32_t link = 2 * slot + 1 + rp.roc / 8;
+            uint32_t roc = rp.roc % 8 + 1;
+            words.push_back(packWord(link, roc, rp, layer1, calib_.adc(module, row, col, charge)));
+          }
+          // the readout order: by link, ROC, and double column
+          std::sort(words.begin() + begin, words.end());
+          digis += words.size() - begin;
+        }
+        if (words.size() % 2 == 1) {
+          // 0 is skipped by the unpacker
+          words.push_back(0);
+        }
+
+        auto& buffer = feds[fed];
+        size_t size = FEDHeader::length + words.size() * sizeof(uint32_t) + FEDTrailer::length;
+        buffer.resize(size);
+        FEDHeader::set(buffer.data(), 1, eventNumber, 0, kFirstFed + fed, 0, false);
+        std::memcpy(buffer.data() + FEDHeader::length, words.data(), words.size() * sizeof(uint32_t));
+        FEDTrailer::set(buffer.data() + size - FEDTrailer::length, size / 8, 0, 0, 0, false);
+      }
+      return digis;
+    }
+
+  private:
+    int propagate(std::mt19937_64& rng, Particle const& p) {
+      int hits = 0;
+      float radius = p.radius();
+      for (int layer = 0; layer < 4; ++layer) {
+        float r = kBarrelRadius[layer];
+        if (r >= 2.f * radius)
+          return hits;  // the particle loops before reaching this layer
+        float s = 2.f * radius * std::asin(r / (2.f * radius));
+        auto pos = p.position(s);
+        if (std::abs(pos.z) > 0.5f * kModulesPerLadder * kModuleSpacingZ + 1.f)
+          continue;
+        int n = kBarrelLadders[layer];
+        float phi = std::atan2(pos.y, pos.x);
+        int ladder = int(std::floor(phi / (2.f * float(M_PI)) * n + n)) % n;
+        int m = std::clamp(int(std::floor(pos.z / kModuleSpacingZ + 0.5f * kModulesPerLadder)), 0, kModulesPerLadder - 1);
+        for (int dl = -1; dl <= 1; ++dl) {
+          int l = (ladder + dl + n) % n;
+          hits += cross(rng, p, phase1PixelTopology::layerStart[layer] + l * kModulesPerLadder + m, s);
+        }
+      }
+      if (p.cotTheta == 0)
+        return hits;
+      for (int disk = 0; disk < 3; ++disk) {
+        int layer = p.cotTheta > 0 ? 4 + disk : 7 + disk;
+        float s = (std::copysign(kDiskZ[disk], p.cotTheta) - p.vertex.z) / p.cotTheta;
+        if (s <= 0 or s > float(M_PI) * radius)
+          continue;
+        auto pos = p.position(s);
+        float rho = std::hypot(pos.x, pos.y);
+        float phi = std::atan2(pos.y, pos.x);
+        int first = phase1PixelTopology::layerStart[layer];
+        for (int ring = 0; ring < 2; ++ring) {
+          if (std::abs(rho - kRingRadius[ring]) > kHalfLength + 0.5f)
+            continue;
+          int n = kRingBlades[ring];
+          int blade = int(std::floor(phi / (2.f * float(M_PI)) * n + n)) % n;
+          for (int db = -1; db <= 1; ++db) {
+            int b = (blade + db + n) % n;
+            for (int panel = 0; panel < 2; ++panel) {
+              hits += cross(rng, p, first + 2 * (ring * kRingBlades[0] + b) + panel, s);
+            }
+          }
+        }
+      }
+      return hits;
+    }
+
+    // deposit the charge of the particle in the module, if it crosses it
+    int cross(std::mt19937_64& rng, Particle const& p, uint32_t module, float s) {
+      auto const& mod = modules_[module];
+      auto const& rot = mod.frame.rotation();
+      Vec3 normal{rot.zx(), rot.zy(), rot.zz()};
+      // Newton iterations for the intersection of the helix with the plane of the module
+      for (int i = 0; i < 4; ++i) {
+        auto pos = p.position(s);
+        auto dir = p.direction(s);
+        float f = normal.x * (pos.x - mod.frame.x()) + normal.y * (pos.y - mod.frame.y()) +
+                  normal.z * (pos.z - mod.frame.z());
+        float df = normal.x * dir.x + normal.y * dir.y + normal.z * dir.z;
+        if (std::abs(df) < 1e-6f)
+          return 0;
+        s -= f / df;
+      }
+      if (s <= 0)
+        return 0;
+      auto local = toLocal(mod, p.position(s));
+      if (std::abs(local.x) > kHalfWidth or std::abs(local.y) > kHalfLength or std::abs(local.z) > 0.01f)
+        return 0;
+      auto dir = rotateToLocal(mod, p.direction(s));
+      float ax = dir.x / dir.z;
+      float ay = dir.y / dir.z;
+
+      // path in the sensor, with a Landau-like fluctuation of the deposited charge
+      std::uniform_real_distribution<float> uniform;
+      std::normal_distribution<float> gauss;
+      float t = mod.thickness;
+      float path = t * std::sqrt(1.f + ax * ax + ay * ay);
+      float charge = kChargePerThickness * path / t * (0.8f + 0.1f * gauss(rng) - 0.25f * std::log(1.f - uniform(rng)));
+      float dx = ax * t, dy = ay * t;
+      int steps = std::clamp(int(std::hypot(dx / kPitchX, dy / kPitchY) * 4.f) + 4, 4, 400);
+      auto& deposits = deposits_[module];
+      for (int i = 0; i < steps; ++i) {
+        float f = (i + 0.5f) / steps - 0.5f;
+        float x = local.x + f * dx + kDiffusion * gauss(rng);
+        float y = local.y + f * dy + kDiffusion * gauss(rng);
+        int row = rowFromLocal(x / kPitchX - phase1PixelTopology::xOffset);
+        int col = colFromLocal(y / kPitchY - phase1PixelTopology::yOffset);
+        if (row < 0 or col < 0)
+          continue;
+        deposits.push_back(Deposit{uint32_t(row * phase1PixelTopology::numColsInModule + col), charge / steps});
+      }
+      return 1;
+    }
+
+    std::vector<Module> const& modules_;
+    Calibration const& calib_;
+    std::array<std::vector<Deposit>, phase1PixelTopology::numberOfModules> deposits_;
+  };
+
+  template <typename T>
+  void write(std::ofstream& out, T const& value) {
+    out.write(reinterpret_cast<char const*>(&value), sizeof(T));
+  }
+
+  std::ofstream open(std::filesystem::path const& path) {
+    std::ofstream out(path, std::ios::binary);
+    out.exceptions(std::ofstream::badbit | std::ofstream::failbit);
+    return out;
+  }
+
+  void writeBeamSpot(std::filesystem::path const& datadir, BeamSpotPOD const& bs) {
+    auto out = open(datadir / "beamspot.bin");
+    write(out, bs);
+  }
+
+  void writeCabling(std::filesystem::path const& datadir, std::vector<Module> const& modules) {
+    {
+      auto out = open(datadir / "fedIds.bin");
+      write(out, static_cast<unsigned int>(kNumberOfFeds));
+      for (unsigned int fed = 0; fed < kNumberOfFeds; ++fed) {
+        write(out, kFirstFed + fed);
+      }
+    }
+
+    auto cabling = std::make_unique<SiPixelFedCablingMapGPU>();
+    std::memset(static_cast<void*>(cabling.get()), 0, sizeof(SiPixelFedCablingMapGPU));
+    for (unsigned int fed = 0; fed < pixelgpudetails::MAX_FED; ++fed) {
+      for (unsigned int link = 1; link <= pixelgpudetails::MAX_LINK; ++link) {
+        for (unsigned int roc = 1; roc <= pixelgpudetails::MAX_ROC; ++roc) {
+          unsigned int index = fed * pixelgpudetails::MAX_LINK * pixelgpudetails::MAX_ROC +
+                               (link - 1) * pixelgpudetails::MAX_ROC + roc;
+          if (index >= pixelgpudetails::MAX_SIZE)
+            continue;
+          cabling->fed[index] = fed;
+          cabling->link[index] = link;
+          cabling->roc[index] = roc;
+          cabling->RawId[index] = kInvalid;
+          cabling->rocInDet[index] = kInvalid;
+          cabling->moduleId[index] = kInvalid;
+          unsigned int module = fed * kModulesPerFed + (link - 1) / 2;
+          if (fed < kNumberOfFeds and module < modules.size()) {
+            cabling->RawId[index] = modules[module].rawId;
+            cabling->rocInDet[index] = ((link - 1) % 2) * 8 + roc - 1;
+            cabling->moduleId[index] = module;
+          }
+        }
+      }
+    }
+    cabling->size = pixelgpudetails::MAX_SIZE;
+
+    auto out = open(datadir / "cablingMap.bin");
+    write(out, *cabling);
+    // all modules are unpacked
+    std::vector<unsigned char> modToUnp(pixelgpudetails::MAX_SIZE, 0);
+    write(out, static_cast<unsigned int>(modToUnp.size()));
+    out.write(reinterpret_cast<char const*>(modToUnp.data()), modToUnp.size());
+  }
+
+  void writeGain(std::filesystem::path const& datadir, Calibration const& calib) {
+    auto out = open(datadir / "gain.bin");
+    write(out, *calib.gain);
+    unsigned int nbytes = calib.data.size() * sizeof(SiPixelGainForHLTonGPU_DecodingStructure);
+    write(out, nbytes);
+    out.write(reinterpret_cast<char const*>(calib.data.data()), nbytes);
+  }
+
+  void writeCPE(std::filesystem::path const& datadir, std::vector<Module> const& modules) {
+    pixelCPEforGPU::CommonParams common{kThicknessB, kThicknessE, kPitchX, kPitchY};
+
+    std::vector<pixelCPEforGPU::DetParams> detParams(modules.size());
+    std::memset(static_cast<void*>(detParams.data()), 0, detParams.size() * sizeof(pixelCPEforGPU::DetParams));
+    for (unsigned int i = 0; i < modules.size(); ++i) {
+      auto const& mod = modules[i];
+      auto& p = detParams[i];
+      p.isBarrel = mod.barrel;
+      p.isPosZ = mod.frame.z() > 0;
+      p.layer = mod.layer;
+      p.index = i;
+      p.rawId = mod.rawId;
+      // no Lorentz drift
+      p.shiftX = p.shiftY = p.chargeWidthX = p.chargeWidthY = 0;
+      mod.frame.toLocal(0, 0, 0, p.x0, p.y0, p.z0);
+      // errors for clusters of size > 1, 1, and 1 big pixel
+      p.sx[0] = 0.0010f;
+      p.sx[1] = kPitchX / std::sqrt(12.f);
+      p.sx[2] = 2 * kPitchX / std::sqrt(12.f);
+      p.sy[0] = 0.0015f;
+      p.sy[1] = kPitchY / std::sqrt(12.f);
+      p.sy[2] = 2 * kPitchY / std::sqrt(12.f);
+      p.frame = mod.frame;
+    }
+
+    // same as PixelCPEFast::fillParamsForGpu() in CMSSW
+    pixelCPEforGPU::AverageGeometry ag;
+    std::memset(&ag, 0, sizeof(ag));
+    constexpr float moduleLength = 6.7f;
+    constexpr float moduleTolerance = 0.1f;
+    for (unsigned int il = 0; il < phase1PixelTopology::numberOfLaddersInBarrel; ++il) {
+      ag.ladderMinZ[il] = 1000.f;
+      ag.ladderMaxZ[il] = -1000.f;
+    }
+    for (unsigned int im = 0; im < phase1PixelTopology::numberOfModulesInBarrel; ++im) {
+      auto const& frame = modules[im].frame;
+      auto il = im / kModulesPerLadder;
+      ag.ladderZ[il] += frame.z() / kModulesPerLadder;
+      ag.ladderX[il] += frame.x() / kModulesPerLadder;
+      ag.ladderY[il] += frame.y() / kModulesPerLadder;
+      ag.ladderR[il] += std::hypot(frame.x(), frame.y()) / kModulesPerLadder;
+      ag.ladderMinZ[il] = std::min(ag.ladderMinZ[il], frame.z());
+      ag.ladderMaxZ[il] = std::max(ag.ladderMaxZ[il], frame.z());
+    }
+    for (unsigned int il = 0; il < phase1PixelTopology::numberOfLaddersInBarrel; ++il) {
+      ag.ladderMinZ[il] -= (0.5f * moduleLength - moduleTolerance);
+      ag.ladderMaxZ[il] += (0.5f * moduleLength - moduleTolerance);
+    }
+    ag.endCapZ[0] = 1000.f;
+    ag.endCapZ[1] = -1000.f;
+    for (unsigned int im = phase1PixelTopology::layerStart[4]; im < phase1PixelTopology::layerStart[5]; ++im) {
+      ag.endCapZ[0] = std::min(ag.endCapZ[0], modules[im].frame.z());
+    }
+    for (unsigned int im = phase1PixelTopology::layerStart[7]; im < phase1PixelTopology::layerStart[8]; ++im) {
+      ag.endCapZ[1] = std::max(ag.endCapZ[1], modules[im].frame.z());
+    }
+
+    pixelCPEforGPU::LayerGeometry lg;
+    std::copy(std::begin(phase1PixelTopology::layerStart), std::end(phase1PixelTopology::layerStart), lg.layerStart);
+    std::copy(phase1PixelTopology::layer.begin(), phase1PixelTopology::layer.end(), lg.layer);
+
+    auto out = open(datadir / "cpefast.bin");
+    write(out, common);
+    write(out, static_cast<unsigned int>(detParams.size()));
+    out.write(reinterpret_cast<char const*>(detParams.data()), detParams.size() * sizeof(pixelCPEforGPU::DetParams));
+    write(out, ag);
+    write(out, lg);
+  }
+}  // namespace
+
+int main(int argc, char** argv) {
+  // Parse command line arguments
+  std::vector<std::string> args(argv, argv + argc);
+  std::filesystem::path datadir = "data";
+  int numberOfEvents = 100;
+  int pileup = 50;
+  float tracksPerInteraction = 60;
+  float minPt = 0.2;
+  float noiseOccupancy = 1e-5;
+  unsigned long seed = 42;
+  for (auto i = args.begin() + 1, e = args.end(); i != e; ++i) {
+    if (*i == "-h" or *i == "--help") {
+      print_help(args.front());
+      return EXIT_SUCCESS;
+    } else if (*i == "--data") {
+      ++i;
+      datadir = *i;
+    } else if (*i == "--numberOfEvents") {
+      ++i;
+      numberOfEvents = std::stoi(*i);
+    } else if (*i == "--pileup") {
+      ++i;
+      pileup = std::stoi(*i);
+    } else if (*i == "--tracksPerInteraction") {
+      ++i;
+      tracksPerInteraction = std::stof(*i);
+    } else if (*i == "--minPt") {
+      ++i;
+      minPt = std::stof(*i);
+    } else if (*i == "--noiseOccupancy") {
+      ++i;
+      noiseOccupancy = std::stof(*i);
+    } else if (*i == "--seed") {
+      ++i;
+      seed = std::stoul(*i);
+    } else {
+      std::cout << "Invalid parameter " << *i << std::endl << std::endl;
+      print_help(args.front());
+      return EXIT_FAILURE;
+    }
+  }
+  if (numberOfEvents <= 0 or pileup < 0 or tracksPerInteraction < 0 or minPt <= 0 or noiseOccupancy < 0) {
+    std::cout << "Invalid configuration" << std::endl;
+    return EXIT_FAILURE;
+  }
+  std::filesystem::create_directories(datadir);
+
+  std::mt19937_64 rng(seed);
+  BeamSpotPOD bs;
+  std::memset(&bs, 0, sizeof(bs));
+  bs.x = 0.05f;
+  bs.y = -0.03f;
+  bs.z = 0.3f;
+  bs.sigmaZ = 3.5f;
+  bs.beamWidthX = bs.beamWidthY = 0.0012f;
+
+  auto modules = makeGeometry();
+  auto calib = makeCalibration(rng);
+  writeBeamSpot(datadir, bs);
+  writeCabling(datadir, modules);
+  writeGain(datadir, calib);
+  writeCPE(datadir, modules);
+
+  // same capacity as in SiPixelRawToClusterGPUKernel.cc
+  constexpr unsigned int maxWords = pixelgpudetails::MAX_FED * kMaxWordsPerFed;
+
+  auto generator = std::make_unique<EventGenerator>(modules, calib);
+  std::vector<std::vector<unsigned char>> feds(kNumberOfFeds);
+  auto out = open(datadir / "raw.bin");
+  long totalHits = 0, totalDigis = 0;
+  int maxDigis = 0, overflows = 0;
+  for (int ev = 0; ev < numberOfEvents; ++ev) {
+    totalHits += generator->generate(rng, bs, pileup, tracksPerInteraction, minPt, noiseOccupancy);
+    int digis = generator->pack(feds, ev + 1);
+    totalDigis += digis;
+    maxDigis = std::max(maxDigis, digis);
+    if (digis + kNumberOfFeds > int(maxWords))
+      ++overflows;
+
+    write(out, static_cast<unsigned int>(feds.size()));
+    for (int fed = 0; fed < kNumberOfFeds; ++fed) {
+      write(out, static_cast<unsigned int>(kFirstFed + fed));
+      write(out, static_cast<unsigned int>(feds[fed].size()));
+      out.write(reinterpret_cast<char const*>(feds[fed].data()), feds[fed].size());
+    }
+  }
+
+  std::cout << "Generated " << numberOfEvents << " events in " << datadir.string() << " with on average "
+            << totalHits / numberOfEvents << " simulated hits and " << totalDigis / numberOfEvents
+            << " digis per event (maximum " << maxDigis << ")" << std::endl;
+  if (overflows > 0) {
+    std::cout << "Warning: " << overflows << " events have more than the " << maxWords
+              << " words that SiPixelRawToClusterCUDA can unpack" << std::endl;
+  }
+  return EXIT_SUCCESS;
+}